@@ -67,6 +67,7 @@ public:
                                                    boost::any target) = 0;
 
     virtual size_t n_vertices() const = 0;
+    virtual boost::any get_vertex(size_t i) const = 0;
 
     virtual void
     set_graph_property(const std::string& name, const std::string& value,
@@ -139,6 +140,11 @@ public:
         return num_vertices(m_g);
     }
 
+    virtual any get_vertex(size_t i) const
+    {
+        return any(vertex(i, m_g));
+    }
+
     virtual void
     set_graph_property(const std::string& name,
                        const std::string& value, const std::string& value_type)
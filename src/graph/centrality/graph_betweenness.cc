@@ -23,16 +23,20 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_util.hh"
+#include "random.hh"
+
+#include "graph_betweenness.hh"
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
+// returns the factor applied to the vertex betweenness
 template <class Graph, class EdgeBetweenness, class VertexBetweenness>
-void normalize_betweenness(const Graph& g,
-                           EdgeBetweenness edge_betweenness,
-                           VertexBetweenness vertex_betweenness,
-                           size_t n)
+double normalize_betweenness(const Graph& g,
+                             EdgeBetweenness edge_betweenness,
+                             VertexBetweenness vertex_betweenness,
+                             size_t n)
 {
     double vfactor = (n > 2) ? 1.0/((n-1)*(n-2)) : 1.0;
     double efactor = (n > 1) ? 1.0/(n*(n-1)) : 1.0;
@@ -59,31 +63,21 @@ void normalize_betweenness(const Graph& g,
     {
         put(edge_betweenness, *e, efactor * get(edge_betweenness, *e));
     }
+    return vfactor;
 }
 
 struct get_betweenness
 {
     typedef void result_type;
     template <class Graph, class EdgeBetweenness, class VertexBetweenness>
-    void operator()(Graph& g,
-                    GraphInterface::vertex_index_map_t index_map,
-                    EdgeBetweenness edge_betweenness,
+    void operator()(Graph& g, EdgeBetweenness edge_betweenness,
                     VertexBetweenness vertex_betweenness,
-                    bool normalize, size_t n) const
+                    bool normalize, size_t n, size_t max_eindex) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<size_t> distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-        brandes_betweenness_centrality
-            (g, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), index_map),
-             make_iterator_property_map(distance_map.begin(), index_map),
-             make_iterator_property_map(dependency_map.begin(), index_map),
-             make_iterator_property_map(path_count_map.begin(), index_map),
-             index_map);
+        edge_betweenness.reserve(max_eindex + 1);
+        vertex_betweenness.reserve(num_vertices(g));
+        brandes_betweenness(g, edge_betweenness, vertex_betweenness,
+                            brandes_bfs(), max_eindex);
         if (normalize)
             normalize_betweenness(g, edge_betweenness, vertex_betweenness, n);
     }
@@ -92,37 +86,60 @@ struct get_betweenness
 struct get_weighted_betweenness
 {
     typedef void result_type;
-    template <class Graph, class EdgeBetweenness, class VertexBetweenness,
-              class VertexIndexMap>
-        void operator()(Graph& g, VertexIndexMap vertex_index,
-                        EdgeBetweenness edge_betweenness,
-                        VertexBetweenness vertex_betweenness,
-                        boost::any weight_map, bool normalize,
-                        size_t n, size_t max_eindex) const
+    template <class Graph, class EdgeBetweenness, class VertexBetweenness>
+    void operator()(Graph& g, EdgeBetweenness edge_betweenness,
+                    VertexBetweenness vertex_betweenness,
+                    boost::any weight_map, bool normalize,
+                    size_t n, size_t max_eindex) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<typename property_traits<EdgeBetweenness>::value_type>
-            distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-
         typename EdgeBetweenness::checked_t weight =
             any_cast<typename EdgeBetweenness::checked_t>(weight_map);
 
-        brandes_betweenness_centrality
-            (g, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), vertex_index),
-             make_iterator_property_map(distance_map.begin(), vertex_index),
-             make_iterator_property_map(dependency_map.begin(), vertex_index),
-             make_iterator_property_map(path_count_map.begin(), vertex_index),
-             vertex_index, weight.get_unchecked(max_eindex+1));
+        edge_betweenness.reserve(max_eindex + 1);
+        vertex_betweenness.reserve(num_vertices(g));
+        brandes_betweenness(g, edge_betweenness, vertex_betweenness,
+                            brandes_dijkstra<EdgeBetweenness>
+                                (weight.get_unchecked(max_eindex + 1)),
+                            max_eindex);
         if (normalize)
             normalize_betweenness(g, edge_betweenness, vertex_betweenness, n);
     }
 };
 
+struct get_sampled_betweenness
+{
+    typedef void result_type;
+    template <class Graph, class EdgeBetweenness, class VertexBetweenness>
+    void operator()(Graph& g, EdgeBetweenness edge_betweenness,
+                    VertexBetweenness vertex_betweenness,
+                    boost::any weight_map, bool normalize, size_t n,
+                    size_t max_eindex, size_t n_samples, double epsilon,
+                    double confidence, rng_t& rng, double& err) const
+    {
+        edge_betweenness.reserve(max_eindex + 1);
+        vertex_betweenness.reserve(num_vertices(g));
+        if (weight_map.empty())
+        {
+            err = sampled_brandes_betweenness
+                (g, edge_betweenness, vertex_betweenness, brandes_bfs(),
+                 max_eindex, n_samples, epsilon, confidence, rng);
+        }
+        else
+        {
+            typename EdgeBetweenness::checked_t weight =
+                any_cast<typename EdgeBetweenness::checked_t>(weight_map);
+            err = sampled_brandes_betweenness
+                (g, edge_betweenness, vertex_betweenness,
+                 brandes_dijkstra<EdgeBetweenness>
+                     (weight.get_unchecked(max_eindex + 1)),
+                 max_eindex, n_samples, epsilon, confidence, rng);
+        }
+        if (normalize)
+            err *= normalize_betweenness(g, edge_betweenness,
+                                         vertex_betweenness, n);
+    }
+};
+
 void betweenness(GraphInterface& g, boost::any weight,
                  boost::any edge_betweenness,
                  boost::any vertex_betweenness,
@@ -140,8 +157,7 @@ void betweenness(GraphInterface& g, boost::any weight,
     {
         run_action<>()
             (g, std::bind<>(get_weighted_betweenness(),
-                            std::placeholders::_1, g.GetVertexIndex(),
-                            std::placeholders::_2,
+                            std::placeholders::_1, std::placeholders::_2,
                             std::placeholders::_3, weight, normalize,
                             g.GetNumberOfVertices(), g.GetMaxEdgeIndex()),
              edge_floating_properties(),
@@ -152,15 +168,45 @@ void betweenness(GraphInterface& g, boost::any weight,
     {
         run_action<>()
             (g, std::bind<void>(get_betweenness(), std::placeholders::_1,
-                                g.GetVertexIndex(), std::placeholders::_2,
-                                std::placeholders::_3, normalize,
-                                g.GetNumberOfVertices()),
+                                std::placeholders::_2, std::placeholders::_3,
+                                normalize, g.GetNumberOfVertices(),
+                                g.GetMaxEdgeIndex()),
              edge_floating_properties(),
              vertex_floating_properties())
             (edge_betweenness, vertex_betweenness);
     }
 }
 
+double sampled_betweenness(GraphInterface& g, boost::any weight,
+                           boost::any edge_betweenness,
+                           boost::any vertex_betweenness, bool normalize,
+                           size_t n_samples, double epsilon,
+                           double confidence, rng_t& rng)
+{
+    if (!belongs<edge_floating_properties>()(edge_betweenness))
+        throw ValueException("edge property must be of floating point value"
+                             " type");
+
+    if (!belongs<vertex_floating_properties>()(vertex_betweenness))
+        throw ValueException("vertex property must be of floating point value"
+                             " type");
+
+    if (confidence <= 0 || confidence >= 1)
+        throw ValueException("confidence must lie in the interval (0, 1)");
+
+    double err = 0;
+    run_action<>()
+        (g, std::bind<void>(get_sampled_betweenness(), std::placeholders::_1,
+                            std::placeholders::_2, std::placeholders::_3,
+                            weight, normalize, g.GetNumberOfVertices(),
+                            g.GetMaxEdgeIndex(), n_samples, epsilon,
+                            confidence, std::ref(rng), std::ref(err)),
+         edge_floating_properties(),
+         vertex_floating_properties())
+        (edge_betweenness, vertex_betweenness);
+    return err;
+}
+
 struct get_central_point_dominance
 {
     template <class Graph, class VertexBetweenness>
@@ -186,5 +232,6 @@ void export_betweenness()
 {
     using namespace boost::python;
     def("get_betweenness", &betweenness);
+    def("get_sampled_betweenness", &sampled_betweenness);
     def("get_central_point_dominance", &central_point);
 }
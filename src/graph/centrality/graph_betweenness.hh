@@ -0,0 +1,435 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BETWEENNESS_HH
+#define GRAPH_BETWEENNESS_HH
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <cmath>
+#include <functional>
+
+#include "graph_util.hh"
+#include "parallel_loops.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Brandes' betweenness algorithm [brandes-faster-2001]. Each thread runs
+// independent single-source passes, using its own search buffers and its own
+// vertex and edge accumulators, which are summed at the end. The search
+// buffers are reset only at the vertices reached by the previous pass.
+
+// Shortest-path searches used by the single-source passes. They fill the
+// distances, the number of shortest paths, and the incoming edges along
+// shortest paths, and leave the reached vertices in 'order', sorted by
+// non-decreasing distance from the source.
+
+struct brandes_bfs
+{
+    typedef size_t dist_t;
+
+    template <class Graph, class Vertex, class Edge>
+    void operator()(const Graph& g, Vertex s, vector<dist_t>& dist,
+                    vector<size_t>& path_count,
+                    vector<vector<Edge> >& incoming, vector<Vertex>& order)
+        const
+    {
+        dist[s] = 0;
+        order.push_back(s);
+        // 'order' doubles as the BFS queue
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            Vertex v = order[i];
+            typename graph_traits<Graph>::out_edge_iterator e, e_end;
+            for (tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
+            {
+                Vertex w = target(*e, g);
+                if (dist[w] == numeric_limits<dist_t>::max())
+                {
+                    dist[w] = dist[v] + 1;
+                    order.push_back(w);
+                }
+                if (dist[w] == dist[v] + 1)
+                {
+                    path_count[w] += path_count[v];
+                    incoming[w].push_back(*e);
+                }
+            }
+        }
+    }
+};
+
+template <class Weight>
+struct brandes_dijkstra
+{
+    typedef typename property_traits<Weight>::value_type dist_t;
+
+    brandes_dijkstra(Weight weight): _weight(weight) {}
+
+    template <class Graph, class Vertex, class Edge>
+    void operator()(const Graph& g, Vertex s, vector<dist_t>& dist,
+                    vector<size_t>& path_count,
+                    vector<vector<Edge> >& incoming, vector<Vertex>& order)
+        const
+    {
+        typedef pair<dist_t, Vertex> item_t;
+        priority_queue<item_t, vector<item_t>, greater<item_t> > queue;
+
+        dist[s] = 0;
+        queue.push(make_pair(dist_t(0), s));
+        while (!queue.empty())
+        {
+            item_t top = queue.top();
+            queue.pop();
+            Vertex v = top.second;
+            if (top.first > dist[v])
+                continue; // stale entry
+            order.push_back(v);
+
+            typename graph_traits<Graph>::out_edge_iterator e, e_end;
+            for (tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
+            {
+                Vertex w = target(*e, g);
+                dist_t d = dist[v] + get(_weight, *e);
+                if (d < dist[w])
+                {
+                    dist[w] = d;
+                    path_count[w] = path_count[v];
+                    incoming[w].clear();
+                    incoming[w].push_back(*e);
+                    queue.push(make_pair(d, w));
+                }
+                else if (d == dist[w] && w != v)
+                {
+                    path_count[w] += path_count[v];
+                    incoming[w].push_back(*e);
+                }
+            }
+        }
+    }
+
+    Weight _weight;
+};
+
+// Per-thread buffers of the single-source passes, and accumulators.
+template <class Graph, class DistType>
+struct brandes_state
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+    brandes_state(size_t N, size_t E, bool moments)
+        : dist(N, numeric_limits<DistType>::max()), path_count(N, 0),
+          dependency(N, 0), incoming(N), vbetweenness(N, 0),
+          ebetweenness(E, 0)
+    {
+        if (moments)
+            vbetweenness2.resize(N, 0);
+    }
+
+    // runs a single-source pass from s, and adds the dependencies of s to the
+    // accumulators
+    template <class ShortestPaths, class EdgeIndex>
+    void pass(const Graph& g, vertex_t s, ShortestPaths& shortest_paths,
+              EdgeIndex eindex)
+    {
+        path_count[s] = 1;
+        shortest_paths(g, s, dist, path_count, incoming, order);
+
+        for (auto iter = order.rbegin(); iter != order.rend(); ++iter)
+        {
+            vertex_t w = *iter;
+            for (const auto& e : incoming[w])
+            {
+                vertex_t v = source(e, g);
+                double c = (double(path_count[v]) / path_count[w]) *
+                    (1 + dependency[w]);
+                dependency[v] += c;
+                ebetweenness[eindex[e]] += c;
+            }
+            if (w != s)
+            {
+                vbetweenness[w] += dependency[w];
+                if (!vbetweenness2.empty())
+                    vbetweenness2[w] += dependency[w] * dependency[w];
+            }
+        }
+
+        // reset only what was touched
+        for (vertex_t v : order)
+        {
+            dist[v] = numeric_limits<DistType>::max();
+            path_count[v] = 0;
+            dependency[v] = 0;
+            incoming[v].clear();
+        }
+        order.clear();
+    }
+
+    vector<DistType> dist;
+    vector<size_t> path_count;
+    vector<double> dependency;
+    vector<vector<edge_t> > incoming;
+    vector<vertex_t> order;
+
+    vector<double> vbetweenness;
+    vector<double> ebetweenness;
+    vector<double> vbetweenness2; // sum of squares, if requested
+};
+
+// The per-thread states of a betweenness computation, which may run its
+// single-source passes in several rounds.
+template <class Graph, class ShortestPaths>
+class brandes_states
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef brandes_state<Graph, typename ShortestPaths::dist_t> state_t;
+
+    brandes_states(ShortestPaths shortest_paths, size_t max_eindex,
+                   bool moments = false)
+        : _shortest_paths(shortest_paths), _E(max_eindex + 1),
+          _moments(moments)
+    {
+        size_t num_threads = 1;
+#ifdef USING_OPENMP
+        num_threads = omp_get_max_threads();
+#endif
+        _states.resize(num_threads, nullptr);
+    }
+
+    ~brandes_states()
+    {
+        for (auto state : _states)
+            delete state;
+    }
+
+    // runs the single-source passes from the vertices with indexes in the
+    // range [begin, end) of 'sources', in parallel
+    void run(const Graph& g, const vector<size_t>& sources, size_t begin,
+             size_t end)
+    {
+        auto eindex = get(edge_index, g);
+        size_t N = num_vertices(g);
+        size_t NS = end - begin;
+
+        // every pass costs about the same, hence the sources are weighted
+        // equally, and always scheduled dynamically
+        vector<size_t> blocks;
+        get_balanced_partition(NS, [](size_t) { return 1; }, blocks);
+
+        #pragma omp parallel if (NS > 1)
+        {
+            size_t tid = 0;
+#ifdef USING_OPENMP
+            tid = omp_get_thread_num();
+#endif
+            if (_states[tid] == nullptr)
+                _states[tid] = new state_t(N, _E, _moments);
+            state_t& state = *_states[tid];
+            ShortestPaths shortest_paths = _shortest_paths;
+            parallel_loop_no_spawn
+                (NS, blocks,
+                 [&](size_t i)
+                 {
+                     vertex_t s = vertex(sources[begin + i], g);
+                     if (s == graph_traits<Graph>::null_vertex())
+                         return;
+                     state.pass(g, s, shortest_paths, eindex);
+                 });
+        }
+    }
+
+    // returns the sum of the dependencies of v, and of their squares, over
+    // all passes so far
+    pair<double, double> get_moments(vertex_t v) const
+    {
+        double m1 = 0, m2 = 0;
+        for (auto state : _states)
+        {
+            if (state == nullptr)
+                continue;
+            m1 += state->vbetweenness[v];
+            if (_moments)
+                m2 += state->vbetweenness2[v];
+        }
+        return make_pair(m1, m2);
+    }
+
+    // stores the accumulated values in the betweenness maps, which must have
+    // been sized beforehand, multiplied by 'scale'
+    template <class EdgeBetweenness, class VertexBetweenness>
+    void reduce(const Graph& g, EdgeBetweenness edge_betweenness,
+                VertexBetweenness vertex_betweenness, double scale) const
+    {
+        auto eindex = get(edge_index, g);
+
+        // in undirected graphs every path is found from both ends
+        if (!is_directed::apply<Graph>::type::value)
+            scale /= 2;
+
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 put(vertex_betweenness, v, scale * get_moments(v).first);
+
+                 typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                 for (tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
+                 {
+                     // undirected edges are seen from both ends; the result
+                     // is the same, but it is written only once
+                     if (!is_directed::apply<Graph>::type::value &&
+                         target(*e, g) < v)
+                         continue;
+                     size_t ei = eindex[*e];
+                     double c = 0;
+                     for (auto state : _states)
+                         if (state != nullptr)
+                             c += state->ebetweenness[ei];
+                     put(edge_betweenness, *e, scale * c);
+                 }
+             });
+    }
+
+private:
+    ShortestPaths _shortest_paths;
+    size_t _E;
+    bool _moments;
+    vector<state_t*> _states;
+};
+
+// Runs the single-source passes from all vertices, and stores the result in
+// the betweenness maps, which must have been sized beforehand.
+template <class Graph, class EdgeBetweenness, class VertexBetweenness,
+          class ShortestPaths>
+void brandes_betweenness(const Graph& g, EdgeBetweenness edge_betweenness,
+                         VertexBetweenness vertex_betweenness,
+                         ShortestPaths shortest_paths, size_t max_eindex)
+{
+    vector<size_t> sources(num_vertices(g));
+    for (size_t i = 0; i < sources.size(); ++i)
+        sources[i] = i;
+    brandes_states<Graph, ShortestPaths> states(shortest_paths, max_eindex);
+    states.run(g, sources, 0, sources.size());
+    states.reduce(g, edge_betweenness, vertex_betweenness, 1);
+}
+
+// Approximates the betweenness from the passes of a uniform sample of pivot
+// sources, drawn without replacement, with the results rescaled by the
+// inverse of the sampled fraction [brandes-centrality-2007]. At most
+// 'n_samples' pivots are used (or all the vertices, if it is zero). If
+// 'epsilon' is positive, the pivots are instead drawn in rounds of doubling
+// size, until the error bound below is smaller than 'epsilon'.
+//
+// Returns the maximum over all vertices of an empirical Bernstein bound
+// [audibert-exploration-2009] on the absolute error of the vertex betweenness,
+// which holds simultaneously for all vertices with probability at least
+// 'confidence'. The bound is zero if all vertices were used as pivots.
+template <class Graph, class EdgeBetweenness, class VertexBetweenness,
+          class ShortestPaths, class RNG>
+double sampled_brandes_betweenness(const Graph& g,
+                                   EdgeBetweenness edge_betweenness,
+                                   VertexBetweenness vertex_betweenness,
+                                   ShortestPaths shortest_paths,
+                                   size_t max_eindex, size_t n_samples,
+                                   double epsilon, double confidence, RNG& rng)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    vector<size_t> sources;
+    sources.reserve(num_vertices(g));
+    for (size_t i = 0; i < num_vertices(g); ++i)
+        if (vertex(i, g) != graph_traits<Graph>::null_vertex())
+            sources.push_back(i);
+
+    size_t HN = sources.size();
+    if (n_samples == 0 || n_samples > HN)
+        n_samples = HN;
+
+    // a single dependency value lies in [0, HN - 2], and the values of every
+    // vertex are bounded together
+    double R = (HN > 2) ? HN - 2 : 0;
+    double log_delta = log(3 * max(HN, size_t(1)) / (1 - confidence));
+    double factor = is_directed::apply<Graph>::type::value ? 1 : 0.5;
+
+    brandes_states<Graph, ShortestPaths> states(shortest_paths, max_eindex,
+                                                true);
+
+    size_t k = 0, k_next = n_samples;
+    if (epsilon > 0)
+    {
+        size_t num_threads = 1;
+#ifdef USING_OPENMP
+        num_threads = omp_get_max_threads();
+#endif
+        k_next = min(n_samples, max(size_t(32), num_threads));
+    }
+
+    double err = 0;
+    while (true)
+    {
+        // draw the next pivots (without replacement) beforehand, so that the
+        // sample does not depend on the number of threads
+        for (size_t j = k; j < k_next; ++j)
+        {
+            uniform_int_distribution<size_t> randint(j, HN - 1);
+            swap(sources[j], sources[randint(rng)]);
+        }
+        states.run(g, sources, k, k_next);
+        k = k_next;
+
+        err = 0;
+        if (k < HN)
+        {
+            // the estimate of the betweenness of v is factor * HN times the
+            // sample mean of its dependencies
+            int i, N = HN;
+            #pragma omp parallel for default(shared) private(i) \
+                schedule(runtime) reduction(max:err) if (N > 100)
+            for (i = 0; i < N; ++i)
+            {
+                vertex_t v = vertex(sources[i], g);
+                pair<double, double> m = states.get_moments(v);
+                double mean = m.first / k;
+                double var = max(m.second / k - mean * mean, 0.);
+                double e = sqrt(2 * var * log_delta / k) +
+                    3 * R * log_delta / k;
+                err = max(err, factor * HN * e);
+            }
+        }
+
+        if (epsilon <= 0 || err <= epsilon || k == n_samples)
+            break;
+        k_next = min(2 * k, n_samples);
+    }
+
+    states.reduce(g, edge_betweenness, vertex_betweenness, double(HN) / k);
+    return err;
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_BETWEENNESS_HH
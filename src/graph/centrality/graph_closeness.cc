@@ -19,6 +19,7 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_properties.hh"
+#include "random.hh"
 
 #include "graph_closeness.hh"
 
@@ -49,7 +50,25 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
     }
 }
 
+void do_get_sampled_closeness(GraphInterface& gi, boost::any closeness,
+                              boost::any err, bool harmonic, bool norm,
+                              size_t n_samples, rng_t& rng)
+{
+    if (!belongs<vertex_floating_properties>()(closeness))
+        throw ValueException("vertex property must be of floating point value"
+                             " type");
+    if (n_samples == 0)
+        throw ValueException("the number of samples must be positive");
+
+    run_action<>()(gi,
+                   std::bind(get_sampled_closeness(), placeholders::_1,
+                             gi.GetVertexIndex(), placeholders::_2, err,
+                             harmonic, norm, n_samples, std::ref(rng)),
+                   vertex_floating_properties())(closeness);
+}
+
 void export_closeness()
 {
     boost::python::def("closeness", &do_get_closeness);
+    boost::python::def("get_sampled_closeness", &do_get_sampled_closeness);
 }
@@ -18,8 +18,7 @@
 #ifndef GRAPH_CLOSENESS_HH
 #define GRAPH_CLOSENESS_HH
 
-#include <boost/graph/breadth_first_search.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <array>
 
 #include <boost/python/object.hpp>
 #include <boost/python/list.hpp>
@@ -27,6 +26,9 @@
 
 #include "histogram.hh"
 #include "numpy_bind.hh"
+#include "parallel_loops.hh"
+#include "multi_source_bfs.hh"
+#include "search_workspace.hh"
 
 namespace graph_tool
 {
@@ -57,141 +59,261 @@ struct get_closeness
         using namespace boost;
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
 
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
 
-        get_vertex_dists_t get_vertex_dists;
         size_t HN = HardNumVertices()(g);
-        int i, N = num_vertices(g);
-        #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
-        for (i = 0; i < N; ++i)
+        size_t N = num_vertices(g);
+
+        // every source costs a full search of its component, regardless of
+        // its degree, hence all vertices are given the same weight
+        vector<size_t> blocks;
+        if (get_openmp_degree_balance())
+            get_balanced_partition(N, [](size_t) { return 1; }, blocks);
+
+        // every search runs on the workspace of its thread, and only the
+        // vertices it reached are summed over and reset afterwards
+        #pragma omp parallel if (N > 100)
+        parallel_vertex_loop_no_spawn
+            (g, blocks,
+             [&](vertex_t v)
+             {
+                 auto& ws = get_search_workspace<val_type>(N);
+                 workspace_dijkstra(g, vertex_index, v, weights, ws);
+
+                 size_t comp_size = ws.touched().size();
+                 closeness[v] = 0;
+                 for (auto i : ws.touched())
+                 {
+                     if (i == get(vertex_index, v))
+                         continue;
+                     if (!harmonic)
+                         closeness[v] += ws.dist(i);
+                     else
+                         closeness[v] += 1. / ws.dist(i);
+                 }
+                 if (!harmonic)
+                     closeness[v] = 1 / closeness[v];
+                 if (norm)
+                 {
+                     if (harmonic)
+                         closeness[v] /= HN - 1;
+                     else
+                         closeness[v] *= comp_size - 1;
+                 }
+             });
+    }
+
+    // unweighted version: the searches are run from 64 sources at once with
+    // multi_source_bfs, and the sums of the distances of every source are
+    // accumulated directly from the bit masks of the vertices reached at each
+    // level, without per-source distance maps
+    template <class Graph, class VertexIndex, class Closeness>
+    void operator()(const Graph& g, VertexIndex vertex_index, no_weightS,
+                    Closeness closeness, bool harmonic, bool norm) const
+    {
+        using namespace boost;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef multi_source_bfs<Graph, VertexIndex> msbfs_t;
+        typedef typename msbfs_t::mask_t mask_t;
+
+        size_t HN = HardNumVertices()(g);
+        size_t N = num_vertices(g);
+
+        vector<vertex_t> sources;
+        sources.reserve(HN);
+        for (size_t i = 0; i < N; ++i)
         {
             vertex_t v = vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
+            if (v != graph_traits<Graph>::null_vertex())
+                sources.push_back(v);
+        }
+        int n_batches = (sources.size() + msbfs_t::width - 1) / msbfs_t::width;
 
-            unchecked_vector_property_map<val_type,VertexIndex>
-                dist_map(vertex_index, num_vertices(g));
+        #pragma omp parallel if (N > 100)
+        {
+            msbfs_t bfs(g, vertex_index);
+            std::array<double, msbfs_t::width> sum;
+            std::array<size_t, msbfs_t::width> count;
 
-            for (int j = 0; j < N; ++j)
+            #pragma omp for schedule(runtime)
+            for (int b = 0; b < n_batches; ++b)
             {
-                if (vertex(j, g) != graph_traits<Graph>::null_vertex())
-                    dist_map[vertex(j, g)] = numeric_limits<val_type>::max();
-            }
-
-            dist_map[v] = 0;
+                size_t first = b * msbfs_t::width;
+                size_t last = min(first + msbfs_t::width, sources.size());
+                sum.fill(0);
+                count.fill(0);
 
-            size_t comp_size = 0;
-            get_vertex_dists(g, v, vertex_index, dist_map, weights, comp_size);
+                bfs.run(sources.begin() + first, sources.begin() + last,
+                        [&](vertex_t, size_t d, mask_t m)
+                        {
+                            double x = harmonic ? 1. / d : d;
+                            while (m != 0)
+                            {
+                                size_t l = __builtin_ctzll(m);
+                                m &= m - 1;
+                                sum[l] += x;
+                                ++count[l];
+                            }
+                        });
 
-            closeness[v] = 0;
-            typename graph_traits<Graph>::vertex_iterator v2, v_end;
-            for (tie(v2, v_end) = vertices(g); v2 != v_end; ++v2)
-            {
-                if (*v2 != v && dist_map[*v2] != numeric_limits<val_type>::max())
+                for (size_t l = 0; l < last - first; ++l)
                 {
+                    vertex_t v = sources[first + l];
+                    closeness[v] = sum[l];
                     if (!harmonic)
-                        closeness[v] += dist_map[*v2];
-                    else
-                        closeness[v] += 1. / dist_map[*v2];
+                        closeness[v] = 1 / closeness[v];
+                    if (norm)
+                    {
+                        if (harmonic)
+                            closeness[v] /= HN - 1;
+                        else
+                            closeness[v] *= count[l];
+                    }
                 }
             }
-            if (!harmonic)
-                closeness[v] = 1 / closeness[v];
-            if (norm)
-            {
-                if (harmonic)
-                    closeness[v] /= HN - 1;
-                else
-                    closeness[v] *= comp_size - 1;
-            }
-         }
+        }
     }
+};
 
-    class component_djk_visitor: public boost::dijkstra_visitor<>
+// Closeness estimated from the distances to a uniformly sampled set of k
+// pivots [eppstein-fast-2004]. The pivots are searched backwards, with
+// multi_source_bfs, so that every search yields the distance from all the
+// vertices to the pivot, and for every vertex the sums of these distances (or
+// of their inverses) and of their squares are accumulated. The sum over all
+// the vertices is then estimated as the sample mean times the number of
+// vertices, and the normalized closeness by the ratio of the number of
+// reachable pivots to the sum of their distances. The error of every vertex
+// is the standard error of its estimate, computed from the sample variance
+// (via the delta method for the inverse and the ratio), with the finite
+// population correction, so that it vanishes if all vertices are pivots.
+struct get_sampled_closeness
+{
+    template <class Graph, class VertexIndex, class Closeness, class RNG>
+    void operator()(const Graph& g, VertexIndex vertex_index,
+                    Closeness closeness, boost::any aerr, bool harmonic,
+                    bool norm, size_t n_samples, RNG& rng) const
     {
-    public:
-        //component_visitor() { }
-        component_djk_visitor(size_t& comp_size)
-            : _comp_size(comp_size) { }
+        using namespace boost;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef multi_source_bfs<Graph, VertexIndex> msbfs_t;
+        typedef typename msbfs_t::mask_t mask_t;
 
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex u, const Graph&)
-        {
-            ++_comp_size;
-        }
+        typename Closeness::checked_t err =
+            any_cast<typename Closeness::checked_t>(aerr);
 
-    private:
-        size_t& _comp_size;
-    };
+        size_t HN = HardNumVertices()(g);
+        size_t N = num_vertices(g);
 
-    // weighted version. Use dijkstra_shortest_paths()
-    struct get_dists_djk
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap, class WeightMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, WeightMap weights,
-                        size_t& comp_size) const
+        vector<vertex_t> sources;
+        sources.reserve(HN);
+        for (size_t i = 0; i < N; ++i)
         {
-            using namespace boost;
-            component_djk_visitor vis(comp_size);
-            dijkstra_shortest_paths(g, s, vertex_index_map(vertex_index).
-                                    weight_map(weights).distance_map(dist_map).visitor(vis));
+            vertex_t v = vertex(i, g);
+            if (v != graph_traits<Graph>::null_vertex())
+                sources.push_back(v);
         }
-    };
+        n_samples = min(n_samples, sources.size());
 
-    template <class DistMap>
-    class component_bfs_visitor: public boost::bfs_visitor<>
-    {
-    public:
-        //component_visitor() { }
-        component_bfs_visitor(DistMap dist_map, size_t& comp_size)
-            : _dist_map(dist_map), _comp_size(comp_size) { }
-
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex, const Graph&)
+        // draw the pivots (without replacement) beforehand, so that the sample
+        // does not depend on the number of threads
+        for (size_t j = 0; j < n_samples; ++j)
         {
-            ++_comp_size;
+            uniform_int_distribution<size_t> randint(j, sources.size() - 1);
+            swap(sources[j], sources[randint(rng)]);
         }
 
-        template <class Edge, class Graph>
-        void tree_edge(Edge e, const Graph& g)
+        vector<double> s1(N), s2(N);
+        vector<size_t> count(N);
+        vector<uint8_t> pivot(N);
+        for (size_t j = 0; j < n_samples; ++j)
+            pivot[get(vertex_index, sources[j])] = true;
+
+        int n_batches = (n_samples + msbfs_t::width - 1) / msbfs_t::width;
+
+        #pragma omp parallel if (N * n_samples > 100)
         {
-            _dist_map[target(e, g)] = _dist_map[source(e, g)] + 1;
+            msbfs_t bfs(g, vertex_index);
+
+            #pragma omp for schedule(runtime)
+            for (int b = 0; b < n_batches; ++b)
+            {
+                size_t first = b * msbfs_t::width;
+                size_t last = min(first + msbfs_t::width, n_samples);
+                bfs.run(sources.begin() + first, sources.begin() + last,
+                        [&](vertex_t u, size_t d, mask_t m)
+                        {
+                            size_t j = get(vertex_index, u);
+                            size_t n = __builtin_popcountll(m);
+                            double x = harmonic ? 1. / d : d;
+                            #pragma omp atomic
+                            s1[j] += n * x;
+                            #pragma omp atomic
+                            s2[j] += n * x * x;
+                            #pragma omp atomic
+                            count[j] += n;
+                        }, true);
+            }
         }
 
-    private:
-        DistMap _dist_map;
-        size_t& _comp_size;
-    };
+        // number of vertices other than v, from which the pivots are drawn
+        double M = HN - 1;
 
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 size_t j = get(vertex_index, v);
+                 double k = n_samples - pivot[j];
+                 if (k == 0)
+                 {
+                     closeness[v] = 0;
+                     err[v] = 0;
+                     return;
+                 }
 
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS, size_t& comp_size) const
-        {
-            using namespace boost;
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef unordered_map<vertex_t,default_color_type,
-                                  DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-            component_bfs_visitor<DistanceMap> vis(dist_map, comp_size);
-            breadth_first_visit(g, s, visitor(vis).
-                                color_map(color_map));
-        }
-    };
+                 double fpc = (M > 1) ? (M - k) / (M - 1) : 0;
+                 double mean = s1[j] / k;
+                 double var = 0;
+                 if (k > 1)
+                     var = max((s2[j] - k * mean * mean) / (k - 1), 0.);
+
+                 double c, e;
+                 if (harmonic)
+                 {
+                     c = M * mean;
+                     e = M * sqrt(var / k * fpc);
+                     if (norm)
+                     {
+                         c /= M;
+                         e /= M;
+                     }
+                 }
+                 else if (!norm)
+                 {
+                     double F = M * mean;
+                     c = 1 / F;
+                     e = M * sqrt(var / k * fpc) / (F * F);
+                 }
+                 else
+                 {
+                     // the indicator y of reachability satisfies y^2 = y and
+                     // y x = x, hence the residuals sum to the expression below
+                     double R = count[j] / s1[j];
+                     double q = 0;
+                     if (k > 1)
+                         q = max((count[j] - 2 * R * s1[j] + R * R * s2[j]) /
+                                 (k - 1), 0.);
+                     c = R;
+                     e = sqrt(q / k * fpc) / mean;
+                 }
+
+                 if (count[j] == 0)
+                     e = 0;
+                 closeness[v] = c;
+                 err[v] = e;
+             });
+    }
 };
 
 } // boost namespace
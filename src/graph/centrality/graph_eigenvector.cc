@@ -19,13 +19,15 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "random.hh"
 #include "graph_eigenvector.hh"
 
 using namespace std;
 using namespace graph_tool;
 
 long double eigenvector(GraphInterface& g, boost::any w, boost::any c,
-                        double epsilon, size_t max_iter)
+                        double epsilon, size_t max_iter, bool warm,
+                        rng_t& rng)
 {
     if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
         throw ValueException("edge property must be writable");
@@ -44,7 +46,7 @@ long double eigenvector(GraphInterface& g, boost::any w, boost::any c,
     run_action<>()
         (g, std::bind(get_eigenvector(), placeholders::_1, g.GetVertexIndex(),
                       placeholders::_2, placeholders::_3, epsilon, max_iter,
-                      std::ref(eig)),
+                      warm, std::ref(rng), std::ref(eig)),
          weight_props_t(),
          vertex_floating_properties())(w, c);
     return eig;
@@ -21,106 +21,96 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
-
-#ifndef __clang__
-#include <ext/numeric>
-using __gnu_cxx::power;
-#else
-template <class Value>
-Value power(Value value, int n)
-{
-    return pow(value, n);
-}
-#endif
+#include "parallel_loops.hh"
+#include "krylov.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The leading eigenvector of the adjacency matrix is obtained with the Lanczos
+// method for undirected graphs, where the matrix is symmetric, and with the
+// Arnoldi method otherwise. Both need far fewer matrix-vector products than
+// the power method, and converge also when the largest eigenvalue is not
+// well separated from the others (e.g. bipartite graphs). If 'warm' is true,
+// the iteration starts from the values in c, e.g. the eigenvector before a
+// small modification of the graph, which then needs only a few products.
+
 struct get_eigenvector
 {
     template <class Graph, class VertexIndex, class WeightMap,
-              class CentralityMap>
+              class CentralityMap, class RNG>
     void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
                     CentralityMap c, double epsilon, size_t max_iter,
-                    long double& eig) const
+                    bool warm, RNG& rng, long double& eig) const
     {
-        typedef typename property_traits<WeightMap>::value_type c_type;
-        typedef typename property_traits<CentralityMap>::value_type t_type;
-
-        CentralityMap c_temp(vertex_index, num_vertices(g));
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        size_t N = num_vertices(g);
 
-        t_type norm = 0;
-        t_type delta = epsilon + 1;
-        t_type prev_delta = delta + 1;
-        size_t iter = 0;
-        int i, N = num_vertices(g);
-        while (delta >= epsilon)
-        {
-            prev_delta = delta;
-            norm = 0;
-            #pragma omp parallel for default(shared) private(i) \
-                schedule(runtime) if (N > 100) reduction(+:norm)
-            for (i = 0; i < N; ++i)
+        auto matvec = [&](const kvec_t& x, kvec_t& y)
             {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
-                    continue;
+                y.assign(N, 0);
+                parallel_vertex_loop
+                    (g,
+                     [&](vertex_t v)
+                     {
+                         double r = 0;
+                         typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+                         for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
+                              e != e_end; ++e)
+                         {
+                             vertex_t s;
+                             if (is_directed::apply<Graph>::type::value)
+                                 s = source(*e, g);
+                             else
+                                 s = target(*e, g);
+                             r += get(w, *e) * x[get(vertex_index, s)];
+                         }
+                         y[get(vertex_index, v)] = r;
+                     });
+            };
 
-                c_temp[v] = 0;
-                typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
-                for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
-                     e != e_end; ++e)
-                {
-                    typename graph_traits<Graph>::vertex_descriptor s;
-                    if (is_directed::apply<Graph>::type::value)
-                        s = source(*e,g);
-                    else
-                        s = target(*e,g);
-                    c_temp[v] += get(w, *e) * c[s];
-                }
-                norm += power(c_temp[v], 2);
-            }
-            norm = sqrt(norm);
+        kvec_t x(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 x[get(vertex_index, v)] = warm ? double(c[v]) : 1.;
+             });
+        if (HardNumVertices()(g) == 0)
+            return;
+        if (warm && knorm(x) == 0)
+            return operator()(g, vertex_index, w, c, epsilon, max_iter, false,
+                              rng, eig);
 
-            delta = 0;
-            #pragma omp parallel for default(shared) private(i) \
-                schedule(runtime) if (N > 100) reduction(+:delta)
-            for (i = 0; i < N; ++i)
-            {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
-                    continue;
-                c_temp[v] /= norm;
-                delta += abs(c_temp[v] - c[v]);
-            }
-            swap(c_temp, c);
-
-            ++iter;
-            if (max_iter > 0 && iter == max_iter)
-                break;
-            if (max_iter == 0 && delta > prev_delta && iter > 100)
-                break;
+        if (is_directed::apply<Graph>::type::value)
+        {
+            size_t nmv;
+            eig = arnoldi(matvec, x, epsilon, max_iter, nmv);
         }
-
-        if (iter % 2 != 0)
+        else
         {
-            #pragma omp parallel for default(shared) private(i)     \
-                schedule(runtime) if (N > 100)
-            for (i = 0; i < N; ++i)
-            {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
-                    continue;
-                c[v] = c_temp[v];
-            }
+            kvec_t evals;
+            vector<kvec_t> evecs;
+            lanczos(matvec, x, 1, LARGEST_ALGEBRAIC, epsilon, max_iter, evals,
+                    evecs, rng);
+            eig = evals[0];
+            x.swap(evecs[0]);
         }
 
-        eig = norm;
+        // the Perron vector is non-negative
+        double sum = 0;
+        for (size_t i = 0; i < N; ++i)
+            sum += x[i];
+        double sign = (sum < 0) ? -1 : 1;
+
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 c[v] = sign * x[get(vertex_index, v)];
+             });
     }
 };
 
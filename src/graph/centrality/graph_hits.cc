@@ -21,6 +21,7 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "random.hh"
 #include "graph_hits.hh"
 
 using namespace std;
@@ -33,14 +34,14 @@ struct get_hits_dispatch
               class CentralityMap>
     void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
                     CentralityMap x, boost::any ay, double epsilon,
-                    size_t max_iter, long double& eig) const
+                    size_t max_iter, rng_t& rng, long double& eig) const
     {
         try
         {
             typename CentralityMap::checked_t y = any_cast<typename CentralityMap::checked_t>(ay);
             get_hits()(g, vertex_index, w, x,
                        y.get_unchecked(num_vertices(g)), epsilon, max_iter,
-                       eig);
+                       rng, eig);
         }
         catch (bad_any_cast&)
         {
@@ -51,7 +52,7 @@ struct get_hits_dispatch
 
 
 long double hits(GraphInterface& g, boost::any w, boost::any x, boost::any y,
-                 double epsilon, size_t max_iter)
+                 double epsilon, size_t max_iter, rng_t& rng)
 {
     if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
         throw ValueException("edge property must be writable");
@@ -70,7 +71,7 @@ long double hits(GraphInterface& g, boost::any w, boost::any x, boost::any y,
     run_action<>()
         (g, std::bind(get_hits_dispatch(), placeholders::_1, g.GetVertexIndex(),
                       placeholders::_2,  placeholders::_3, y, epsilon, max_iter,
-                      std::ref(eig)),
+                      std::ref(rng), std::ref(eig)),
          weight_props_t(),
          vertex_floating_properties())(w, x);
     return eig;
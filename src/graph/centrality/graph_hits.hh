@@ -15,134 +15,108 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef GRAPH_EIGENVECTOR_HH
-#define GRAPH_EIGENVECTOR_HH
+#ifndef GRAPH_HITS_HH
+#define GRAPH_HITS_HH
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
-
-#ifndef __clang__
-#include <ext/numeric>
-using __gnu_cxx::power;
-#else
-template <class Value>
-Value power(Value value, int n)
-{
-    return pow(value, n);
-}
-#endif
+#include "parallel_loops.hh"
+#include "krylov.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The authority centralities are the leading eigenvector of the symmetric
+// cocitation matrix A A^T, which is obtained with the Lanczos method, using
+// two passes over the edges per product. The hub centralities are then
+// y = A^T x.
+
 struct get_hits
 {
     template <class Graph, class VertexIndex, class WeightMap,
-              class CentralityMap>
+              class CentralityMap, class RNG>
     void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
                     CentralityMap x, CentralityMap y, double epsilon,
-                    size_t max_iter, long double& eig) const
+                    size_t max_iter, RNG& rng, long double& eig) const
     {
-        typedef typename property_traits<WeightMap>::value_type c_type;
-        typedef typename property_traits<CentralityMap>::value_type t_type;
-
-        CentralityMap x_temp(vertex_index, num_vertices(g));
-        CentralityMap y_temp(vertex_index, num_vertices(g));
-
-        // init centrality
-        int i, N = num_vertices(g), V = HardNumVertices()(g);
-        #pragma omp parallel for default(shared) private(i)     \
-                schedule(runtime) if (N > 100)
-        for (i = 0; i < N; ++i)
-        {
-            typename graph_traits<Graph>::vertex_descriptor v = vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
-            x[v] = 1.0 / V;
-            y[v] = 1.0 / V;
-        }
-
-        t_type x_norm = 0;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        size_t N = num_vertices(g);
 
-        t_type delta = epsilon + 1;
-        size_t iter = 0;
-        while (delta >= epsilon)
-        {
-            x_norm = 0;
-            #pragma omp parallel for default(shared) private(i) \
-                schedule(runtime) if (N > 100) reduction(+:x_norm)
-            for (i = 0; i < N; ++i)
+        // y = A^T x
+        auto hubs = [&](const kvec_t& ax, kvec_t& ay)
             {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
-                    continue;
-
-                x_temp[v] = 0;
-                typename in_or_out_edge_iteratorS<Graph>::type ie, ie_end;
-                for (tie(ie, ie_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
-                     ie != ie_end; ++ie)
-                {
-                    typename graph_traits<Graph>::vertex_descriptor s =
-                        source(*ie, g);
-                    if (is_directed::apply<Graph>::type::value)
-                        s = source(*ie, g);
-                    else
-                        s = target(*ie,g);
-                    x_temp[v] += get(w, *ie) * y[s];
-                }
-                x_norm += power(x_temp[v], 2);
-
-                y_temp[v] = 0;
-                typename graph_traits<Graph>::out_edge_iterator e, e_end;
-                for (tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
-                {
-                    typename graph_traits<Graph>::vertex_descriptor s = target(*e, g);
-                    y_temp[v] += get(w, *e) * x[s];
-                }
-            }
-            x_norm = sqrt(x_norm);
-
-            delta = 0;
-            #pragma omp parallel for default(shared) private(i) \
-                schedule(runtime) if (N > 100) reduction(+:delta)
-            for (i = 0; i < N; ++i)
+                parallel_vertex_loop
+                    (g,
+                     [&](vertex_t v)
+                     {
+                         double r = 0;
+                         typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                         for (tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
+                             r += get(w, *e) * ax[get(vertex_index, target(*e, g))];
+                         ay[get(vertex_index, v)] = r;
+                     });
+            };
+
+        kvec_t temp(N, 0);
+        auto matvec = [&](const kvec_t& ax, kvec_t& ret)
             {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
-                    continue;
-                x_temp[v] /= x_norm;
-                delta += abs(x_temp[v] - x[v]);
-                delta += abs(y_temp[v] - y[v]);
-            }
-            swap(x_temp, x);
-            swap(y_temp, y);
-
-            ++iter;
-            if (max_iter > 0 && iter== max_iter)
-                break;
-        }
-
-        if (iter % 2 != 0)
-        {
-            #pragma omp parallel for default(shared) private(i)     \
-                schedule(runtime) if (N > 100)
-            for (i = 0; i < N; ++i)
-            {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
-                    continue;
-                x[v] = x_temp[v];
-                y[v] = y_temp[v];
-            }
-        }
-
-        eig = x_norm;
+                hubs(ax, temp);
+                ret.assign(N, 0);
+                parallel_vertex_loop
+                    (g,
+                     [&](vertex_t v)
+                     {
+                         double r = 0;
+                         typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+                         for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
+                              e != e_end; ++e)
+                         {
+                             vertex_t s;
+                             if (is_directed::apply<Graph>::type::value)
+                                 s = source(*e, g);
+                             else
+                                 s = target(*e, g);
+                             r += get(w, *e) * temp[get(vertex_index, s)];
+                         }
+                         ret[get(vertex_index, v)] = r;
+                     });
+            };
+
+        kvec_t ax(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 ax[get(vertex_index, v)] = 1;
+             });
+        if (HardNumVertices()(g) == 0)
+            return;
+
+        kvec_t evals;
+        vector<kvec_t> evecs;
+        lanczos(matvec, ax, 1, LARGEST_ALGEBRAIC, epsilon, max_iter, evals,
+                evecs, rng);
+        eig = evals[0];
+        ax.swap(evecs[0]);
+
+        double sum = 0;
+        for (size_t i = 0; i < N; ++i)
+            sum += ax[i];
+        if (sum < 0)
+            kscale(ax, -1);
+        hubs(ax, temp);
+
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 size_t i = get(vertex_index, v);
+                 x[v] = ax[i];
+                 y[v] = temp[i];
+             });
     }
 };
 
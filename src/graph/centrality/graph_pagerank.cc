@@ -23,13 +23,15 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_pagerank.hh"
+#include "numpy_bind.hh"
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
 size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
-                boost::any weight, double d, double epsilon, size_t max_iter)
+                boost::any weight, double d, double epsilon, size_t max_iter,
+                bool async, bool single)
 {
     if (!belongs<vertex_floating_properties>()(rank))
         throw ValueException("rank vertex property must have a floating-point value type");
@@ -59,15 +61,114 @@ size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
         (g, std::bind(get_pagerank(),
                       placeholders::_1, g.GetVertexIndex(), placeholders::_2,
                       placeholders::_3, placeholders::_4, d,
-                      epsilon, max_iter, std::ref(iter)),
+                      epsilon, max_iter, async, single, std::ref(iter)),
          vertex_floating_properties(),
          pers_props_t(), weight_props_t())(rank, pers, weight);
     return iter;
 }
 
+size_t pagerank_batch(GraphInterface& g, boost::any weight,
+                      python::object opers, python::object orank, double d,
+                      double epsilon, size_t max_iter)
+{
+    typedef ConstantPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t(1.0);
+
+    multi_array_ref<double,2> pers = get_array<double,2>(opers);
+    multi_array_ref<double,2> rank = get_array<double,2>(orank);
+
+    size_t iter;
+    run_action<>()
+        (g, std::bind(get_pagerank_batch(),
+                      placeholders::_1, g.GetVertexIndex(), placeholders::_2,
+                      std::ref(pers), std::ref(rank), d, epsilon, max_iter,
+                      std::ref(iter)),
+         weight_props_t())(weight);
+    return iter;
+}
+
+size_t pagerank_push(GraphInterface& g, boost::any weight,
+                     python::object oindptr, python::object oindices,
+                     python::object odata, python::object orank, double d,
+                     double epsilon)
+{
+    typedef ConstantPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t(1.0);
+
+    multi_array_ref<int64_t,1> indptr = get_array<int64_t,1>(oindptr);
+    multi_array_ref<int64_t,1> indices = get_array<int64_t,1>(oindices);
+    multi_array_ref<double,1> data = get_array<double,1>(odata);
+    multi_array_ref<double,2> rank = get_array<double,2>(orank);
+
+    size_t pushes;
+    run_action<>()
+        (g, std::bind(get_pagerank_push(),
+                      placeholders::_1, g.GetVertexIndex(), placeholders::_2,
+                      std::ref(indptr), std::ref(indices), std::ref(data),
+                      std::ref(rank), d, epsilon, std::ref(pushes)),
+         weight_props_t())(weight);
+    return pushes;
+}
+
+size_t pagerank_update(GraphInterface& g, boost::any rank, boost::any pers,
+                       boost::any weight, python::object ochanged, double d,
+                       double epsilon)
+{
+    if (!belongs<vertex_floating_properties>()(rank))
+        throw ValueException("rank vertex property must have a floating-point value type");
+
+    if (!pers.empty() && !belongs<vertex_scalar_properties>()(pers))
+        throw ValueException("personalization vertex property must have a scalar value type");
+
+    typedef ConstantPropertyMap<double, GraphInterface::vertex_t> pers_map_t;
+    typedef boost::mpl::push_back<vertex_scalar_properties, pers_map_t>::type
+        pers_props_t;
+
+    if(pers.empty())
+        pers = pers_map_t(1.0 / g.GetNumberOfVertices());
+
+    typedef ConstantPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t(1.0);
+
+    multi_array_ref<int64_t,2> changed = get_array<int64_t,2>(ochanged);
+
+    size_t pushes;
+    run_action<>()
+        (g, std::bind(get_pagerank_update(),
+                      placeholders::_1, g.GetVertexIndex(), placeholders::_2,
+                      placeholders::_3, placeholders::_4, std::ref(changed), d,
+                      epsilon, std::ref(pushes)),
+         vertex_floating_properties(),
+         pers_props_t(), weight_props_t())(rank, pers, weight);
+    return pushes;
+}
 
 void export_pagerank()
 {
     using namespace boost::python;
     def("get_pagerank", &pagerank);
+    def("get_pagerank_batch", &pagerank_batch);
+    def("get_pagerank_push", &pagerank_push);
+    def("get_pagerank_update", &pagerank_update);
 }
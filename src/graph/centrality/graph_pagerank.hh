@@ -21,89 +21,504 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "parallel_loops.hh"
+
+#include <deque>
+#include <boost/multi_array.hpp>
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The contribution rank(s) * w / k(s) of each source vertex is the same for all
+// its out-edges, so its rank and inverse out-degree are combined only once per
+// vertex and iteration, and stored in a contiguous array indexed by the vertex
+// index, which is all the inner loop over the in-edges needs to read. The
+// array can be kept in single precision, which halves the memory traffic of
+// the inner loop.
+//
+// In the synchronous (Jacobi) mode, the contributions are a snapshot of the
+// previous iteration, so the ranks can be updated in place. In the
+// asynchronous (Gauss-Seidel) mode, each contribution is updated as soon as
+// the rank of its vertex changes, and a vertex is visited again only if one of
+// its in-neighbours changed by more than epsilon / N in the last sweep.
+//
+// With single precision the changes may stall above epsilon because of
+// rounding, so the iteration also stops once they no longer decrease.
+
 struct get_pagerank
 {
     template <class Graph, class VertexIndex, class RankMap, class PerMap,
               class Weight>
     void operator()(Graph& g, VertexIndex vertex_index, RankMap rank,
                     PerMap pers, Weight weight, double damping, double epsilon,
-                    size_t max_iter, size_t& iter) const
+                    size_t max_iter, bool async, bool single,
+                    size_t& iter) const
+    {
+        if (single)
+            run<float>(g, vertex_index, rank, pers, weight, damping, epsilon,
+                       max_iter, async, iter);
+        else
+            run<double>(g, vertex_index, rank, pers, weight, damping, epsilon,
+                        max_iter, async, iter);
+    }
+
+    template <class CType, class Graph, class VertexIndex, class RankMap,
+              class PerMap, class Weight>
+    void run(Graph& g, VertexIndex vertex_index, RankMap rank, PerMap pers,
+             Weight weight, double damping, double epsilon, size_t max_iter,
+             bool async, size_t& iter) const
     {
         typedef typename property_traits<RankMap>::value_type rank_type;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
 
-        RankMap r_temp(vertex_index, num_vertices(g));
-        RankMap deg(vertex_index, num_vertices(g));
+        // the same partition is used by all iterations
+        vector<size_t> blocks = get_vertex_partition(g);
+        size_t N = num_vertices(g);
 
-        // init degs
-        int i, N = num_vertices(g);
-        #pragma omp parallel for default(shared) private(i)     \
-                schedule(runtime) if (N > 100)
-        for (i = 0; i < N; ++i)
-        {
-            typename graph_traits<Graph>::vertex_descriptor v = vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
-            put(deg, v, 0);
-            typename graph_traits<Graph>::out_edge_iterator e, e_end;
-            for (tie(e, e_end) = out_edges(v, g); e!= e_end; ++e)
-                put(deg, v, get(deg, v) + get(weight, *e));
-        }
+        vector<rank_type> inv_deg(N, 0);
+        vector<CType> c(N, 0);
 
-        rank_type delta = epsilon + 1;
-        rank_type d = damping;
-        iter = 0;
-        while (delta >= epsilon)
-        {
-            delta = 0;
-            #pragma omp parallel for default(shared) private(i)     \
-                schedule(runtime) if (N > 100) reduction(+:delta)
-            for (i = 0; i < N; ++i)
-            {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
-                    continue;
+        // init inverse degrees and contributions
+        #pragma omp parallel if (N > 100)
+        parallel_vertex_loop_no_spawn
+            (g, blocks,
+             [&](vertex_t v)
+             {
+                 size_t i = get(vertex_index, v);
+                 rank_type k = 0;
+                 typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                 for (tie(e, e_end) = out_edges(v, g); e!= e_end; ++e)
+                     k += get(weight, *e);
+                 inv_deg[i] = (k > 0) ? 1. / k : 0;
+                 c[i] = get(rank, v) * inv_deg[i];
+             });
 
+        auto pull = [&](vertex_t v) -> rank_type
+            {
                 rank_type r = 0;
                 typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
                 for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
                      e != e_end; ++e)
                 {
-                    typename graph_traits<Graph>::vertex_descriptor s;
+                    vertex_t s;
                     if (is_directed::apply<Graph>::type::value)
                         s = source(*e, g);
                     else
                         s = target(*e, g);
-                    r += (get(rank, s) * get(weight, *e)) / get(deg, s);
+                    r += get(weight, *e) * c[get(vertex_index, s)];
                 }
+                return (1.0 - damping) * get(pers, v) + damping * r;
+            };
 
-                put(r_temp, v, (1.0 - d) * get(pers, v) + d * r);
+        rank_type delta = epsilon + 1;
+        rank_type prev_delta = delta + 1;
+        bool stall = std::is_same<CType, float>::value;
+        iter = 0;
+        if (!async)
+        {
+            while (delta >= epsilon)
+            {
+                if (iter > 0)
+                {
+                    #pragma omp parallel if (N > 100)
+                    parallel_vertex_loop_no_spawn
+                        (g, blocks,
+                         [&](vertex_t v)
+                         {
+                             size_t i = get(vertex_index, v);
+                             c[i] = get(rank, v) * inv_deg[i];
+                         });
+                }
 
-                delta += abs(get(r_temp, v) - get(rank, v));
+                delta = 0;
+                #pragma omp parallel if (N > 100) reduction(+:delta)
+                parallel_vertex_loop_no_spawn
+                    (g, blocks,
+                     [&](vertex_t v)
+                     {
+                         rank_type r = pull(v);
+                         delta += abs(r - get(rank, v));
+                         put(rank, v, r);
+                     });
+                ++iter;
+                if (max_iter > 0 && iter == max_iter)
+                    break;
+                if (stall && delta >= prev_delta)
+                    break;
+                prev_delta = delta;
+            }
+        }
+        else
+        {
+            rank_type threshold = epsilon / HardNumVertices()(g);
+
+            // 'active' is only ever set concurrently to the same value, and a
+            // vertex which is activated while it is being updated is simply
+            // visited again in the next sweep
+            vector<uint8_t> active(N, 1);
+            while (delta >= epsilon)
+            {
+                delta = 0;
+                #pragma omp parallel if (N > 100) reduction(+:delta)
+                parallel_vertex_loop_no_spawn
+                    (g, blocks,
+                     [&](vertex_t v)
+                     {
+                         size_t i = get(vertex_index, v);
+                         if (!active[i])
+                             return;
+                         active[i] = false;
+
+                         rank_type r = pull(v);
+                         rank_type diff = abs(r - get(rank, v));
+                         put(rank, v, r);
+                         c[i] = r * inv_deg[i];
+                         delta += diff;
+
+                         if (diff <= threshold)
+                             return;
+                         typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                         for (tie(e, e_end) = out_edges(v, g); e!= e_end; ++e)
+                             active[get(vertex_index, target(*e, g))] = true;
+                     });
+                ++iter;
+                if (max_iter > 0 && iter == max_iter)
+                    break;
+                if (stall && delta >= prev_delta)
+                    break;
+                prev_delta = delta;
+            }
+        }
+    }
+};
+
+// Personalized PageRank for many personalization vectors at once. The K
+// values of each vertex are stored contiguously (rows of N x K arrays indexed
+// by the vertex index), so that a single traversal of the in-edges updates
+// all vectors, and the innermost loop over the K values can be vectorized.
+struct get_pagerank_batch
+{
+    template <class Graph, class VertexIndex, class Weight>
+    void operator()(Graph& g, VertexIndex vertex_index, Weight weight,
+                    multi_array_ref<double,2>& pers,
+                    multi_array_ref<double,2>& rank, double damping,
+                    double epsilon, size_t max_iter, size_t& iter) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        vector<size_t> blocks = get_vertex_partition(g);
+        size_t N = num_vertices(g), K = rank.shape()[1];
+        double* r_data = rank.data();
+        const double* p_data = pers.data();
+
+        vector<double> inv_deg(N, 0);
+        vector<double> c(N * K);
+
+        #pragma omp parallel if (N > 100)
+        parallel_vertex_loop_no_spawn
+            (g, blocks,
+             [&](vertex_t v)
+             {
+                 size_t i = get(vertex_index, v);
+                 double k = 0;
+                 typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                 for (tie(e, e_end) = out_edges(v, g); e!= e_end; ++e)
+                     k += get(weight, *e);
+                 inv_deg[i] = (k > 0) ? 1. / k : 0;
+             });
+
+        vector<double> delta(K, epsilon + 1);
+        iter = 0;
+        while (*max_element(delta.begin(), delta.end()) >= epsilon)
+        {
+            #pragma omp parallel if (N > 100)
+            parallel_vertex_loop_no_spawn
+                (g, blocks,
+                 [&](vertex_t v)
+                 {
+                     size_t i = get(vertex_index, v);
+                     for (size_t j = 0; j < K; ++j)
+                         c[i * K + j] = r_data[i * K + j] * inv_deg[i];
+                 });
+
+            std::fill(delta.begin(), delta.end(), 0);
+            #pragma omp parallel if (N > 100)
+            {
+                vector<double> r(K), ldelta(K, 0);
+                parallel_vertex_loop_no_spawn
+                    (g, blocks,
+                     [&](vertex_t v)
+                     {
+                         std::fill(r.begin(), r.end(), 0);
+                         typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+                         for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
+                              e != e_end; ++e)
+                         {
+                             vertex_t s;
+                             if (is_directed::apply<Graph>::type::value)
+                                 s = source(*e, g);
+                             else
+                                 s = target(*e, g);
+                             double w = get(weight, *e);
+                             const double* cs = &c[get(vertex_index, s) * K];
+                             for (size_t j = 0; j < K; ++j)
+                                 r[j] += w * cs[j];
+                         }
+
+                         size_t i = get(vertex_index, v);
+                         double* rv = r_data + i * K;
+                         const double* pv = p_data + i * K;
+                         for (size_t j = 0; j < K; ++j)
+                         {
+                             double nr = (1.0 - damping) * pv[j] + damping * r[j];
+                             ldelta[j] += abs(nr - rv[j]);
+                             rv[j] = nr;
+                         }
+                     });
+                #pragma omp critical
+                for (size_t j = 0; j < K; ++j)
+                    delta[j] += ldelta[j];
             }
-            swap(r_temp, rank);
             ++iter;
             if (max_iter > 0 && iter == max_iter)
                 break;
         }
+    }
+};
+
+// Approximate personalized PageRank with local pushes [andersen-local-2006].
+// Each vector keeps a residual, which starts as the personalization vector,
+// and the residual of a vertex u is pushed while it is at least epsilon * k_u:
+// a fraction (1 - damping) of it is added to the rank of u, and the rest is
+// spread over its out-neighbours. The work done for each vector depends only
+// on the neighbourhood of its seeds, not on the size of the graph. The
+// personalization vectors are given in compressed sparse column form, and the
+// vectors are processed in parallel, each by a single thread with its own
+// residual buffer, which is reset only where it was touched.
+struct get_pagerank_push
+{
+    template <class Graph, class VertexIndex, class Weight>
+    void operator()(Graph& g, VertexIndex vertex_index, Weight weight,
+                    multi_array_ref<int64_t,1>& indptr,
+                    multi_array_ref<int64_t,1>& indices,
+                    multi_array_ref<double,1>& data,
+                    multi_array_ref<double,2>& rank, double damping,
+                    double epsilon, size_t& pushes) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        size_t N = num_vertices(g), K = rank.shape()[1];
+        double* r_data = rank.data();
+
+        vector<double> deg(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 double k = 0;
+                 typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                 for (tie(e, e_end) = out_edges(v, g); e!= e_end; ++e)
+                     k += get(weight, *e);
+                 deg[get(vertex_index, v)] = k;
+             });
 
-        if (iter % 2 != 0)
+        size_t npushes = 0;
+        int j;
+        #pragma omp parallel default(shared) private(j) \
+            reduction(+:npushes) if (K > 1)
         {
-            #pragma omp parallel for default(shared) private(i)     \
-                schedule(runtime) if (N > 100)
-            for (i = 0; i < N; ++i)
+            vector<double> res(N, 0);
+            vector<uint8_t> queued(N, false);
+            vector<vertex_t> touched;
+            deque<vertex_t> queue;
+
+            auto enqueue = [&](vertex_t u)
+                {
+                    size_t i = get(vertex_index, u);
+                    if (!queued[i] && res[i] >= epsilon * max(deg[i], 1.))
+                    {
+                        queued[i] = true;
+                        queue.push_back(u);
+                    }
+                };
+
+            #pragma omp for schedule(dynamic)
+            for (j = 0; j < int(K); ++j)
+            {
+                for (int64_t pos = indptr[j]; pos < indptr[j + 1]; ++pos)
+                {
+                    vertex_t u = vertex(indices[pos], g);
+                    if (u == graph_traits<Graph>::null_vertex())
+                        continue;
+                    res[get(vertex_index, u)] += data[pos];
+                    touched.push_back(u);
+                    enqueue(u);
+                }
+
+                while (!queue.empty())
+                {
+                    vertex_t u = queue.front();
+                    queue.pop_front();
+                    size_t i = get(vertex_index, u);
+                    queued[i] = false;
+
+                    double ru = res[i];
+                    res[i] = 0;
+                    r_data[i * K + j] += (1.0 - damping) * ru;
+                    ++npushes;
+
+                    if (deg[i] == 0)
+                        continue;
+                    double f = damping * ru / deg[i];
+                    typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                    for (tie(e, e_end) = out_edges(u, g); e!= e_end; ++e)
+                    {
+                        vertex_t t = target(*e, g);
+                        double& rt = res[get(vertex_index, t)];
+                        if (rt == 0)
+                            touched.push_back(t);
+                        rt += f * get(weight, *e);
+                        enqueue(t);
+                    }
+                }
+
+                // the remaining residuals are below the threshold, and are
+                // dropped
+                for (auto u : touched)
+                    res[get(vertex_index, u)] = 0;
+                touched.clear();
+            }
+        }
+        pushes = npushes;
+    }
+};
+
+// Updates the PageRank values after a few edges were inserted or removed. If
+// x holds the values before the change, the residuals
+// r = (1-d)p + d P^T x - x are only nonzero at the targets of the changed
+// edges, and at the out-neighbours of their sources, whose out-degrees
+// changed. These are computed exactly, and then propagated with signed pushes
+// (Gauss-Seidel updates in the order of a queue), until they are all below
+// epsilon / N. The work done depends on the size of the change, not on the
+// size of the graph, and the out-degrees are only computed for the vertices
+// which are reached.
+struct get_pagerank_update
+{
+    template <class Graph, class VertexIndex, class RankMap, class PerMap,
+              class Weight>
+    void operator()(Graph& g, VertexIndex vertex_index, RankMap rank,
+                    PerMap pers, Weight weight,
+                    multi_array_ref<int64_t,2>& changed, double damping,
+                    double epsilon, size_t& pushes) const
+    {
+        typedef typename property_traits<RankMap>::value_type rank_type;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+        size_t N = num_vertices(g);
+        vector<double> deg(N, -1);
+        auto get_deg = [&](vertex_t u) -> double
+            {
+                double& k = deg[get(vertex_index, u)];
+                if (k < 0)
+                {
+                    k = 0;
+                    typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                    for (tie(e, e_end) = out_edges(u, g); e!= e_end; ++e)
+                        k += get(weight, *e);
+                }
+                return k;
+            };
+
+        vector<rank_type> res(N, 0);
+        vector<uint8_t> queued(N, false);
+        deque<vertex_t> queue;
+
+        // collect the affected vertices
+        vector<vertex_t> affected;
+        auto mark = [&](vertex_t v)
+            {
+                size_t i = get(vertex_index, v);
+                if (!queued[i])
+                {
+                    queued[i] = true;
+                    affected.push_back(v);
+                }
+            };
+        for (size_t l = 0; l < changed.shape()[0]; ++l)
+        {
+            for (size_t dir = 0; dir < 2; ++dir)
             {
-                typename graph_traits<Graph>::vertex_descriptor v =
-                    vertex(i, g);
-                if (v == graph_traits<Graph>::null_vertex())
+                if (dir == 1 && is_directed::apply<Graph>::type::value)
+                    break;
+                vertex_t s = vertex(changed[l][dir], g);
+                vertex_t t = vertex(changed[l][1 - dir], g);
+                if (s == graph_traits<Graph>::null_vertex() ||
+                    t == graph_traits<Graph>::null_vertex())
                     continue;
-                put(rank, v, get(r_temp, v));
+                mark(t);
+                typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                for (tie(e, e_end) = out_edges(s, g); e!= e_end; ++e)
+                    mark(target(*e, g));
+            }
+        }
+
+        for (auto v : affected)
+        {
+            rank_type r = 0;
+            typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+            for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
+                 e != e_end; ++e)
+            {
+                vertex_t s;
+                if (is_directed::apply<Graph>::type::value)
+                    s = source(*e, g);
+                else
+                    s = target(*e, g);
+                r += get(rank, s) * get(weight, *e) / get_deg(s);
+            }
+            res[get(vertex_index, v)] = (1.0 - damping) * get(pers, v) +
+                damping * r - get(rank, v);
+        }
+
+        rank_type threshold = epsilon / HardNumVertices()(g);
+        for (auto v : affected)
+        {
+            size_t i = get(vertex_index, v);
+            queued[i] = abs(res[i]) > threshold;
+            if (queued[i])
+                queue.push_back(v);
+        }
+
+        pushes = 0;
+        while (!queue.empty())
+        {
+            vertex_t u = queue.front();
+            queue.pop_front();
+            size_t i = get(vertex_index, u);
+            queued[i] = false;
+
+            rank_type ru = res[i];
+            res[i] = 0;
+            put(rank, u, get(rank, u) + ru);
+            ++pushes;
+
+            double k = get_deg(u);
+            if (k == 0)
+                continue;
+            rank_type f = damping * ru / k;
+            typename graph_traits<Graph>::out_edge_iterator e, e_end;
+            for (tie(e, e_end) = out_edges(u, g); e!= e_end; ++e)
+            {
+                vertex_t t = target(*e, g);
+                size_t j = get(vertex_index, t);
+                res[j] += f * get(weight, *e);
+                if (!queued[j] && abs(res[j]) > threshold)
+                {
+                    queued[j] = true;
+                    queue.push_back(t);
+                }
             }
         }
     }
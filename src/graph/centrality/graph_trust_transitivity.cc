@@ -21,6 +21,7 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 
 #include "graph_trust_transitivity.hh"
 
@@ -28,17 +29,20 @@ using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
-void trust_transitivity(GraphInterface& g, int64_t source, int64_t target,
-                    boost::any c, boost::any t)
+void trust_transitivity(GraphInterface& g, int64_t source,
+                        python::object otargets, boost::any c, boost::any t)
 {
     if (!belongs<edge_floating_properties>()(c))
         throw ValueException("edge property must be of floating point value type");
     if (!belongs<vertex_floating_vector_properties>()(t))
         throw ValueException("vertex property must be of floating point valued vector type");
 
+    multi_array_ref<int64_t,1> atargets = get_array<int64_t,1>(otargets);
+    vector<int64_t> targets(atargets.begin(), atargets.end());
+
     run_action<>()(g,
                    bind<void>(get_trust_transitivity(), _1, g.GetVertexIndex(),
-                              source, target, _2, _3),
+                              source, targets, _2, _3),
                    edge_floating_properties(),
                    vertex_floating_vector_properties())(c,t);
 }
@@ -21,220 +21,263 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "parallel_loops.hh"
+#include "search_workspace.hh"
 
 #include <algorithm>
 
-#include <boost/graph/dijkstra_shortest_paths.hpp>
-
-#include <iostream>
-
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
 
-struct stop_search {}; // exception to be thrown to stop search
-
-template <class SourceMap, class WeightMap>
-class source_counter:
-    public boost::dijkstra_visitor<null_visitor>
+// Dijkstra search for the paths of maximum weight, where the weight of a path
+// is the product of the trust values of its edges, which lie in [0, 1]. The
+// weights, colors and heap positions are kept in a search_workspace, with zero
+// as the weight of unreached vertices, so that every thread can reuse the same
+// object for many searches, at a cost proportional to the explored part of the
+// graph. The search can be asked to stop as soon as a given set of marked
+// vertices is settled.
+template <class Graph, class VertexIndex, class TrustMap, class Type>
+class trust_search
 {
 public:
-    source_counter(SourceMap source_map, WeightMap weight_map, size_t n_sources)
-        : _source_map(source_map), _weight_map(weight_map),
-          _n_sources(n_sources) {}
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef search_workspace<Type> ws_t;
+
+    trust_search(const Graph& g, VertexIndex vertex_index, TrustMap c)
+        : _g(g), _vertex_index(vertex_index), _c(c),
+          _ws(num_vertices(g), 0), _mark(num_vertices(g), false) {}
 
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor u,
-                        Graph&)
+    // the search will not stop before v is settled
+    void mark(vertex_t v)
     {
-        // stop if all sources are found
-        if (_source_map[u])
+        size_t i = get(_vertex_index, v);
+        if (_mark[i])
+            return;
+        _mark[i] = true;
+        _marked.push_back(i);
+    }
+
+    // Searches from s in the graph without the vertex 'skip', following the
+    // edges backwards if 'reversed' is true. If any vertices were marked, the
+    // search stops when all of them are settled.
+    void run(vertex_t s, vertex_t skip, bool reversed)
+    {
+        d_ary_heap_indirect<size_t, 4, typename ws_t::pos_map_t,
+                            typename ws_t::dist_map_t, std::greater<Type>>
+            queue(_ws.get_dist_map(), _ws.get_pos_map());
+
+        size_t remaining = _marked.size();
+        size_t is = get(_vertex_index, s);
+        _ws.discover(is, 1, is);
+        queue.push(is);
+
+        while (!queue.empty())
         {
-            _n_sources--;
-            if (_n_sources == 0)
-                throw stop_search();
+            size_t i = queue.top();
+            queue.pop();
+            _ws.color(i) = ws_t::BLACK;
+            if (_mark[i] && --remaining == 0)
+                break;
+
+            vertex_t v = vertex(i, _g);
+            Type d = _ws.dist(i);
+            auto relax = [&](const typename graph_traits<Graph>::edge_descriptor& e,
+                             vertex_t u)
+                {
+                    size_t j = get(_vertex_index, u);
+                    if (u == skip || _ws.color(j) == ws_t::BLACK)
+                        return;
+                    Type nd = d * _c[e];
+                    if (nd <= _ws.dist(j))
+                        return;
+                    if (_ws.color(j) == ws_t::WHITE)
+                    {
+                        _ws.discover(j, nd, i);
+                        queue.push(j);
+                    }
+                    else
+                    {
+                        _ws.dist(j) = nd;
+                        queue.update(j);
+                    }
+                };
+
+            if (reversed)
+            {
+                typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+                for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, _g);
+                     e != e_end; ++e)
+                {
+                    if (is_directed::apply<Graph>::type::value)
+                        relax(*e, boost::source(*e, _g));
+                    else
+                        relax(*e, boost::target(*e, _g));
+                }
+            }
+            else
+            {
+                typename graph_traits<Graph>::out_edge_iterator e, e_end;
+                for (tie(e, e_end) = out_edges(v, _g); e != e_end; ++e)
+                    relax(*e, boost::target(*e, _g));
+            }
         }
     }
 
-private:
-    SourceMap _source_map;
-    WeightMap _weight_map;
-    size_t _n_sources;
-};
+    // weight of the best path from the source to v, or zero if unreachable
+    Type dist(vertex_t v) const { return _ws.dist(get(_vertex_index, v)); }
 
-struct dist_compare
-{
-    template <class Type1, class Type2>
-    bool operator()(const Type1& d1, const Type2& d2) const
-    {
-        return d1 > d2; // we want trust paths with _maximum_ "distance"
-    }
-};
+    // indexes of the vertices reached by the last search
+    const vector<size_t>& touched() const { return _ws.touched(); }
+    Type dist_at(size_t i) const { return _ws.dist(i); }
 
-struct dist_combine
-{
-    template <class DistType, class WeightType>
-    DistType operator()(const DistType& d, const WeightType& w) const
+    void reset()
     {
-        return DistType(d * w);
+        _ws.reset();
+        for (auto i : _marked)
+            _mark[i] = false;
+        _marked.clear();
     }
-};
 
-// predicate to filter a single vertex from the graph
-struct filter_vertex_pred
-{
-    filter_vertex_pred() {}
-    filter_vertex_pred(size_t v): _v(v) {}
-    template <class Vertex>
-    bool operator()(const Vertex& v) const { return v != _v; }
-    size_t _v;
+private:
+    const Graph& _g;
+    VertexIndex _vertex_index;
+    TrustMap _c;
+    ws_t _ws;
+    vector<uint8_t> _mark;
+    vector<size_t> _marked;
 };
 
+// Computes the trust from 'source' to the given targets (or to all vertices if
+// 'targets' is empty), or from all vertices to the targets if source == -1, in
+// which case t[v][k] is the trust from v to the k-th target (or to the vertex
+// with index k, if all of them are targets). The targets are distributed among
+// the threads, each of which keeps a single search object.
 struct get_trust_transitivity
 {
     template <class Graph, class VertexIndex, class TrustMap,
               class InferredTrustMap>
     void operator()(Graph& g, VertexIndex vertex_index, int64_t source,
-                    int64_t target, TrustMap c, InferredTrustMap t) const
+                    const vector<int64_t>& targets, TrustMap c,
+                    InferredTrustMap t) const
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
-        typedef typename property_traits<TrustMap>::value_type c_type;
         typedef typename
             property_traits<InferredTrustMap>::value_type::value_type t_type;
+        typedef trust_search<Graph, VertexIndex, TrustMap, t_type> search_t;
 
-        int i, N = num_vertices(g);
-        #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
-        for (i = 0; i < N; ++i)
+        size_t N = num_vertices(g);
+
+        vector<vertex_t> tgts;
+        if (targets.empty())
+        {
+            for (size_t i = 0; i < N; ++i)
+            {
+                vertex_t v = vertex(i, g);
+                if (v != graph_traits<Graph>::null_vertex())
+                    tgts.push_back(v);
+            }
+        }
+        else
         {
-            vertex_t v = vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
-            t[v].resize((source == -1 && target == -1) ? N : 1);
+            for (auto i : targets)
+                tgts.push_back(vertex(i, g));
         }
 
-        N = (target == -1) ? num_vertices(g) : target + 1;
-        #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
-        for (i = (target == -1) ? 0 : target; i < N; ++i)
+        size_t n_t = 1;
+        if (source == -1)
+            n_t = targets.empty() ? N : targets.size();
+
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 t[v].clear();
+                 t[v].resize(n_t);
+             });
+
+        int i, NT = tgts.size();
+        #pragma omp parallel if (N > 100)
         {
-            vertex_t tgt = vertex(i, g);
-            if (tgt == graph_traits<Graph>::null_vertex())
-                continue;
-
-            // mark the sources
-            typedef unchecked_vector_property_map<uint8_t, VertexIndex>
-                source_map_t;
-            source_map_t source_map(vertex_index, num_vertices(g));
-
-            typename in_edge_iteratorS<Graph>::type e, e_end;
-            for (tie(e, e_end) = in_edge_iteratorS<Graph>::get_edges(tgt, g);
-                 e != e_end; ++e)
-                source_map[boost::source(*e,g)] = true;
-
-            // filter vertex w out of the graph
-            typedef filtered_graph<Graph, boost::keep_all, filter_vertex_pred>
-                fg_t;
-            fg_t fg(g, boost::keep_all(), filter_vertex_pred(tgt));
-
-            // distance map (target weight map)
-            typedef unchecked_vector_property_map<t_type, VertexIndex>
-                dist_map_t;
-            dist_map_t dist_map(vertex_index, num_vertices(g));
-
-            // color map
-            typedef unchecked_vector_property_map<default_color_type, VertexIndex>
-                color_map_t;
-            color_map_t color_map(vertex_index, num_vertices(g));
-
-            if (source != -1)
+            search_t search(g, vertex_index, c);
+
+            // total path weight from each source, and the sources reached
+            vector<t_type> sum_w((source == -1) ? N : 0);
+            vector<size_t> reached;
+
+            #pragma omp for schedule(runtime)
+            for (i = 0; i < NT; ++i)
             {
-                vertex_t src = vertex(source, g);
+                vertex_t tgt = tgts[i];
+                if (tgt == graph_traits<Graph>::null_vertex())
+                    continue;
 
-                // compute the targets weights
-                try
+                typename in_edge_iteratorS<Graph>::type e, e_end;
+                if (source != -1)
                 {
-                    size_t k = in_degreeS()(tgt, g);
-                    source_counter<source_map_t,dist_map_t>
-                        visitor(source_map, dist_map, k);
-                    dijkstra_shortest_paths(fg, src, weight_map(c).
-                                            vertex_index_map(vertex_index).
-                                            color_map(color_map).
-                                            distance_map(dist_map).
-                                            distance_compare(dist_compare()).
-                                            distance_combine(dist_combine()).
-                                            distance_inf(t_type(0)).
-                                            distance_zero(t_type(1)).
-                                            visitor(visitor));
-                }
-                catch (const stop_search&) {}
+                    vertex_t src = vertex(source, g);
+                    if (tgt == src)
+                    {
+                        t[tgt][0] = 1.0;
+                        continue;
+                    }
 
-                // compute the target's trust
-                t_type sum_w = 0, avg = 0;
-                for (tie(e, e_end) =
-                         in_edge_iteratorS<Graph>::get_edges(tgt, g);
-                     e != e_end; ++e)
-                {
-                    t_type weight = dist_map[boost::source(*e,g)];
-                    sum_w += weight;
-                    avg += c[*e]*weight*weight;
+                    // the search can stop once all the in-neighbours of the
+                    // target are settled
+                    for (tie(e, e_end) = in_edge_iteratorS<Graph>::get_edges(tgt, g);
+                         e != e_end; ++e)
+                    {
+                        if (boost::source(*e, g) != tgt)
+                            search.mark(boost::source(*e, g));
+                    }
+                    search.run(src, tgt, false);
+
+                    t_type w_sum = 0, avg = 0;
+                    for (tie(e, e_end) = in_edge_iteratorS<Graph>::get_edges(tgt, g);
+                         e != e_end; ++e)
+                    {
+                        t_type weight = search.dist(boost::source(*e, g));
+                        w_sum += weight;
+                        avg += c[*e] * weight * weight;
+                    }
+                    if (w_sum > 0)
+                        t[tgt][0] = avg / w_sum;
+                    search.reset();
                 }
-                if (sum_w > 0)
-                    t[tgt][0] = avg/sum_w;
-                if (tgt == src)
-                    t[tgt][0] = 1.0;
-            }
-            else
-            {
-                typedef typename
-                    mpl::if_<typename is_directed::apply<Graph>::type,
-                             reverse_graph<fg_t>,
-                             fg_t>::type rg_t;
-                rg_t rg(fg);
-                dist_map_t sum_w(vertex_index, num_vertices(g));
-                int j, N2 = num_vertices(g);
-                for (tie(e, e_end) =
-                         in_edge_iteratorS<Graph>::get_edges(tgt, g);
-                     e != e_end; ++e)
+                else
                 {
-                    // compute the weights to all sources
-                    dijkstra_shortest_paths
-                        (rg, boost::source(*e, g), weight_map(c).
-                         vertex_index_map(vertex_index).
-                         color_map(color_map).
-                         distance_map(dist_map).
-                         distance_compare(dist_compare()).
-                         distance_combine(dist_combine()).
-                         distance_inf(t_type(0)).
-                         distance_zero(t_type(1)));
-
-                    #pragma omp parallel for default(shared) private(j) \
-                        schedule(runtime) if (N > 100)
-                    for (j = 0; j < N2; ++j)
+                    size_t tidx = targets.empty() ?
+                        get(vertex_index, tgt) : size_t(i);
+
+                    // the weights to all sources are computed by searching
+                    // backwards from every in-neighbour of the target
+                    for (tie(e, e_end) = in_edge_iteratorS<Graph>::get_edges(tgt, g);
+                         e != e_end; ++e)
                     {
-                        vertex_t src = vertex(j, g);
-                        if (src == graph_traits<Graph>::null_vertex())
+                        vertex_t m = boost::source(*e, g);
+                        if (m == tgt)
                             continue;
-                        t_type weight = dist_map[src];
-                        sum_w[src] += weight;
-                        size_t tidx = (target == -1) ? vertex_index[tgt] : 0;
-                        t[src][tidx] += c[*e]*weight*weight;
+                        search.run(m, tgt, true);
+                        for (auto j : search.touched())
+                        {
+                            t_type weight = search.dist_at(j);
+                            if (sum_w[j] == 0)
+                                reached.push_back(j);
+                            sum_w[j] += weight;
+                            t[vertex(j, g)][tidx] += c[*e] * weight * weight;
+                        }
+                        search.reset();
                     }
-                }
 
-                #pragma omp parallel for default(shared) private(j) \
-                    schedule(runtime) if (N > 100)
-                for (j = 0; j < N2; ++j)
-                {
-                    vertex_t src = vertex(j, g);
-                    if (src == graph_traits<Graph>::null_vertex())
-                        continue;
-                    size_t tidx = (target == -1) ? vertex_index[tgt] : 0;
-                    if (sum_w[src] > 0)
-                        t[src][tidx] /= sum_w[src];
-                    if (src == tgt)
-                        t[src][tidx] = 1.0;
+                    for (auto j : reached)
+                    {
+                        t[vertex(j, g)][tidx] /= sum_w[j];
+                        sum_w[j] = 0;
+                    }
+                    reached.clear();
+                    t[tgt][tidx] = 1.0;
                 }
             }
         }
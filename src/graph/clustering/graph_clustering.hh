@@ -23,6 +23,8 @@
 #include <unordered_set>
 #include <boost/mpl/if.hpp>
 
+#include "parallel_loops.hh"
+
 #ifdef HAVE_SPARSEHASH
 #include SPARSEHASH_INCLUDE(dense_hash_set)
 #endif
@@ -101,42 +103,37 @@ struct get_global_clustering
     template <class Graph>
     void operator()(const Graph& g, double& c, double& c_err) const
     {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
         size_t triangles = 0, n = 0;
-        pair<size_t, size_t> temp;
-
-        int i, N = num_vertices(g);
-
-        #pragma omp parallel for default(shared) private(i,temp) \
-            schedule(runtime) if (N > 100) reduction(+:triangles, n)
-        for (i = 0; i < N; ++i)
-        {
-            typename graph_traits<Graph>::vertex_descriptor v = vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
 
-            temp = get_triangles(v, g);
-            triangles += temp.first;
-            n += temp.second;
-        }
+        vector<size_t> blocks = get_vertex_partition(g);
+        size_t N = num_vertices(g);
+
+        #pragma omp parallel if (N > 100) reduction(+:triangles, n)
+        parallel_vertex_loop_no_spawn
+            (g, blocks,
+             [&](vertex_t v)
+             {
+                 pair<size_t, size_t> temp = get_triangles(v, g);
+                 triangles += temp.first;
+                 n += temp.second;
+             });
         c = double(triangles) / n;
 
         // "jackknife" variance
         c_err = 0.0;
         double cerr = 0.0;
 
-        #pragma omp parallel for default(shared) private(i,temp) \
-            schedule(runtime) if (N > 100) reduction(+:cerr)
-        for (i = 0; i < N; ++i)
-        {
-            typename graph_traits<Graph>::vertex_descriptor v = vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
+        #pragma omp parallel if (N > 100) reduction(+:cerr)
+        parallel_vertex_loop_no_spawn
+            (g, blocks,
+             [&](vertex_t v)
+             {
+                 pair<size_t, size_t> temp = get_triangles(v, g);
+                 double cl = double(triangles - temp.first) / (n - temp.second);
 
-            temp = get_triangles(v, g);
-            double cl = double(triangles - temp.first) / (n - temp.second);
-
-            cerr += power(c - cl, 2);
-        }
+                 cerr += power(c - cl, 2);
+             });
         c_err = sqrt(cerr);
     }
 };
@@ -148,23 +145,20 @@ struct set_clustering_to_property
     void operator()(const Graph& g, ClustMap clust_map) const
     {
         typedef typename property_traits<ClustMap>::value_type c_type;
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
         typename get_undirected_graph<Graph>::type ug(g);
-        int i, N = num_vertices(g);
 
-        #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
-        for (i = 0; i < N; ++i)
-        {
-            typename graph_traits<Graph>::vertex_descriptor v = vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
-
-            pair<size_t,size_t> triangles = get_triangles(v,ug); // get from ug
-            double clustering = (triangles.second > 0) ?
-                double(triangles.first)/triangles.second :
-                0.0;
-
-            clust_map[v] = c_type(clustering);
-        }
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 pair<size_t,size_t> triangles = get_triangles(v,ug); // get from ug
+                 double clustering = (triangles.second > 0) ?
+                     double(triangles.first)/triangles.second :
+                     0.0;
+
+                 clust_map[v] = c_type(clustering);
+             });
     }
 
     template <class Graph>
@@ -23,8 +23,10 @@
 #include <boost/functional/hash.hpp>
 #include <algorithm>
 #include <vector>
+#include <memory>
 
 #include "random.hh"
+#include "parallel_loops.hh"
 
 namespace graph_tool
 {
@@ -144,24 +146,22 @@ struct sample_all
 
 struct sample_some
 {
-    sample_some(std::vector<double>& p, rng_t& rng): _p(&p), _rng(&rng) {}
+    sample_some(std::vector<double>& p, rng_t& rng)
+        : _p(&p), _rng(std::make_shared<parallel_rng>(rng)) {}
     sample_some() {}
 
     template <class val_type>
     void operator()(std::vector<val_type>& extend, size_t d)
     {
+        auto& rng = _rng->get();
         typedef std::uniform_real_distribution<double> rdist_t;
-        auto random = std::bind(rdist_t(), std::ref(*_rng));
+        auto random = std::bind(rdist_t(), std::ref(rng));
 
         double pd = (*_p)[d+1];
         size_t nc = extend.size();
         double u = nc*pd - floor(nc*pd);
         size_t n;
-        double r;
-        {
-            #pragma omp critical
-            r = random();
-        }
+        double r = random();
         if (r < u)
             n = size_t(ceil(nc*pd));
         else
@@ -179,19 +179,15 @@ struct sample_some
         for (size_t i = 0; i < n; ++i)
         {
             auto random_v = std::bind(idist_t(0, extend.size()-i-1),
-                                      std::ref(*_rng));
-            size_t j;
-            {
-                #pragma omp critical
-                j = i + random_v();
-            }
+                                      std::ref(rng));
+            size_t j = i + random_v();
             swap(extend[i], extend[j]);
         }
         extend.resize(n);
     }
 
     std::vector<double>* _p;
-    rng_t* _rng;
+    std::shared_ptr<parallel_rng> _rng;
 };
 
 
@@ -316,10 +312,10 @@ struct get_all_motifs
         std::unordered_map<std::vector<size_t>,
                            std::vector<pair<size_t, graph_sg_t> >,
                            std::hash<std::vector<size_t>>> sub_list;
-        std::vector<size_t> sig; // current signature
 
         for (size_t i = 0; i < subgraph_list.size(); ++i)
         {
+            std::vector<size_t> sig;
             get_sig(subgraph_list[i], sig);
             sub_list[sig].push_back(make_pair(i,subgraph_list[i]));
         }
@@ -355,86 +351,103 @@ struct get_all_motifs
             V.resize(n);
         }
 
-        int i, N = (p < 1) ? V.size() : num_vertices(g);
-        #pragma omp parallel for default(shared) private(i, sig) \
-            schedule(runtime) if (N > 100)
-        for (i = 0; i < N; ++i)
-        {
-            std::vector<std::vector<typename graph_traits<Graph>::vertex_descriptor> >
-                subgraphs;
-            typename graph_traits<Graph>::vertex_descriptor v =
-                (p < 1) ? V[i] : vertex(i, g);
-            if (v == graph_traits<Graph>::null_vertex())
-                continue;
-
-            typename wrap_undirected::apply<Graph>::type ug(g);
-            get_subgraphs(ug, v, k, subgraphs, sampler);
-
-            #pragma omp critical
-
-            for (size_t j = 0; j < subgraphs.size(); ++j)
-            {
-                graph_sg_t sub;
-                make_subgraph(subgraphs[j], g, sub);
-                get_sig(sub, sig);
-
-                typeof(sub_list.begin()) iter = sub_list.find(sig);
-                if(iter == sub_list.end())
-                {
-                    if (!fill_list)
-                        continue; // avoid inserting an element in sub_list
-                    sub_list[sig].clear();
-                }
-
-                bool found = false;
-                size_t pos;
-                typeof(sub_list.begin()) sl = sub_list.find(sig);
-                if (sl != sub_list.end())
-                {
-                    for (size_t l = 0; l < sl->second.size(); ++l)
-                    {
-                        graph_sg_t& motif = sl->second[l].second;
-                        if (comp_iso)
-                        {
-                            if (isomorphism(motif, sub,
-                                            vertex_index1_map(get(vertex_index, motif)).
-                                            vertex_index2_map(get(vertex_index, sub))))
-                                found = true;
-                        }
-                        else
-                        {
-                            if (graph_cmp(motif, sub))
-                                found = true;
-                        }
-                        if (found)
-                        {
-                            pos = sl->second[l].first;
-                            hist[pos]++;
-                            break;
-                        }
-                    }
-                }
-
-                if (found == false && fill_list)
-                {
-                    subgraph_list.push_back(sub);
-                    sub_list[sig].push_back(make_pair(subgraph_list.size() - 1,
-                                                      sub));
-                    hist.push_back(1);
-                    pos = hist.size() - 1;
-                    found = true;
-                }
-
-                if (found && collect_vmaps)
-                {
-                    if (pos >= vmaps.size())
-                        vmaps.resize(pos + 1);
-                    vmaps[pos].push_back(VMap(get(boost::vertex_index,sub)));
-                    for (size_t vi = 0; vi < num_vertices(sub); ++vi)
-                        vmaps[pos].back()[vertex(vi, sub)] = subgraphs[j][vi];
-                }
-            }
-        }
+        size_t N = (p < 1) ? V.size() : num_vertices(g);
+
+        // the cost of the subgraph enumeration grows with the degree of the
+        // starting vertex
+        std::vector<size_t> blocks;
+        if (get_openmp_degree_balance())
+            get_balanced_partition
+                (N,
+                 [&](size_t i) -> size_t
+                 {
+                     auto v = (p < 1) ? V[i] : vertex(i, g);
+                     if (v == graph_traits<Graph>::null_vertex())
+                         return 0;
+                     return total_degreeS()(v, g) + 1;
+                 }, blocks);
+
+        #pragma omp parallel if (N > 100)
+        parallel_loop_no_spawn
+            (N, blocks,
+             [&](size_t i)
+             {
+                 std::vector<std::vector<typename graph_traits<Graph>::vertex_descriptor> >
+                     subgraphs;
+                 std::vector<size_t> sig; // current signature
+                 typename graph_traits<Graph>::vertex_descriptor v =
+                     (p < 1) ? V[i] : vertex(i, g);
+                 if (v == graph_traits<Graph>::null_vertex())
+                     return;
+
+                 typename wrap_undirected::apply<Graph>::type ug(g);
+                 get_subgraphs(ug, v, k, subgraphs, sampler);
+
+                 #pragma omp critical
+
+                 for (size_t j = 0; j < subgraphs.size(); ++j)
+                 {
+                     graph_sg_t sub;
+                     make_subgraph(subgraphs[j], g, sub);
+                     get_sig(sub, sig);
+
+                     typeof(sub_list.begin()) iter = sub_list.find(sig);
+                     if(iter == sub_list.end())
+                     {
+                         if (!fill_list)
+                             continue; // avoid inserting an element in sub_list
+                         sub_list[sig].clear();
+                     }
+
+                     bool found = false;
+                     size_t pos;
+                     typeof(sub_list.begin()) sl = sub_list.find(sig);
+                     if (sl != sub_list.end())
+                     {
+                         for (size_t l = 0; l < sl->second.size(); ++l)
+                         {
+                             graph_sg_t& motif = sl->second[l].second;
+                             if (comp_iso)
+                             {
+                                 if (isomorphism(motif, sub,
+                                                 vertex_index1_map(get(vertex_index, motif)).
+                                                 vertex_index2_map(get(vertex_index, sub))))
+                                     found = true;
+                             }
+                             else
+                             {
+                                 if (graph_cmp(motif, sub))
+                                     found = true;
+                             }
+                             if (found)
+                             {
+                                 pos = sl->second[l].first;
+                                 hist[pos]++;
+                                 break;
+                             }
+                         }
+                     }
+
+                     if (found == false && fill_list)
+                     {
+                         subgraph_list.push_back(sub);
+                         sub_list[sig].push_back(make_pair(subgraph_list.size() - 1,
+                                                           sub));
+                         hist.push_back(1);
+                         pos = hist.size() - 1;
+                         found = true;
+                     }
+
+                     if (found && collect_vmaps)
+                     {
+                         if (pos >= vmaps.size())
+                             vmaps.resize(pos + 1);
+                         vmaps[pos].push_back(VMap(get(boost::vertex_index,sub)));
+                         for (size_t vi = 0; vi < num_vertices(sub); ++vi)
+                             vmaps[pos].back()[vertex(vi, sub)] = subgraphs[j][vi];
+                     }
+                 }
+             });
     }
 };
 
@@ -62,52 +62,76 @@ vector<double> __safelog_cache;
 vector<double> __xlogx_cache;
 vector<double> __lgamma_cache;
 
+// the tables are only grown by the functions below, which are never called
+// inside a parallel region, and are serialized among themselves
+
 void init_safelog(size_t x)
 {
-    size_t old_size = __safelog_cache.size();
-    if (x >= old_size)
+    #pragma omp critical (log_tables)
     {
-        __safelog_cache.resize(x + 1);
-        for (size_t i = old_size; i < __safelog_cache.size(); ++i)
-            __safelog_cache[i] = safelog(double(i));
+        size_t old_size = __safelog_cache.size();
+        if (x >= old_size)
+        {
+            __safelog_cache.resize(x + 1);
+            for (size_t i = old_size; i < __safelog_cache.size(); ++i)
+                __safelog_cache[i] = safelog(double(i));
+        }
     }
 }
 
 void clear_safelog()
 {
+    #pragma omp critical (log_tables)
     vector<double>().swap(__safelog_cache);
 }
 
 
 void init_xlogx(size_t x)
 {
-    size_t old_size = __xlogx_cache.size();
-    if (x >= old_size)
+    #pragma omp critical (log_tables)
     {
-        __xlogx_cache.resize(x + 1);
-        for (size_t i = old_size; i < __xlogx_cache.size(); ++i)
-            __xlogx_cache[i] = i * safelog(i);
+        size_t old_size = __xlogx_cache.size();
+        if (x >= old_size)
+        {
+            __xlogx_cache.resize(x + 1);
+            for (size_t i = old_size; i < __xlogx_cache.size(); ++i)
+                __xlogx_cache[i] = i * safelog(double(i));
+        }
     }
 }
 
 void clear_xlogx()
 {
+    #pragma omp critical (log_tables)
     vector<double>().swap(__xlogx_cache);
 }
 
 void init_lgamma(size_t x)
 {
-    size_t old_size = __lgamma_cache.size();
-    if (x >= old_size)
+    #pragma omp critical (log_tables)
     {
-        __lgamma_cache.resize(x + 1);
-        for (size_t i = old_size; i < __lgamma_cache.size(); ++i)
-            __lgamma_cache[i] = lgamma(i);
+        size_t old_size = __lgamma_cache.size();
+        if (x >= old_size)
+        {
+            __lgamma_cache.resize(x + 1);
+            for (size_t i = old_size; i < __lgamma_cache.size(); ++i)
+                __lgamma_cache[i] = lgamma(i);
+        }
     }
 }
 
+void init_cache(size_t E, size_t N)
+{
+    // the edge counts between blocks, and the block degrees, are bounded by
+    // 2E, and the block sizes by N
+    init_safelog(2 * E + N + 1);
+    init_xlogx(2 * E + N + 1);
+    init_lgamma(2 * E + N + 2);
+}
+
 void clear_lgamma()
 {
+    #pragma omp critical (log_tables)
     vector<double>().swap(__lgamma_cache);
 }
 
@@ -198,18 +222,20 @@ struct move_sweep_dispatch
                         VEprop esrcpos, VEprop etgtpos, Vprop label,
                         vector<int>& vlist, bool deg_corr, bool dense,
                         bool multigraph, double beta, bool sequential,
-                        bool parallel, bool random_move, double c, bool verbose,
-                        size_t max_edge_index, size_t nmerges, size_t ntries,
-                        Vprop merge_map, partition_stats_t& partition_stats,
+                        bool parallel, bool concurrent, bool random_move,
+                        double c, bool verbose, size_t max_edge_index, size_t nmerges, size_t ntries,
+                        size_t B_target, bool unweighted, Vprop merge_map, partition_stats_t& partition_stats,
                         rng_t& rng, double& S, size_t& nmoves,
                         GraphInterface& bgi)
 
         : eweight(eweight), vweight(vweight), oegroups(egroups), esrcpos(esrcpos),
           etgtpos(etgtpos), label(label), vlist(vlist),
           deg_corr(deg_corr), dense(dense), multigraph(multigraph), beta(beta),
-          sequential(sequential), parallel(parallel), random_move(random_move),
+          sequential(sequential), parallel(parallel), concurrent(concurrent),
+          random_move(random_move),
           c(c), verbose(verbose), max_edge_index(max_edge_index),
-          nmerges(nmerges), ntries(ntries), merge_map(merge_map),
+          nmerges(nmerges), ntries(ntries), B_target(B_target),
+          unweighted(unweighted), merge_map(merge_map),
           partition_stats(partition_stats), rng(rng), S(S),
           nmoves(nmoves), bgi(bgi)
     {}
@@ -228,12 +254,15 @@ struct move_sweep_dispatch
     double beta;
     bool sequential;
     bool parallel;
+    bool concurrent;
     bool random_move;
     double c;
     bool verbose;
     size_t max_edge_index;
     size_t nmerges;
     size_t ntries;
+    size_t B_target;
+    bool unweighted;
     Vprop merge_map;
     partition_stats_t& partition_stats;
     rng_t& rng;
@@ -246,6 +275,11 @@ struct move_sweep_dispatch
                     Graph& g, boost::any& emat, boost::any sampler,
                     boost::any cavity_sampler, bool weighted) const
     {
+        // the edge lists of the block graph are modified concurrently by the
+        // sweep, and must not be repacked while they are being read
+        if (concurrent)
+            bgi.GetGraph().thaw();
+
         if (is_directed::apply<Graph>::type::value)
         {
             dispatch(mrs, mrp, mrm, wr, b, g, emat, sampler, cavity_sampler,
@@ -291,8 +325,6 @@ struct move_sweep_dispatch
         size_t max_BE = is_directed::apply<Graph>::type::value ?
             B * B : (B * (B + 1)) / 2;
 
-        size_t eidx = random_move ? 1 : max_edge_index;
-
         typedef typename property_map<Graph, vertex_index_t>::type vindex_map_t;
         typedef typename property_map_type::apply<Sampler<vertex_t, boost::mpl::false_>,
                                                   vindex_map_t>::type::unchecked_t
@@ -308,29 +340,49 @@ struct move_sweep_dispatch
             // make sure the properties are _unchecked_, since otherwise it
             // affects performance
 
-            move_sweep(mrs.get_unchecked(max_BE),
-                       mrp.get_unchecked(num_vertices(bg)),
-                       mrm.get_unchecked(num_vertices(bg)),
-                       wr.get_unchecked(num_vertices(bg)),
-                       b.get_unchecked(num_vertices(g)),
-                       label.get_unchecked(num_vertices(bg)), vlist, deg_corr,
-                       dense, multigraph, beta,
-                       eweight.get_unchecked(max_edge_index),
-                       vweight.get_unchecked(num_vertices(g)),
-                       egroups.get_unchecked(num_vertices(bg)),
-                       esrcpos.get_unchecked(eidx),
-                       etgtpos.get_unchecked(eidx), g, bg, emat, sampler,
-                       cavity_sampler, sequential, parallel, random_move, c,
-                       nmerges, ntries,
-                       merge_map.get_unchecked(num_vertices(g)),
-                       partition_stats, verbose, rng, S, nmoves,
-                       overlap_stats_t());
+            sweep(mrs.get_unchecked(max_BE), mrp, mrm, wr, b, g, bg, emat,
+                  sampler, cavity_sampler, egroups);
         }
         catch (bad_any_cast&)
         {
             typedef typename get_ehash_t::apply<BGraph>::type emat_t;
             emat_t& emat = any_cast<emat_t&>(aemat);
-            move_sweep(mrs.get_unchecked(num_edges(g)),
+            sweep(mrs.get_unchecked(num_edges(g)), mrp, mrm, wr, b, g, bg,
+                  emat, sampler, cavity_sampler, egroups);
+        }
+    }
+
+    template <class Graph, class BGraph, class EMprop, class EMat,
+              class SamplerMap, class Egroups>
+    void sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b, Graph& g,
+               BGraph& bg, EMat& emat, SamplerMap sampler,
+               SamplerMap cavity_sampler, Egroups egroups) const
+    {
+        size_t eidx = random_move ? 1 : max_edge_index;
+
+        if (B_target > 0)
+        {
+            merge_sweep(mrs,
+                        mrp.get_unchecked(num_vertices(bg)),
+                        mrm.get_unchecked(num_vertices(bg)),
+                        wr.get_unchecked(num_vertices(bg)),
+                        b.get_unchecked(num_vertices(g)),
+                        label.get_unchecked(num_vertices(bg)), vlist, deg_corr,
+                        dense, multigraph,
+                        eweight.get_unchecked(max_edge_index),
+                        vweight.get_unchecked(num_vertices(g)),
+                        egroups.get_unchecked(num_vertices(bg)),
+                        esrcpos.get_unchecked(eidx),
+                        etgtpos.get_unchecked(eidx), g, bg, emat, sampler,
+                        cavity_sampler, sequential, parallel, random_move,
+                        unweighted, B_target, ntries,
+                        merge_map.get_unchecked(num_vertices(g)),
+                        partition_stats, verbose, rng, S, nmoves,
+                        overlap_stats_t());
+        }
+        else
+        {
+            move_sweep(mrs,
                        mrp.get_unchecked(num_vertices(bg)),
                        mrm.get_unchecked(num_vertices(bg)),
                        wr.get_unchecked(num_vertices(bg)),
@@ -342,7 +394,8 @@ struct move_sweep_dispatch
                        egroups.get_unchecked(num_vertices(bg)),
                        esrcpos.get_unchecked(eidx),
                        etgtpos.get_unchecked(eidx), g, bg, emat, sampler,
-                       cavity_sampler, sequential, parallel, random_move, c,
+                       cavity_sampler, sequential, parallel, concurrent,
+                       random_move, c,
                        nmerges, ntries,
                        merge_map.get_unchecked(num_vertices(g)),
                        partition_stats, verbose, rng, S, nmoves,
@@ -363,7 +416,7 @@ boost::python::object do_move_sweep(GraphInterface& gi, GraphInterface& bgi,
                                     boost::any oegroups, boost::any oesrcpos,
                                     boost::any oetgtpos, double beta,
                                     bool sequential, bool parallel,
-                                    bool random_move, double c, bool weighted,
+                                    bool concurrent, bool random_move, double c, bool weighted,
                                     size_t nmerges, size_t ntries,
                                     boost::any omerge_map,
                                     partition_stats_t& partition_stats,
@@ -395,12 +448,16 @@ boost::python::object do_move_sweep(GraphInterface& gi, GraphInterface& bgi,
 
     vmap_t merge_map = any_cast<vmap_t>(omerge_map);
 
+    init_cache(gi.GetNumberOfEdges(), gi.GetNumberOfVertices());
+
     run_action<graph_tool::detail::all_graph_views, boost::mpl::true_>()
         (gi, std::bind(move_sweep_dispatch<emap_t, vmap_t, vemap_t>
                        (eweight, vweight, oegroups, esrcpos, etgtpos,
                         label, vlist, deg_corr, dense, multigraph, beta,
-                        sequential, parallel, random_move, c, verbose,
-                        gi.GetMaxEdgeIndex(), nmerges, ntries, merge_map,
+                        sequential, parallel, concurrent, random_move, c,
+                        verbose,
+                        gi.GetMaxEdgeIndex(), nmerges, ntries, 0, false,
+                        merge_map,
                         partition_stats, rng, S, nmoves, bgi),
                        mrs, mrp, mrm, wr, b, placeholders::_1,
                        std::ref(emat), sampler, cavity_sampler, weighted))();
@@ -465,6 +522,72 @@ boost::any do_init_neighbour_sampler(GraphInterface& gi, boost::any oeweights,
     return osampler;
 }
 
+boost::python::object do_merge_sweep(GraphInterface& gi, GraphInterface& bgi,
+                                     boost::any& emat, boost::any omrs,
+                                     boost::any omrp, boost::any omrm,
+                                     boost::any owr, boost::any ob,
+                                     boost::any olabel, vector<int>& vlist,
+                                     bool deg_corr, bool dense, bool multigraph,
+                                     boost::any oeweight, boost::any ovweight,
+                                     boost::any oegroups, boost::any oesrcpos,
+                                     boost::any oetgtpos, bool sequential,
+                                     bool parallel, bool random_move,
+                                     bool weighted, bool unweighted,
+                                     size_t B, size_t ntries,
+                                     boost::any omerge_map,
+                                     partition_stats_t& partition_stats,
+                                     bool verbose, rng_t& rng)
+{
+    typedef property_map_type::apply<int32_t,
+                                     GraphInterface::vertex_index_map_t>::type
+        vmap_t;
+    typedef property_map_type::apply<int32_t,
+                                     GraphInterface::edge_index_map_t>::type
+        emap_t;
+    typedef property_map_type::apply<int32_t,
+                                     GraphInterface::edge_index_map_t>::type
+        vemap_t;
+    emap_t mrs = any_cast<emap_t>(omrs);
+    vmap_t mrp = any_cast<vmap_t>(omrp);
+    vmap_t mrm = any_cast<vmap_t>(omrm);
+    vmap_t wr = any_cast<vmap_t>(owr);
+    vmap_t b = any_cast<vmap_t>(ob);
+    vmap_t label = any_cast<vmap_t>(olabel);
+    emap_t eweight = any_cast<emap_t>(oeweight);
+    vmap_t vweight = any_cast<vmap_t>(ovweight);
+
+    vemap_t esrcpos = any_cast<vemap_t>(oesrcpos);
+    vemap_t etgtpos = any_cast<vemap_t>(oetgtpos);
+
+    double S = 0;
+    size_t nmoves = 0;
+
+    vmap_t merge_map = any_cast<vmap_t>(omerge_map);
+
+    if (B == 0)
+        throw ValueException("cannot merge into zero blocks");
+
+    init_cache(gi.GetNumberOfEdges(), gi.GetNumberOfVertices());
+
+    // the samplers are only allocated here, and are rebuilt from the block
+    // graph before each merge sweep
+    boost::any sampler = do_init_neighbour_sampler(bgi, omrs, true, true);
+    boost::any cavity_sampler = do_init_neighbour_sampler(bgi, omrs, false,
+                                                          true);
+
+    run_action<graph_tool::detail::all_graph_views, boost::mpl::true_>()
+        (gi, std::bind(move_sweep_dispatch<emap_t, vmap_t, vemap_t>
+                       (eweight, vweight, oegroups, esrcpos, etgtpos,
+                        label, vlist, deg_corr, dense, multigraph,
+                        numeric_limits<double>::infinity(), sequential,
+                        parallel, false, random_move, 0., verbose,
+                        gi.GetMaxEdgeIndex(), 0, ntries, B, unweighted,
+                        merge_map, partition_stats, rng, S, nmoves, bgi),
+                       mrs, mrp, mrm, wr, b, placeholders::_1,
+                       std::ref(emat), sampler, cavity_sampler, weighted))();
+    return boost::python::make_tuple(S, nmoves);
+}
+
 struct collect_edge_marginals_dispatch
 {
     template <class Graph, class Vprop, class MEprop>
@@ -727,6 +850,7 @@ void export_blockmodel()
     def("clear_xlogx", clear_xlogx);
     def("init_lgamma", init_lgamma);
     def("clear_lgamma", clear_lgamma);
+    def("init_cache", init_cache);
     def("get_xi", get_xi<double,double>);
     def("get_xi_fast", get_xi_fast<double,double>);
     def("get_mu_l", python_get_mu_l);
@@ -747,6 +871,7 @@ void export_blockmodel()
     def("init_neighbour_sampler", do_init_neighbour_sampler);
 
     def("move_sweep", do_move_sweep);
+    def("merge_sweep", do_merge_sweep);
 
     def("entropy", do_get_ent);
     def("entropy_dense", do_get_ent_dense);
@@ -58,16 +58,28 @@ using namespace boost;
 // Entropy calculation
 // ====================
 
-// Repeated computation of x*log(x) and log(x) actually adds up to a lot of
-// time. A significant speedup can be made by caching pre-computed values. This
-// is doable since the values of mrse are bounded in [0, 2E], where E is the
-// total number of edges in the network. Here we simply grow the cache as
-// needed.
+// Repeated computation of x*log(x), log(x) and lgamma(x) actually adds up to a
+// lot of time. A significant speedup can be made by caching pre-computed
+// values. This is doable since the values of mrse are bounded in [0, 2E], where
+// E is the total number of edges in the network.
+//
+// The tables are shared by all threads. They only grow in init_cache() (or
+// the individual init_*() functions), which is called before each sweep, and
+// never inside a parallel region, so that the lookups only read them. Values
+// beyond the tables are computed directly.
 
 extern vector<double> __safelog_cache;
 extern vector<double> __xlogx_cache;
 extern vector<double> __lgamma_cache;
 
+void init_safelog(size_t x);
+void init_xlogx(size_t x);
+void init_lgamma(size_t x);
+
+// makes sure the tables cover the arguments which appear in a network with E
+// edges and N vertices
+void init_cache(size_t E, size_t N);
+
 template <class Type>
 __attribute__((always_inline))
 inline double safelog(Type x)
@@ -80,7 +92,8 @@ inline double safelog(Type x)
 __attribute__((always_inline))
 inline double safelog(size_t x)
 {
-    assert(x < __safelog_cache.size());
+    if (x >= __safelog_cache.size())
+        return safelog(double(x));
     return __safelog_cache[x];
 }
 
@@ -88,8 +101,7 @@ __attribute__((always_inline))
 inline double xlogx(size_t x)
 {
     if (x >= __xlogx_cache.size())
-        cout << x << " " << __xlogx_cache.size();
-    assert(x < __xlogx_cache.size());
+        return x * safelog(double(x));
     return __xlogx_cache[x];
 }
 
@@ -358,12 +370,10 @@ inline double eterm_dense(size_t r, size_t s, int ers, double wr_r,
             nrns = (wr_r * (wr_r - 1)) / 2;
     }
 
-    double S;
-    if (multigraph)
-        S = lbinom(nrns + ers - 1, ers);
-    else
-        S = lbinom(nrns, ers);
-    return S;
+    double N = multigraph ? nrns + ers - 1 : nrns;
+    if (N + 1 < __lgamma_cache.size())
+        return lbinom_fast(int(N), ers);
+    return lbinom(N, ers);
 }
 
 struct entropy_dense
@@ -425,10 +435,10 @@ public:
     double get_partition_dl()
     {
         double S = 0;
-        S += lbinom(_B + _N - 1, _N);
-        S += lgamma(_N + 1);
+        S += lbinom_fast(_B + _N - 1, _N);
+        S += lgamma_fast(_N + 1);
         for (auto nr : _total)
-            S -= lgamma(nr + 1);
+            S -= lgamma_fast(nr + 1);
         return S;
     }
 
@@ -460,15 +470,15 @@ public:
                     S1 += get_xi(_total[r], _em[r]);
                 }
 
-                S1 += lgamma(_total[r] + 1);
+                S1 += lgamma_fast(_total[r] + 1);
                 for (auto& k_c : _hist[r])
-                    S1 -= lgamma(k_c.second + 1);
+                    S1 -= lgamma_fast(k_c.second + 1);
 
                 if (dl_alt)
                 {
                     double S2 = 0;
-                    S2 += lbinom(_total[r] + _ep[r] - 1, _ep[r]);
-                    S2 += lbinom(_total[r] + _em[r] - 1, _em[r]);
+                    S2 += lbinom_fast(_total[r] + _ep[r] - 1, _ep[r]);
+                    S2 += lbinom_fast(_total[r] + _em[r] - 1, _em[r]);
                     S += min(S1, S2);
                 }
                 else
@@ -654,26 +664,193 @@ remove_me(typename graph_traits<Graph>::vertex_descriptor r,
     }
 }
 
+// makes room for n more block pairs
+template <class Graph>
+inline void reserve_me(size_t, typename get_emat_t::apply<Graph>::type&,
+                       const Graph&)
+{
+}
+
+
+// Open-addressing hash table mapping block pairs (r, s) to the edges between
+// them, with linear probing over a single flat array. It uses memory
+// proportional to the number of nonzero block pairs, and each lookup usually
+// touches a single cache line, unlike a vector of per-block hash maps. Erased
+// entries are marked as deleted, and purged when the table is rehashed.
+template <class Edge>
+class block_edge_hash
+{
+public:
+    block_edge_hash(size_t n = 0) : _size(0), _used(0)
+    {
+        size_t cap = 8;
+        while (cap * 3 < n * 4)
+            cap *= 2;
+        _table.resize(cap);
+        _mask = cap - 1;
+    }
+
+    pair<Edge, bool> find(size_t r, size_t s) const
+    {
+        uint64_t k = key(r, s);
+        for (size_t i = hash(k) & _mask; ; i = (i + 1) & _mask)
+        {
+            const entry& x = _table[i];
+            if (x.key == k)
+                return make_pair(x.e, true);
+            if (x.key == _empty)
+                return make_pair(Edge(), false);
+        }
+    }
+
+    void insert(size_t r, size_t s, const Edge& e)
+    {
+        uint64_t k = key(r, s);
+        size_t i = hash(k) & _mask;
+        size_t pos = _table.size();
+        for (; ; i = (i + 1) & _mask)
+        {
+            entry& x = _table[i];
+            if (x.key == k)
+            {
+                x.e = e;
+                return;
+            }
+            if (x.key == _deleted && pos == _table.size())
+                pos = i;
+            if (x.key == _empty)
+                break;
+        }
+        if (pos == _table.size())
+        {
+            if ((_used + 1) * 4 > _table.size() * 3)
+            {
+                rehash();
+                insert(r, s, e);
+                return;
+            }
+            pos = i;
+            ++_used;
+        }
+        _table[pos].key = k;
+        _table[pos].e = e;
+        ++_size;
+    }
+
+    void erase(size_t r, size_t s)
+    {
+        uint64_t k = key(r, s);
+        for (size_t i = hash(k) & _mask; ; i = (i + 1) & _mask)
+        {
+            entry& x = _table[i];
+            if (x.key == k)
+            {
+                x.key = _deleted;
+                --_size;
+                return;
+            }
+            if (x.key == _empty)
+                return;
+        }
+    }
+
+    size_t size() const { return _size; }
+
+    // makes room for n more insertions without rehashing, so that the table
+    // can be read concurrently with them
+    void reserve(size_t n)
+    {
+        size_t cap = _table.size();
+        while ((_used + n) * 4 > cap * 3)
+            cap *= 2;
+        if (cap == _table.size())
+            return;
+        vector<entry> old;
+        old.swap(_table);
+        _table.resize(cap);
+        _mask = cap - 1;
+        _size = _used = 0;
+        for (auto& x : old)
+        {
+            if (x.key == _empty || x.key == _deleted)
+                continue;
+            insert(x.key >> 32, x.key & 0xffffffff, x.e);
+        }
+    }
+
+private:
+    static const uint64_t _empty = numeric_limits<uint64_t>::max();
+    static const uint64_t _deleted = numeric_limits<uint64_t>::max() - 1;
+
+    struct entry
+    {
+        entry() : key(_empty) {}
+        uint64_t key;
+        Edge e;
+    };
+
+    static uint64_t key(size_t r, size_t s)
+    {
+        return (uint64_t(r) << 32) | uint64_t(s);
+    }
+
+    static size_t hash(uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    // grows the table if it is more than half full with live entries,
+    // otherwise only the deleted entries are purged
+    void rehash()
+    {
+        vector<entry> old;
+        old.swap(_table);
+        size_t cap = old.size();
+        if (_size * 2 >= cap)
+            cap *= 2;
+        _table.resize(cap);
+        _mask = cap - 1;
+        _size = _used = 0;
+        for (auto& x : old)
+        {
+            if (x.key == _empty || x.key == _deleted)
+                continue;
+            insert(x.key >> 32, x.key & 0xffffffff, x.e);
+        }
+    }
+
+    vector<entry> _table;
+    size_t _mask;
+    size_t _size;
+    size_t _used;
+};
 
 // this structure speeds up the access to the edges between given blocks, since
 // we're using an adjacency list to store the block structure (this is like
-// emat_t above, but takes less space and is slower)
+// emat_t above, but takes space proportional only to the number of edges, and
+// is slower). Undirected block pairs are stored only once, as (min, max).
 struct get_ehash_t
 {
     template <class Graph>
     struct apply
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
         typedef typename graph_traits<Graph>::edge_descriptor edge_t;
-#ifdef HAVE_SPARSEHASH
-        typedef dense_hash_map<vertex_t, edge_t> map_t;
-#else
-        typedef unordered_map<vertex_t, edge_t> map_t;
-#endif
-        typedef vector<map_t> type;
+        typedef block_edge_hash<edge_t> type;
     };
 };
 
+template <class Graph>
+inline __attribute__((always_inline))
+void ehash_key(typename graph_traits<Graph>::vertex_descriptor& r,
+               typename graph_traits<Graph>::vertex_descriptor& s,
+               const Graph&)
+{
+    if (!is_directed::apply<Graph>::type::value && r > s)
+        std::swap(r, s);
+}
 
 template<class Graph>
 inline __attribute__((always_inline))
@@ -682,11 +859,8 @@ get_me(typename graph_traits<Graph>::vertex_descriptor r,
        typename graph_traits<Graph>::vertex_descriptor s,
        const typename get_ehash_t::apply<Graph>::type& ehash, const Graph& bg)
 {
-    const auto& map = ehash[r];
-    auto iter = map.find(s);
-    if (iter == map.end())
-        return (make_pair(typename graph_traits<Graph>::edge_descriptor(), false));
-    return make_pair(iter->second, true);
+    ehash_key(r, s, bg);
+    return ehash.find(r, s);
 }
 
 template<class Graph>
@@ -698,9 +872,8 @@ put_me(typename graph_traits<Graph>::vertex_descriptor r,
        typename get_ehash_t::apply<Graph>::type& ehash,
        const Graph& bg)
 {
-    ehash[r][s] = e;
-    if (!is_directed::apply<Graph>::type::value)
-        ehash[s][r] = e;
+    ehash_key(r, s, bg);
+    ehash.insert(r, s, e);
 }
 
 template<class Graph>
@@ -712,32 +885,27 @@ remove_me(typename graph_traits<Graph>::vertex_descriptor r,
           typename get_ehash_t::apply<Graph>::type& ehash, Graph& bg,
           bool delete_edge=true)
 {
-    ehash[r].erase(s);
-    if (!is_directed::apply<Graph>::type::value)
-        ehash[s].erase(r);
+    ehash_key(r, s, bg);
+    ehash.erase(r, s);
     if (delete_edge)
         remove_edge(e, bg);
 }
 
+template<class Graph>
+inline void reserve_me(size_t n, typename get_ehash_t::apply<Graph>::type& ehash,
+                       const Graph&)
+{
+    ehash.reserve(n);
+}
+
 struct create_ehash
 {
     template <class Graph>
     void operator()(Graph& g, boost::any& oemap) const
     {
         typedef typename get_ehash_t::apply<Graph>::type emat_t;
-        typedef typename get_ehash_t::apply<Graph>::map_t map_t;
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-        emat_t emat(num_vertices(g));
-
-#ifdef HAVE_SPARSEHASH
-        for (auto v : vertices_range(g))
-        {
-            emat[v].set_empty_key(numeric_limits<vertex_t>::max());
-            emat[v].set_deleted_key(num_vertices(g));
-        }
-#endif
 
+        emat_t emat(num_edges(g));
         for (auto e : edges_range(g))
             put_me(source(e, g), target(e, g), e, emat, g);
 
@@ -787,7 +955,8 @@ struct standard_neighbours_policy
     }
 };
 
-// remove a vertex from its current block
+// remove a vertex from its current block (the structure of the block graph is
+// modified in a critical section, since it is shared by concurrent sweeps)
 template <class Graph, class BGraph, class Eprop, class Vprop, class EWprop,
           class VWprop, class EMat, class OStats,
           class NPolicy = standard_neighbours_policy>
@@ -827,7 +996,10 @@ void remove_vertex(size_t v, Eprop& mrs, Vprop& mrp, Vprop& mrm, Vprop& wr,
         mrm[s] -= ew;
 
         if (mrs[me] == 0)
+        {
+            #pragma omp critical (block_graph)
             remove_me(r, s, me, emat, bg);
+        }
     }
 
     for (auto e : npolicy.get_in_edges(v, g))
@@ -851,7 +1023,10 @@ void remove_vertex(size_t v, Eprop& mrs, Vprop& mrp, Vprop& mrm, Vprop& wr,
         mrm[r] -= ew;
 
         if (mrs[me] == 0)
+        {
+            #pragma omp critical (block_graph)
             remove_me(s, r, me, emat, bg);
+        }
     }
 
     if (!overlap_stats.is_enabled())
@@ -900,8 +1075,11 @@ void add_vertex(size_t v, size_t r, Eprop& mrs, Vprop& mrp, Vprop& mrm,
 
         if (!mep.second)
         {
-            mep = add_edge(r, s, bg);
-            put_me(r, s, mep.first, emat, bg);
+            #pragma omp critical (block_graph)
+            {
+                mep = add_edge(r, s, bg);
+                put_me(r, s, mep.first, emat, bg);
+            }
             mrs[mep.first] = 0;
         }
         me = mep.first;
@@ -929,8 +1107,11 @@ void add_vertex(size_t v, size_t r, Eprop& mrs, Vprop& mrp, Vprop& mrm,
 
         if (!mep.second)
         {
-            mep = add_edge(s, r, bg);
-            put_me(s, r, mep.first, emat, bg);
+            #pragma omp critical (block_graph)
+            {
+                mep = add_edge(s, r, bg);
+                put_me(s, r, mep.first, emat, bg);
+            }
             mrs[mep.first] = 0;
         }
         me = mep.first;
@@ -994,22 +1175,18 @@ inline pair<Type1,Type2> make_ordered_pair(const Type1& v1, const Type2& v2, con
     return make_pair(v1, v2);
 }
 
+// The set of entries of the e_rs matrix which are modified by a move from r to
+// nr, together with their changes. The entries are indexed by a small
+// open-addressing table, which grows with the neighbourhood of the moved
+// vertex, instead of the number of blocks, and which is cleared only at the
+// positions which were used, so that the set is cheap to copy and to reuse.
 template <class Graph>
 class EntrySet
 {
 public:
-    EntrySet(size_t B)
-    {
-        _null = numeric_limits<size_t>::max();
-        _r_field_t.resize(B, _null);
-        _nr_field_t.resize(B, _null);
-
-        if (is_directed::apply<Graph>::type::value)
-        {
-            _r_field_s.resize(B, _null);
-            _nr_field_s.resize(B, _null);
-        }
-    }
+    EntrySet(size_t = 0)
+        : _index(16, make_pair(size_t(_null), size_t(0))), _mask(15),
+          _self_weight(0) {}
 
     void SetMove(size_t r, size_t nr)
     {
@@ -1032,17 +1209,8 @@ public:
             return;
         }
 
-        vector<size_t>& field = (_rnr.first == r) ? _r_field_t : _nr_field_t;
-        if (field[s] == _null)
-        {
-            field[s] = _entries.size();
-            _entries.push_back(make_pair(r, s));
-            _delta.push_back(delta);
-        }
-        else
-        {
-            _delta[field[s]] += delta;
-        }
+        size_t field = (_rnr.first == r) ? R_TARGET : NR_TARGET;
+        insert(key(field, s), make_pair(r, s), delta);
     }
 
     void InsertDeltaSource(size_t s, size_t r, int delta)
@@ -1059,17 +1227,8 @@ public:
             return;
         }
 
-        vector<size_t>& field = (_rnr.first == r) ? _r_field_s : _nr_field_s;
-        if (field[s] == _null)
-        {
-            field[s] = _entries.size();
-            _entries.push_back(make_pair(s, r));
-            _delta.push_back(delta);
-        }
-        else
-        {
-            _delta[field[s]] += delta;
-        }
+        size_t field = (_rnr.first == r) ? R_SOURCE : NR_SOURCE;
+        insert(key(field, s), make_pair(s, r), delta);
     }
 
     int GetDelta(size_t t, size_t s)
@@ -1093,44 +1252,21 @@ public:
 
     int GetDeltaTarget(size_t r, size_t s)
     {
-        vector<size_t>& field = (_rnr.first == r) ? _r_field_t : _nr_field_t;
-        if (field[s] == _null)
-        {
-            return 0;
-        }
-        else
-        {
-            return _delta[field[s]];
-        }
+        size_t field = (_rnr.first == r) ? R_TARGET : NR_TARGET;
+        return find(key(field, s));
     }
 
     int GetDeltaSource(size_t s, size_t r)
     {
-        vector<size_t>& field = (_rnr.first == r) ? _r_field_s : _nr_field_s;
-        if (field[s] == _null)
-        {
-            return 0;
-        }
-        else
-        {
-            return _delta[field[s]];
-        }
+        size_t field = (_rnr.first == r) ? R_SOURCE : NR_SOURCE;
+        return find(key(field, s));
     }
 
     void Clear()
     {
-        size_t r, s;
-        for (size_t i = 0; i < _entries.size(); ++i)
-        {
-            tie(r, s) = _entries[i];
-            _r_field_t[r] = _nr_field_t[r] = _null;
-            _r_field_t[s] = _nr_field_t[s] = _null;
-            if (is_directed::apply<Graph>::type::value)
-            {
-                _r_field_s[r] = _nr_field_s[r] = _null;
-                _r_field_s[s] = _nr_field_s[s] = _null;
-            }
-        }
+        for (auto i : _slots)
+            _index[i].first = _null;
+        _slots.clear();
         _entries.clear();
         _delta.clear();
     }
@@ -1138,15 +1274,93 @@ public:
     vector<pair<size_t, size_t> >& GetEntries() { return _entries; }
     vector<int>& GetDelta() { return _delta; }
 
+    // The blocks of the neighbours of a vertex, with the total weights of the
+    // edges to (out) and from (in) them, and of its self-loops. These do not
+    // depend on the target block, and are shared by the evaluation of
+    // several moves of the same vertex.
+    vector<pair<size_t, int> >& GetOutBlocks() { return _out_blocks; }
+    vector<pair<size_t, int> >& GetInBlocks() { return _in_blocks; }
+    int& GetSelfWeight() { return _self_weight; }
+
 private:
+    enum { R_TARGET, NR_TARGET, R_SOURCE, NR_SOURCE };
+
+    static const size_t _null = numeric_limits<size_t>::max();
+
+    static size_t key(size_t field, size_t s)
+    {
+        return (s << 2) | field;
+    }
+
+    static size_t hash(size_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    size_t slot(size_t k) const
+    {
+        size_t i = hash(k) & _mask;
+        while (_index[i].first != _null && _index[i].first != k)
+            i = (i + 1) & _mask;
+        return i;
+    }
+
+    int find(size_t k) const
+    {
+        const auto& x = _index[slot(k)];
+        if (x.first == _null)
+            return 0;
+        return _delta[x.second];
+    }
+
+    void insert(size_t k, const pair<size_t, size_t>& rs, int delta)
+    {
+        size_t i = slot(k);
+        if (_index[i].first != _null)
+        {
+            _delta[_index[i].second] += delta;
+            return;
+        }
+
+        if ((_slots.size() + 1) * 2 > _index.size())
+        {
+            grow();
+            i = slot(k);
+        }
+
+        _index[i] = make_pair(k, _entries.size());
+        _slots.push_back(i);
+        _entries.push_back(rs);
+        _delta.push_back(delta);
+    }
+
+    void grow()
+    {
+        vector<pair<size_t, size_t> > old(_index.size() * 2,
+                                          make_pair(size_t(_null), size_t(0)));
+        old.swap(_index);
+        _mask = _index.size() - 1;
+        for (auto& i : _slots)
+        {
+            auto& x = old[i];
+            i = slot(x.first);
+            _index[i] = x;
+        }
+    }
+
     pair<size_t, size_t> _rnr;
-    size_t _null;
-    vector<size_t> _r_field_t;
-    vector<size_t> _nr_field_t;
-    vector<size_t> _r_field_s;
-    vector<size_t> _nr_field_s;
+    vector<pair<size_t, size_t> > _index;
+    size_t _mask;
+    vector<size_t> _slots;
     vector<pair<size_t, size_t> > _entries;
     vector<int> _delta;
+
+    vector<pair<size_t, int> > _out_blocks;
+    vector<pair<size_t, int> > _in_blocks;
+    int _self_weight;
 };
 
 // obtain the necessary entries in the e_rs matrix which need to be modified
@@ -1197,6 +1411,93 @@ void move_entries(Vertex v, Vertex nr, Vprop& b, Eprop& eweights, Graph& g,
     }
 }
 
+// obtain the blocks of the neighbours of v, and the total weights of the edges
+// to and from them, which are shared by all the moves of v
+template <class Graph, class Vertex, class Vprop, class Eprop,
+          class NPolicy = standard_neighbours_policy>
+void neighbour_blocks(Vertex v, Vprop& b, Eprop& eweights, Graph& g,
+                      EntrySet<Graph>& m_entries,
+                      const NPolicy& npolicy = NPolicy())
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    auto& out_blocks = m_entries.GetOutBlocks();
+    auto& in_blocks = m_entries.GetInBlocks();
+    int& self_weight = m_entries.GetSelfWeight();
+    out_blocks.clear();
+    in_blocks.clear();
+    self_weight = 0;
+
+    int self_count = 0;
+    for (auto e : npolicy.get_out_edges(v, g))
+    {
+        vertex_t u = target(e, g);
+        if (u == v && !is_directed::apply<Graph>::type::value)
+        {
+            ++self_count;
+            if (self_count % 2 == 0)
+                continue;
+        }
+        if (u == v)
+            self_weight += eweights[e];
+        else
+            out_blocks.push_back(make_pair(size_t(b[u]), int(eweights[e])));
+    }
+
+    for (auto e : npolicy.get_in_edges(v, g))
+    {
+        vertex_t u = source(e, g);
+        if (u == v)
+            continue;
+        in_blocks.push_back(make_pair(size_t(b[u]), int(eweights[e])));
+    }
+
+    auto merge = [](vector<pair<size_t, int> >& blocks)
+        {
+            if (blocks.empty())
+                return;
+            std::sort(blocks.begin(), blocks.end());
+            size_t j = 0;
+            for (size_t i = 1; i < blocks.size(); ++i)
+            {
+                if (blocks[i].first == blocks[j].first)
+                    blocks[j].second += blocks[i].second;
+                else
+                    blocks[++j] = blocks[i];
+            }
+            blocks.resize(j + 1);
+        };
+    merge(out_blocks);
+    merge(in_blocks);
+}
+
+// obtain the modified entries of a move from r to nr, from the neighbourhood
+// previously given by neighbour_blocks()
+template <class Graph>
+void move_entries(size_t r, size_t nr, EntrySet<Graph>& m_entries)
+{
+    m_entries.SetMove(r, nr);
+
+    for (auto& sw : m_entries.GetOutBlocks())
+    {
+        m_entries.InsertDeltaTarget(r, sw.first, -sw.second);
+        m_entries.InsertDeltaTarget(nr, sw.first, +sw.second);
+    }
+
+    int self_weight = m_entries.GetSelfWeight();
+    if (self_weight != 0)
+    {
+        m_entries.InsertDeltaTarget(r, r, -self_weight);
+        m_entries.InsertDeltaTarget(nr, nr, +self_weight);
+    }
+
+    for (auto& sw : m_entries.GetInBlocks())
+    {
+        m_entries.InsertDeltaSource(sw.first,  r, -sw.second);
+        m_entries.InsertDeltaSource(sw.first, nr, +sw.second);
+    }
+}
+
 // obtain the entropy difference given a set of entries in the e_rs matrix
 template <class Graph, class Eprop, class BGraph, class EMat>
 double entries_dS(EntrySet<Graph>& m_entries, Eprop& mrs, BGraph& bg, EMat& emat)
@@ -1219,28 +1520,17 @@ double entries_dS(EntrySet<Graph>& m_entries, Eprop& mrs, BGraph& bg, EMat& emat
     return dS;
 }
 
-// compute the entropy difference of a virtual move of vertex r to block nr
-template <class Graph, class BGraph, class Eprop, class Vprop, class EWprop,
-          class VWprop, class EMat, class OStats,
-          class NPolicy = standard_neighbours_policy>
-double virtual_move_sparse(size_t v, size_t nr, Eprop& mrs, Vprop& mrp,
+// compute the entropy difference of the terms of the blocks r and nr which
+// depend only on their sizes and degrees, for a virtual move of v
+template <class Graph, class BGraph, class Vprop, class EWprop, class VWprop,
+          class OStats, class NPolicy>
+double virtual_move_vterms(size_t v, size_t r, size_t nr, Vprop& mrp,
                            Vprop& mrm, Vprop& wr, Vprop& b, bool deg_corr,
                            const EWprop& eweight, const VWprop& vweight,
-                           Graph& g, BGraph& bg, EMat& emat,
-                           EntrySet<Graph>& m_entries, OStats& overlap_stats,
-                           bool parallel_edges,
-                           const NPolicy& npolicy = NPolicy())
-
+                           Graph& g, BGraph& bg, OStats& overlap_stats,
+                           bool parallel_edges, const NPolicy& npolicy)
 {
-    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-    vertex_t r = b[v];
-
-    if (r == nr)
-        return 0.;
-
-    m_entries.Clear();
-    move_entries(v, nr, b, eweight, g, bg, m_entries, npolicy);
-    double dS = entries_dS(m_entries, mrs, bg, emat);
+    double dS = 0;
     int kout = npolicy.get_out_degree(v, g, eweight);
     int kin = kout;
     if (is_directed::apply<Graph>::type::value)
@@ -1249,7 +1539,6 @@ double virtual_move_sparse(size_t v, size_t nr, Eprop& mrs, Vprop& mrp,
     //assert(mrp[r]  - kout >= 0);
 
     int dwr, dwnr;
-    set<int> bv, nbv;
     if (!overlap_stats.is_enabled())
     {
         dwr = dwnr = vweight[v];
@@ -1274,6 +1563,34 @@ double virtual_move_sparse(size_t v, size_t nr, Eprop& mrs, Vprop& mrp,
     return dS;
 }
 
+// compute the entropy difference of a virtual move of vertex r to block nr
+template <class Graph, class BGraph, class Eprop, class Vprop, class EWprop,
+          class VWprop, class EMat, class OStats,
+          class NPolicy = standard_neighbours_policy>
+double virtual_move_sparse(size_t v, size_t nr, Eprop& mrs, Vprop& mrp,
+                           Vprop& mrm, Vprop& wr, Vprop& b, bool deg_corr,
+                           const EWprop& eweight, const VWprop& vweight,
+                           Graph& g, BGraph& bg, EMat& emat,
+                           EntrySet<Graph>& m_entries, OStats& overlap_stats,
+                           bool parallel_edges,
+                           const NPolicy& npolicy = NPolicy())
+
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    vertex_t r = b[v];
+
+    if (r == nr)
+        return 0.;
+
+    m_entries.Clear();
+    move_entries(v, nr, b, eweight, g, bg, m_entries, npolicy);
+    double dS = entries_dS(m_entries, mrs, bg, emat);
+    dS += virtual_move_vterms(v, r, nr, mrp, mrm, wr, b, deg_corr, eweight,
+                              vweight, g, bg, overlap_stats, parallel_edges,
+                              npolicy);
+    return dS;
+}
+
 
 // compute the entropy difference of a virtual move of vertex r to block nr
 template <class Graph, class BGraph, class Eprop, class Vprop, class EWprop,
@@ -1444,6 +1761,49 @@ double virtual_move(size_t v, size_t nr, bool dense, Eprop& mrs, Vprop& mrp,
     return S;
 }
 
+// compute the entropy differences of the virtual moves of vertex v to each of
+// the blocks in nrs (sparse entropy only); the neighbourhood of v is traversed
+// only once for all of them
+template <class Graph, class BGraph, class Eprop, class Vprop, class EWprop,
+          class VWprop, class EMat, class OStats, class PStats,
+          class NPolicy = standard_neighbours_policy>
+void virtual_moves(size_t v, const vector<size_t>& nrs, vector<double>& dS,
+                   Eprop& mrs, Vprop& mrp, Vprop& mrm, Vprop& wr, Vprop& b,
+                   bool deg_corr, const EWprop& eweight,
+                   const VWprop& vweight, Graph& g, BGraph& bg, EMat& emat,
+                   EntrySet<Graph>& m_entries, OStats& overlap_stats,
+                   bool parallel_edges, PStats& partition_stats,
+                   const NPolicy& npolicy = NPolicy())
+{
+    size_t r = b[v];
+    dS.resize(nrs.size());
+    if (nrs.empty())
+        return;
+
+    neighbour_blocks(v, b, eweight, g, m_entries, npolicy);
+
+    for (size_t i = 0; i < nrs.size(); ++i)
+    {
+        size_t nr = nrs[i];
+        if (nr == r)
+        {
+            dS[i] = 0;
+            continue;
+        }
+
+        m_entries.Clear();
+        move_entries(r, nr, m_entries);
+        double S = entries_dS(m_entries, mrs, bg, emat);
+        S += virtual_move_vterms(v, r, nr, mrp, mrm, wr, b, deg_corr, eweight,
+                                 vweight, g, bg, overlap_stats, parallel_edges,
+                                 npolicy);
+        if (partition_stats.is_enabled())
+            S += partition_stats.get_delta_dl(v, r, nr, deg_corr,
+                                              overlap_stats, g);
+        dS[i] = S;
+    }
+}
+
 // ====================================
 // Construct and manage half-edge lists
 // ====================================
@@ -1818,6 +2178,315 @@ struct merge_cmp_less
 };
 
 //A single Monte Carlo Markov chain sweep
+// Per-block locks used by the concurrent sweep. They are only acquired with
+// try_lock(), and a thread which cannot obtain all the blocks it needs
+// releases them instead of waiting, so that there are no deadlocks.
+class block_locks
+{
+public:
+    block_locks(size_t B) : _locks(B)
+    {
+#ifdef USING_OPENMP
+        for (auto& l : _locks)
+            omp_init_lock(&l);
+#endif
+    }
+
+    ~block_locks()
+    {
+#ifdef USING_OPENMP
+        for (auto& l : _locks)
+            omp_destroy_lock(&l);
+#endif
+    }
+
+    bool try_lock(size_t r)
+    {
+#ifdef USING_OPENMP
+        return omp_test_lock(&_locks[r]);
+#else
+        return true;
+#endif
+    }
+
+    void unlock(size_t r)
+    {
+#ifdef USING_OPENMP
+        omp_unset_lock(&_locks[r]);
+#endif
+    }
+
+    // locks all the blocks in rs, or none of them
+    bool try_lock(const vector<size_t>& rs)
+    {
+        for (size_t i = 0; i < rs.size(); ++i)
+        {
+            if (!try_lock(rs[i]))
+            {
+                for (size_t j = 0; j < i; ++j)
+                    unlock(rs[j]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unlock(const vector<size_t>& rs)
+    {
+        for (auto r : rs)
+            unlock(r);
+    }
+
+private:
+#ifdef USING_OPENMP
+    vector<omp_lock_t> _locks;
+#else
+    vector<char> _locks;
+#endif
+};
+
+// Sweep where the moves are applied concurrently by several threads. A move of
+// v from r to s only reads and modifies the entries of the block matrix, and
+// the block properties, of r, s, and the blocks of the neighbours of v, which
+// are all locked while the move is proposed, evaluated and applied. The
+// attempts which cannot obtain their locks, because they conflict with
+// another move in progress, are retried serially at the end of the sweep, so
+// that every vertex is attempted once, and no move is evaluated twice.
+template <class Graph, class BGraph, class EMprop, class Eprop, class Vprop,
+          class EMat, class EVprop, class VEprop, class SamplerMap, class OStats,
+          class RNG>
+void move_sweep_concurrent(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr,
+                           Vprop b, Vprop clabel, vector<int>& vlist,
+                           bool deg_corr, bool multigraph, double beta,
+                           Eprop eweight, Vprop vweight, EVprop egroups,
+                           VEprop esrcpos, VEprop etgtpos, Graph& g,
+                           BGraph& bg, EMat& emat, SamplerMap neighbour_sampler,
+                           bool sequential, bool random_move, double c,
+                           size_t ntries, partition_stats_t& partition_stats,
+                           RNG& rng, double& S, size_t& nmoves,
+                           OStats overlap_stats)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    size_t B = num_vertices(bg);
+
+    // the vertices are chosen beforehand, so that the number of new block
+    // pairs is bounded: each move creates at most one per edge, and the block
+    // edge matrix must not be reorganized while it is read by other threads
+    vector<vertex_t> vs;
+    vs.reserve(vlist.size());
+    if (sequential)
+    {
+        std::shuffle(vlist.begin(), vlist.end(), rng);
+        for (auto v : vlist)
+            vs.push_back(vertex(v, g));
+    }
+    else
+    {
+        std::uniform_int_distribution<size_t> v_rand(0, vlist.size() - 1);
+        for (size_t i = 0; i < vlist.size(); ++i)
+            vs.push_back(vertex(vlist[v_rand(rng)], g));
+    }
+
+    size_t max_new = 0;
+    for (auto v : vs)
+        max_new += total_degreeS()(v, g) + 1;
+    reserve_me(max_new, emat, bg);
+
+    block_locks locks(B);
+    parallel_rng prng(rng);
+
+    enum { REJECTED, MOVED, CONFLICT };
+
+    // attempts to move v, and returns the outcome
+    auto attempt = [&](vertex_t v, RNG& trng, EntrySet<Graph>& m_entries,
+                       vector<size_t>& held, double& dS) -> int
+        {
+            typedef std::uniform_real_distribution<> rdist_t;
+            auto rand_real = std::bind(rdist_t(), std::ref(trng));
+            std::uniform_int_distribution<size_t> s_rand(0, B - 1);
+
+            vertex_t r = b[v];
+
+            held.clear();
+            held.push_back(r);
+            for (auto e : all_edges_range(v, g))
+            {
+                vertex_t u = target(e, g);
+                if (is_directed::apply<Graph>::type::value && u == v)
+                    u = source(e, g);
+                held.push_back(b[u]);
+            }
+            std::sort(held.begin(), held.end());
+            held.erase(std::unique(held.begin(), held.end()), held.end());
+
+            if (!locks.try_lock(held))
+                return CONFLICT;
+
+            // the blocks may have changed before the locks were obtained
+            auto is_held = [&](size_t t)
+                {
+                    return std::binary_search(held.begin(), held.end(), t);
+                };
+            bool valid = (size_t(b[v]) == r);
+            for (auto e : all_edges_range(v, g))
+            {
+                if (!valid)
+                    break;
+                vertex_t u = target(e, g);
+                if (is_directed::apply<Graph>::type::value && u == v)
+                    u = source(e, g);
+                valid = is_held(b[u]);
+            }
+            if (!valid)
+            {
+                locks.unlock(held);
+                return CONFLICT;
+            }
+
+            int ret = REJECTED;
+            for (size_t j = 0; j < ntries && ret == REJECTED; ++j)
+            {
+                // blocks can't become empty
+                if (wr[r] == vweight[v] && std::isinf(beta))
+                    break;
+
+                vertex_t s = s_rand(trng);
+                if (!random_move && total_degreeS()(v, g) > 0)
+                {
+                    vertex_t u = neighbour_sampler[v].sample(trng);
+                    vertex_t t = b[u];
+
+                    double p_rand = 0;
+                    if (c > 0)
+                    {
+                        if (is_directed::apply<Graph>::type::value)
+                            p_rand = c * B / double(mrp[t] + mrm[t] + c * B);
+                        else
+                            p_rand = c * B / double(mrp[t] + c * B);
+                    }
+
+                    if (c == 0 || rand_real() >= p_rand)
+                    {
+                        const auto& e = egroups_manage::sample_edge(egroups[t], trng);
+                        s = b[target(e, g)];
+                        if (s == t)
+                            s = b[source(e, g)];
+                    }
+                }
+
+                if (s == r)
+                    continue;
+
+                bool lock_s = !is_held(s);
+                if (lock_s && !locks.try_lock(s))
+                {
+                    ret = CONFLICT;
+                    break;
+                }
+
+                if ((wr[s] == 0 && std::isinf(beta)) || clabel[s] != clabel[r])
+                {
+                    if (lock_s)
+                        locks.unlock(s);
+                    continue;
+                }
+
+                dS = virtual_move(v, s, false, mrs, mrp, mrm, wr, b, deg_corr,
+                                  eweight, vweight, g, bg, emat, m_entries,
+                                  overlap_stats, multigraph, partition_stats);
+
+                bool accept = false;
+                if (std::isinf(beta))
+                {
+                    accept = dS < 0;
+                }
+                else
+                {
+                    double pf = random_move ? 1 :
+                        get_move_prob(v, r, s, c, b, mrs, mrp, mrm, emat,
+                                      eweight, g, bg, m_entries, false,
+                                      overlap_stats);
+
+                    double pb = random_move ? 1 :
+                        get_move_prob(v, s, r, c, b, mrs, mrp, mrm, emat,
+                                      eweight, g, bg, m_entries, true,
+                                      overlap_stats);
+
+                    double a = -beta * dS + log(pb) - log(pf);
+                    accept = (a > 0 || rand_real() < exp(a));
+                }
+
+                if (accept)
+                {
+                    move_vertex(v, s, mrs, mrp, mrm, wr, b, deg_corr, eweight,
+                                vweight, g, bg, emat, overlap_stats,
+                                partition_stats);
+                    if (!random_move)
+                        egroups_manage::update_egroups(v, r, s, eweight,
+                                                       egroups, esrcpos,
+                                                       etgtpos, g);
+                    ret = MOVED;
+                }
+
+                if (lock_s)
+                    locks.unlock(s);
+            }
+            locks.unlock(held);
+            return ret;
+        };
+
+    double tS = 0;
+    size_t tmoves = 0;
+    vector<vertex_t> deferred;
+
+    int i = 0, N = vs.size();
+    #pragma omp parallel default(shared) private(i) reduction(+:tS, tmoves)
+    {
+        EntrySet<Graph> m_entries(B);
+        vector<size_t> held;
+        vector<vertex_t> tdeferred;
+
+        #pragma omp for schedule(runtime)
+        for (i = 0; i < N; ++i)
+        {
+            vertex_t v = vs[i];
+            if (vweight[v] == 0)
+                continue;
+
+            double dS = 0;
+            switch (attempt(v, prng.get(), m_entries, held, dS))
+            {
+            case MOVED:
+                tS += dS;
+                ++tmoves;
+                break;
+            case CONFLICT:
+                tdeferred.push_back(v);
+                break;
+            }
+        }
+
+        #pragma omp critical (deferred_moves)
+        deferred.insert(deferred.end(), tdeferred.begin(), tdeferred.end());
+    }
+
+    EntrySet<Graph> m_entries(B);
+    vector<size_t> held;
+    for (auto v : deferred)
+    {
+        double dS = 0;
+        if (attempt(v, rng, m_entries, held, dS) == MOVED)
+        {
+            tS += dS;
+            ++tmoves;
+        }
+    }
+
+    S = tS;
+    nmoves = tmoves;
+}
+
 template <class Graph, class BGraph, class EMprop, class Eprop, class Vprop,
           class EMat, class EVprop, class VEprop, class SamplerMap, class OStats,
           class RNG>
@@ -1827,8 +2496,8 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
                 EVprop egroups, VEprop esrcpos, VEprop etgtpos, Graph& g,
                 BGraph& bg, EMat& emat, SamplerMap neighbour_sampler,
                 SamplerMap cavity_neighbour_sampler, bool sequential,
-                bool parallel, bool random_move, double c, size_t nmerges,
-                size_t ntries, Vprop merge_map,
+                bool parallel, bool concurrent, bool random_move, double c,
+                size_t nmerges, size_t ntries, Vprop merge_map,
                 partition_stats_t& partition_stats, bool verbose, RNG& rng,
                 double& S, size_t& nmoves, OStats overlap_stats)
 {
@@ -1837,7 +2506,19 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
     size_t B = num_vertices(bg);
 
     if (vlist.size() < 100)
-        parallel = false;
+        parallel = concurrent = false;
+
+    // the dense entropy depends on all the blocks, and cannot be evaluated
+    // concurrently
+    if (concurrent && nmerges == 0 && !dense)
+    {
+        move_sweep_concurrent(mrs, mrp, mrm, wr, b, clabel, vlist, deg_corr,
+                              multigraph, beta, eweight, vweight, egroups,
+                              esrcpos, etgtpos, g, bg, emat, neighbour_sampler,
+                              sequential, random_move, c, ntries,
+                              partition_stats, rng, S, nmoves, overlap_stats);
+        return;
+    }
 
     // used only if merging
     std::unordered_set<vertex_t> past_moves;
@@ -1858,41 +2539,22 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
 
     EntrySet<Graph> m_entries(B);
 
-    vector<rng_t*> rngs;
-    if (parallel)
-    {
-        size_t num_threads = 1;
-#ifdef USING_OPENMP
-        num_threads = omp_get_max_threads();
-#endif
-        for (size_t i = 0; i < num_threads; ++i)
-        {
-            std::array<int, std::mt19937::state_size> seed_data;
-            std::generate_n(seed_data.data(), seed_data.size(), std::ref(rng));
-            std::seed_seq seq(std::begin(seed_data), std::end(seed_data));
-            rngs.push_back(new rng_t(seq));
-        }
-    }
-    else
-    {
-        rngs.push_back(&rng);
-    }
+    // used only if merging, for the batches of candidate merges
+    vector<size_t> candidates;
+    vector<double> candidates_dS;
+
+    parallel_rng prng(rng);
 
     int i = 0, N = vlist.size();
     #pragma omp parallel for default(shared) private(i) \
-        firstprivate(m_entries, past_moves) schedule(runtime) if (parallel)
+        firstprivate(m_entries, past_moves, candidates, candidates_dS) \
+        schedule(runtime) if (parallel)
     for (i = 0; i < N; ++i)
     {
-        size_t tid = 0;
-        if (parallel)
-        {
-#ifdef USING_OPENMP
-            tid = omp_get_thread_num();
-#endif
-        }
+        auto& trng = prng.get();
 
         typedef std::uniform_real_distribution<> rdist_t;
-        auto rand_real = std::bind(rdist_t(), std::ref(*rngs[tid]));
+        auto rand_real = std::bind(rdist_t(), std::ref(trng));
 
         vertex_t v;
         if (sequential)
@@ -1902,7 +2564,7 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
         else
         {
             std::uniform_int_distribution<size_t> v_rand(0, N - 1);
-            v = vertex(vlist[v_rand(*rngs[tid])], g);
+            v = vertex(vlist[v_rand(trng)], g);
         }
 
         vertex_t r = b[v];
@@ -1917,19 +2579,67 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
         if (nmerges > 0)
             past_moves.clear();
 
+        // the candidate merges of v are evaluated together, in batches of
+        // ntries, for as long as the best one keeps improving
+        if (nmerges > 0 && !dense)
+        {
+            bool improved = true;
+            while (improved)
+            {
+                candidates.clear();
+                for (size_t j = 0; j < ntries; ++j)
+                {
+                    vertex_t s = s_rand(trng);
+                    if (!random_move && total_degreeS()(v, g) > 0)
+                    {
+                        // neighbour sampler points to the *block graph*
+                        s = neighbour_sampler[r].sample(trng);
+                        if (s == r)
+                            s = cavity_neighbour_sampler[s].sample(trng);
+                        else
+                            s = neighbour_sampler[s].sample(trng);
+                    }
+
+                    if (s == r || wr[s] == 0 || clabel[s] != clabel[r])
+                        continue;
+                    if (past_moves.find(s) != past_moves.end())
+                        continue;
+                    past_moves.insert(s);
+                    candidates.push_back(s);
+                }
+
+                virtual_moves(v, candidates, candidates_dS, mrs, mrp, mrm, wr,
+                              b, deg_corr, eweight, vweight, g, bg, emat,
+                              m_entries, overlap_stats, multigraph,
+                              partition_stats);
+
+                improved = false;
+                for (size_t j = 0; j < candidates.size(); ++j)
+                {
+                    if (candidates_dS[j] < best_move[v].second)
+                    {
+                        best_move[v].first = candidates[j];
+                        best_move[v].second = candidates_dS[j];
+                        improved = true;
+                    }
+                }
+            }
+            continue;
+        }
+
         size_t j = 0;
         while (j < ntries)
         {
             ++j;
 
             // attempt random block
-            vertex_t s = s_rand(*rngs[tid]);
+            vertex_t s = s_rand(trng);
 
             if (!random_move && total_degreeS()(v, g) > 0)
             {
                 if (nmerges == 0)
                 {
-                    vertex_t u = neighbour_sampler[v].sample(*rngs[tid]);
+                    vertex_t u = neighbour_sampler[v].sample(trng);
 
                     vertex_t t = b[u];
 
@@ -1944,7 +2654,7 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
 
                     if (c == 0 || rand_real() >= p_rand)
                     {
-                        const auto& e = egroups_manage::sample_edge(egroups[t], *rngs[tid]);
+                        const auto& e = egroups_manage::sample_edge(egroups[t], trng);
                         s = b[target(e, g)];
                         if (s == t)
                             s = b[source(e, g)];
@@ -1953,11 +2663,11 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
                 else
                 {
                     // neighbour sampler points to the *block graph*
-                    s = neighbour_sampler[r].sample(*rngs[tid]);
+                    s = neighbour_sampler[r].sample(trng);
                     if (s == r)
-                        s = cavity_neighbour_sampler[s].sample(*rngs[tid]);
+                        s = cavity_neighbour_sampler[s].sample(trng);
                     else
-                        s = neighbour_sampler[s].sample(*rngs[tid]);
+                        s = neighbour_sampler[s].sample(trng);
                 }
             }
 
@@ -2055,10 +2765,6 @@ void move_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
 
     if (parallel && (nmerges == 0))
     {
-        for (auto r : rngs)
-            delete r;
-        rngs.clear();
-
         for (vertex_t v : vlist)
         {
             vertex_t r = b[v];
@@ -2221,6 +2927,100 @@ struct init_neighbour_sampler
     }
 };
 
+// Edge weights used to sample merge candidates from the block graph: either
+// the edge counts between blocks, or only whether they are connected.
+template <class EMprop>
+struct merge_eweight
+{
+    merge_eweight(EMprop mrs, bool counts) : _mrs(mrs), _counts(counts) {}
+
+    template <class Edge>
+    double operator[](const Edge& e) const
+    {
+        if (_counts)
+            return _mrs[e];
+        return _mrs[e] > 0 ? 1 : 0;
+    }
+
+    EMprop _mrs;
+    bool _counts;
+};
+
+// Greedily merge the vertices until only B_target nonempty blocks remain,
+// with repeated merge sweeps. The block graph, the edge matrix and the
+// partition statistics are kept up to date by the sweeps themselves, and only
+// the neighbour samplers of the block graph are rebuilt between them. If a
+// sweep finds no merge, the candidates are sampled according to the edge
+// counts, and if that also fails, uniformly at random.
+template <class Graph, class BGraph, class EMprop, class Eprop, class Vprop,
+          class EMat, class EVprop, class VEprop, class SamplerMap, class OStats,
+          class RNG>
+void merge_sweep(EMprop mrs, Vprop mrp, Vprop mrm, Vprop wr, Vprop b,
+                 Vprop clabel, vector<int>& vlist, bool deg_corr, bool dense,
+                 bool multigraph, Eprop eweight, Vprop vweight, EVprop egroups,
+                 VEprop esrcpos, VEprop etgtpos, Graph& g, BGraph& bg,
+                 EMat& emat, SamplerMap neighbour_sampler,
+                 SamplerMap cavity_neighbour_sampler, bool sequential,
+                 bool parallel, bool random_move, bool unweighted,
+                 size_t B_target, size_t ntries, Vprop merge_map,
+                 partition_stats_t& partition_stats, bool verbose, RNG& rng,
+                 double& S, size_t& nmoves, OStats overlap_stats)
+{
+    auto get_B = [&]()
+        {
+            size_t B = 0;
+            for (auto r : vertices_range(bg))
+                if (wr[r] > 0)
+                    ++B;
+            return B;
+        };
+
+    S = 0;
+    nmoves = 0;
+
+    size_t B = get_B();
+    while (B > B_target)
+    {
+        if (!random_move)
+        {
+            merge_eweight<EMprop> ew(mrs, unweighted);
+            for (auto r : vertices_range(bg))
+            {
+                build_neighbour_sampler(r, neighbour_sampler, ew, true, bg);
+                build_neighbour_sampler(r, cavity_neighbour_sampler, ew, false,
+                                        bg);
+            }
+        }
+
+        double dS = 0;
+        size_t nmerges = 0;
+        move_sweep(mrs, mrp, mrm, wr, b, clabel, vlist, deg_corr, dense,
+                   multigraph, numeric_limits<double>::infinity(), eweight,
+                   vweight, egroups, esrcpos, etgtpos, g, bg, emat,
+                   neighbour_sampler, cavity_neighbour_sampler, sequential,
+                   parallel, false, random_move, 0., B - B_target, ntries,
+                   merge_map, partition_stats, false, rng, dS, nmerges,
+                   overlap_stats);
+        S += dS;
+        nmoves += nmerges;
+        B = get_B();
+
+        if (verbose)
+            cout << "merging, B=" << B << " left: " << B - B_target
+                 << " (" << dS << ", " << nmerges
+                 << (random_move ? ", random" : "")
+                 << (unweighted ? ", unweighted" : "") << ")" << endl;
+
+        if (nmerges == 0)
+        {
+            if (!unweighted)
+                unweighted = true;
+            else
+                random_move = true;
+        }
+    }
+}
+
 
 // Sampling marginal probabilities on the edges
 template <class Graph, class Vprop, class MEprop>
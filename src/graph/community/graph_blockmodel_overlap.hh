@@ -485,10 +485,10 @@ struct overlap_partition_stats_t
             S += ss;
         }
 
-        S += lbinom(_D + _N - 1, _N) + lgamma(_N + 1);
+        S += lbinom_fast(_D + _N - 1, _N) + lgamma_fast(_N + 1);
 
         for (auto& bh : _bhist)
-            S -= lgamma(bh.second + 1);
+            S -= lgamma_fast(bh.second + 1);
 
         // double S1 = S;
         // S = 0;
@@ -598,7 +598,7 @@ struct overlap_partition_stats_t
                     }
                 }
 
-                S1 += lgamma(n_bv + 1);
+                S1 += lgamma_fast(n_bv + 1);
 
                 for (auto& dh : cdeg_hist)
                     S1 -= lgamma_fast(dh.second + 1);
@@ -608,8 +608,8 @@ struct overlap_partition_stats_t
                     double S2 = 0;
                     for (size_t i = 0; i < bv.size(); ++i)
                     {
-                        S2 += lbinom(n_bv + bmh[i] - 1, bmh[i]);
-                        S2 += lbinom(n_bv + bph[i] - 1, bph[i]);
+                        S2 += lbinom_fast(n_bv + bmh[i] - 1, bmh[i]);
+                        S2 += lbinom_fast(n_bv + bph[i] - 1, bph[i]);
                     }
                     S += min(S1, S2);
                 }
@@ -623,8 +623,8 @@ struct overlap_partition_stats_t
             {
                 if (_r_count[r] == 0)
                     continue;
-                S += lbinom(_r_count[r] + _emhist[r] - 1,  _emhist[r]);
-                S += lbinom(_r_count[r] + _ephist[r] - 1,  _ephist[r]);
+                S += lbinom_fast(_r_count[r] + _emhist[r] - 1,  _emhist[r]);
+                S += lbinom_fast(_r_count[r] + _ephist[r] - 1,  _ephist[r]);
             }
 
             //const double z2 = boost::math::zeta(2);
@@ -58,8 +58,6 @@ struct get_communities
         typedef typename property_traits<WeightMap>::key_type weight_key_t;
 
 
-        auto random = std::bind(std::uniform_real_distribution<>(), std::ref(rng));
-
         stringstream out_str;
         ofstream out_file;
         if (verbose.second != "")
@@ -106,6 +104,7 @@ struct get_communities
             vector<std::tuple<size_t, size_t, size_t> > updates;
 
             // sample a new spin for every vertex
+            parallel_rng prng(rng);
             int NV = num_vertices(g),i;
             #pragma omp parallel for default(shared) private(i)\
                 reduction(+:E) schedule(runtime) if (NV > 100)
@@ -115,11 +114,9 @@ struct get_communities
                 if (v == graph_traits<Graph>::null_vertex())
                     continue;
 
-                size_t new_s;
-                {
-                    #pragma omp critical
-                    new_s = sample_spin(rng);
-                }
+                auto& trng = prng.get();
+                size_t new_s =
+                    uniform_int_distribution<size_t>(0, n_spins - 1)(trng);
 
                 unordered_map<size_t, double> ns; // number of neighbours with a
                                                   // given spin 's' (weighted)
@@ -138,11 +135,7 @@ struct get_communities
                 double curr_e = gamma*Nnnks(k,s[v]) - ns[s[v]];
                 double new_e = gamma*Nnnks(k,new_s) - ns[new_s];
 
-                double r;
-                {
-                    #pragma omp critical
-                    r = random();
-                }
+                double r = uniform_real_distribution<>()(trng);
 
                 if (new_e < curr_e || r < exp(-(new_e - curr_e)/T))
                 {
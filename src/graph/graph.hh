@@ -86,6 +86,8 @@ public:
     bool GetReversed() {return _reversed;}
     void SetKeepEpos(bool keep) {_mg->set_keep_epos(keep);}
     bool GetKeepEpos() {return _mg->get_keep_epos();}
+    void SetFrozen(bool frozen) {if (frozen) _mg->freeze(); else _mg->thaw();}
+    bool GetFrozen() {return _mg->is_frozen();}
 
 
     // graph filtering
@@ -125,7 +127,16 @@ public:
                                       string format,
                                       boost::python::list ignore_vp,
                                       boost::python::list ignore_ep,
-                                      boost::python::list ignore_gp);
+                                      boost::python::list ignore_gp,
+                                      bool lazy);
+    boost::python::object ReadDeferredProperty(string s, string key,
+                                               boost::python::tuple state);
+    boost::python::tuple ReadEdgeList(string s, boost::python::object pf,
+                                      string format, string delim,
+                                      string comment, bool skip_first,
+                                      bool hashed,
+                                      boost::python::list eprop_types,
+                                      bool two_pass);
 
     //
     // Internal types
@@ -141,7 +152,14 @@ public:
     //                         no_property,
     //                         EdgeProperty,
     //                         vecS>  multigraph_t;
+
+    // the index type can be reduced to 32 bits at compile time, to save
+    // memory (see the --enable-32bit-index configure option)
+#ifdef GRAPH_INDEX_32BIT
+    typedef boost::adj_list<uint32_t> multigraph_t;
+#else
     typedef boost::adj_list<size_t> multigraph_t;
+#endif
     typedef boost::graph_traits<multigraph_t>::vertex_descriptor vertex_t;
     typedef boost::graph_traits<multigraph_t>::edge_descriptor edge_t;
 
@@ -24,6 +24,8 @@
 #include <numeric>
 #include <iostream>
 #include <tuple>
+#include <limits>
+#include <stdexcept>
 #include <boost/iterator.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/range/irange.hpp>
@@ -57,28 +59,34 @@ edges(const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-edge(Vertex s, Vertex t, const adj_list<Vertex>& g);
+edge(typename adj_list<Vertex>::vertex_t s,
+     typename adj_list<Vertex>::vertex_t t, const adj_list<Vertex>& g);
 
 template <class Vertex>
-size_t out_degree(Vertex v, const adj_list<Vertex>& g);
+size_t out_degree(typename adj_list<Vertex>::vertex_t v,
+                  const adj_list<Vertex>& g);
 
 template <class Vertex>
-size_t in_degree(Vertex v, const adj_list<Vertex>& g);
+size_t in_degree(typename adj_list<Vertex>::vertex_t v,
+                 const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::out_edge_iterator,
           typename adj_list<Vertex>::out_edge_iterator>
-out_edges(Vertex v, const adj_list<Vertex>& g);
+out_edges(typename adj_list<Vertex>::vertex_t v,
+          const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::in_edge_iterator,
           typename adj_list<Vertex>::in_edge_iterator>
-in_edges(Vertex v, const adj_list<Vertex>& g);
+in_edges(typename adj_list<Vertex>::vertex_t v,
+         const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-adjacent_vertices(Vertex v, const adj_list<Vertex>& g);
+adjacent_vertices(typename adj_list<Vertex>::vertex_t v,
+                  const adj_list<Vertex>& g);
 
 template <class Vertex>
 size_t num_vertices(const adj_list<Vertex>& g);
@@ -90,20 +98,25 @@ template <class Vertex>
 Vertex add_vertex(adj_list<Vertex>& g);
 
 template <class Vertex>
-void clear_vertex(Vertex v, adj_list<Vertex>& g);
+void clear_vertex(typename adj_list<Vertex>::vertex_t v,
+                  adj_list<Vertex>& g);
 
 template <class Vertex>
-void remove_vertex(Vertex v, adj_list<Vertex>& g);
+void remove_vertex(typename adj_list<Vertex>::vertex_t v,
+                   adj_list<Vertex>& g);
 
 template <class Vertex>
-void remove_vertex_fast(Vertex v, adj_list<Vertex>& g);
+void remove_vertex_fast(typename adj_list<Vertex>::vertex_t v,
+                        adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-add_edge(Vertex s, Vertex t, adj_list<Vertex>& g);
+add_edge(typename adj_list<Vertex>::vertex_t s,
+         typename adj_list<Vertex>::vertex_t t, adj_list<Vertex>& g);
 
 template <class Vertex>
-void remove_edge(Vertex s, Vertex t, adj_list<Vertex>& g);
+void remove_edge(typename adj_list<Vertex>::vertex_t s,
+                 typename adj_list<Vertex>::vertex_t t, adj_list<Vertex>& g);
 
 template <class Vertex>
 void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
@@ -128,6 +141,15 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
 // boost::adjacency_list with vector storage selectors for both vertex and edge
 // lists.
 
+// The graph can also be "frozen", in which case the per-vertex edge lists are
+// packed into a compressed-sparse-row (CSR) layout: a single contiguous array
+// of (neighbour, edge index) pairs for each direction, plus an offset array of
+// size N + 1. This removes the per-vertex vector headers and heap allocations,
+// and makes traversals sequential in memory. Since the iterator types are the
+// same in both layouts, every graph view (filtered, reversed, undirected) can
+// be used unmodified with a frozen graph. Any modification of the graph will
+// automatically "thaw" it back to the mutable layout first.
+
 template <class Vertex = size_t>
 class adj_list
 {
@@ -164,7 +186,7 @@ public:
     typedef std::vector<std::pair<vertex_t, vertex_t> > edge_list_t;
     typedef typename integer_range<Vertex>::iterator vertex_iterator;
 
-    adj_list(): _n_edges(0), _last_idx(0), _keep_epos(false) {}
+    adj_list(): _n_edges(0), _last_idx(0), _keep_epos(false), _frozen(false) {}
 
     struct get_vertex
     {
@@ -202,6 +224,8 @@ public:
     typedef transform_random_access_iterator<make_in_edge, typename edge_list_t::const_iterator>
         in_edge_iterator;
 
+    typedef typename edge_list_t::const_iterator edge_list_iterator;
+
     class edge_iterator:
         public boost::iterator_facade<edge_iterator,
                                       edge_descriptor,
@@ -209,13 +233,12 @@ public:
                                       edge_descriptor>
     {
     public:
-        edge_iterator() {}
-        explicit edge_iterator(const typename std::vector<edge_list_t>::const_iterator& vi_begin,
-                               const typename std::vector<edge_list_t>::const_iterator& vi_end,
-                               const typename std::vector<edge_list_t>::const_iterator& vi,
-                               const typename edge_list_t::const_iterator& ei)
-            : _vi_begin(vi_begin), _vi_end(vi_end), _vi(vi), _ei(ei)
+        edge_iterator(): _g(0), _v(0) {}
+        explicit edge_iterator(const adj_list& g, vertex_t v)
+            : _g(&g), _v(v)
         {
+            if (_v < num_vertices(*_g))
+                std::tie(_ei, _ei_end) = _g->get_out_list(_v);
             // move position to first edge
             skip();
         }
@@ -226,12 +249,15 @@ public:
         void skip()
         {
             //skip empty vertices
-            while (_vi != _vi_end && _ei == _vi->end())
+            size_t N = num_vertices(*_g);
+            while (_v < N && _ei == _ei_end)
             {
-                ++_vi;
-                if (_vi != _vi_end)
-                    _ei = _vi->begin();
+                ++_v;
+                if (_v < N)
+                    std::tie(_ei, _ei_end) = _g->get_out_list(_v);
             }
+            if (_v >= N)
+                _ei = _ei_end = edge_list_iterator();
         }
 
         void increment()
@@ -242,25 +268,23 @@ public:
 
         bool equal(edge_iterator const& other) const
         {
-            if (_vi_begin == _vi_end)
-                return _vi == other._vi;
-            return _vi == other._vi && _ei == other._ei;
+            return _v == other._v && _ei == other._ei;
         }
 
         edge_descriptor dereference() const
         {
-            return edge_descriptor(vertex_t(_vi - _vi_begin),
-                                   _ei->first, _ei->second, false);
+            return edge_descriptor(_v, _ei->first, _ei->second, false);
         }
 
-        typename std::vector<edge_list_t>::const_iterator _vi_begin;
-        typename std::vector<edge_list_t>::const_iterator _vi_end;
-        typename std::vector<edge_list_t>::const_iterator _vi;
-        typename edge_list_t::const_iterator _ei;
+        const adj_list* _g;
+        vertex_t _v;
+        edge_list_iterator _ei;
+        edge_list_iterator _ei_end;
     };
 
     void reindex_edges()
     {
+        thaw();
         _free_indexes.clear();
         _last_idx = 0;
         _in_edges.clear();
@@ -281,6 +305,7 @@ public:
 
     void set_keep_epos(bool keep)
     {
+        thaw();
         if (keep)
         {
             if (!_keep_epos)
@@ -302,6 +327,93 @@ public:
 
     static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
 
+    // pack the edge lists into CSR form; O(V + E)
+    void freeze()
+    {
+        if (_frozen)
+            return;
+        pack_edges(_out_edges, _out_pos, _out_csr);
+        pack_edges(_in_edges, _in_pos, _in_csr);
+        _frozen = true;
+    }
+
+    // restore the mutable per-vertex edge lists; O(V + E)
+    void thaw()
+    {
+        if (!_frozen)
+            return;
+        unpack_edges(_out_pos, _out_csr, _out_edges);
+        unpack_edges(_in_pos, _in_csr, _in_edges);
+        _frozen = false;
+    }
+
+    bool is_frozen() const { return _frozen; }
+
+    // Replace all edges by the out-neighbourhoods given in CSR form, i.e. the
+    // out-neighbours of vertex v are out_csr[out_pos[v]].first, ...,
+    // out_csr[out_pos[v + 1] - 1].first, and leave the graph frozen. The
+    // edges are indexed sequentially in this order (the second field of each
+    // pair is overwritten). Both arguments are consumed. O(V + E)
+    void assign_frozen(std::vector<size_t>& out_pos, edge_list_t& out_csr)
+    {
+        size_t N = out_pos.size() - 1;
+        size_t E = out_csr.size();
+
+        vertex_list_t().swap(_out_edges);
+        vertex_list_t().swap(_in_edges);
+        _out_pos.swap(out_pos);
+        _out_csr.swap(out_csr);
+        std::vector<size_t>().swap(out_pos);
+        edge_list_t().swap(out_csr);
+
+        for (size_t i = 0; i < E; ++i)
+            _out_csr[i].second = i;
+
+        // counting sort of the edges by target, keeping the source ordering
+        _in_pos.clear();
+        _in_pos.resize(N + 1, 0);
+        for (size_t i = 0; i < E; ++i)
+            _in_pos[_out_csr[i].first + 1]++;
+        for (size_t v = 0; v < N; ++v)
+            _in_pos[v + 1] += _in_pos[v];
+        _in_csr.resize(E);
+        std::vector<size_t> fill(_in_pos.begin(), _in_pos.end() - 1);
+        for (size_t v = 0; v < N; ++v)
+        {
+            for (size_t i = _out_pos[v]; i < _out_pos[v + 1]; ++i)
+            {
+                auto& e = _out_csr[i];
+                _in_csr[fill[e.first]++] = std::make_pair(vertex_t(v),
+                                                          e.second);
+            }
+        }
+
+        _n_edges = E;
+        _last_idx = E;
+        _free_indexes.clear();
+        _frozen = true;
+        if (_keep_epos)
+            rebuild_epos();
+    }
+
+    std::pair<edge_list_iterator, edge_list_iterator>
+    get_out_list(vertex_t v) const
+    {
+        if (_frozen)
+            return std::make_pair(_out_csr.begin() + _out_pos[v],
+                                  _out_csr.begin() + _out_pos[v + 1]);
+        return std::make_pair(_out_edges[v].begin(), _out_edges[v].end());
+    }
+
+    std::pair<edge_list_iterator, edge_list_iterator>
+    get_in_list(vertex_t v) const
+    {
+        if (_frozen)
+            return std::make_pair(_in_csr.begin() + _in_pos[v],
+                                  _in_csr.begin() + _in_pos[v + 1]);
+        return std::make_pair(_in_edges[v].begin(), _in_edges[v].end());
+    }
+
 private:
     typedef std::vector<edge_list_t> vertex_list_t;
     vertex_list_t _out_edges;
@@ -315,8 +427,53 @@ private:
     bool _keep_epos;
     std::vector<std::pair<int32_t, int32_t> > _epos;
 
+    // frozen (CSR) storage: the edges of vertex v lie in the range
+    // [_out_pos[v], _out_pos[v + 1]) of _out_csr (and likewise for in-edges)
+    bool _frozen;
+    std::vector<size_t> _out_pos;
+    std::vector<size_t> _in_pos;
+    edge_list_t _out_csr;
+    edge_list_t _in_csr;
+
+    static void pack_edges(vertex_list_t& edges, std::vector<size_t>& pos,
+                           edge_list_t& csr)
+    {
+        size_t N = edges.size();
+        pos.resize(N + 1);
+        pos[0] = 0;
+        for (size_t i = 0; i < N; ++i)
+            pos[i + 1] = pos[i] + edges[i].size();
+        csr.resize(pos[N]);
+
+        int i;
+        #pragma omp parallel for default(shared) private(i) \
+            schedule(runtime) if (N > 100)
+        for (i = 0; i < int(N); ++i)
+        {
+            std::copy(edges[i].begin(), edges[i].end(), csr.begin() + pos[i]);
+            edge_list_t().swap(edges[i]);
+        }
+        vertex_list_t().swap(edges);
+    }
+
+    static void unpack_edges(std::vector<size_t>& pos, edge_list_t& csr,
+                             vertex_list_t& edges)
+    {
+        size_t N = pos.size() - 1;
+        edges.resize(N);
+
+        int i;
+        #pragma omp parallel for default(shared) private(i) \
+            schedule(runtime) if (N > 100)
+        for (i = 0; i < int(N); ++i)
+            edges[i].assign(csr.begin() + pos[i], csr.begin() + pos[i + 1]);
+        edge_list_t().swap(csr);
+        std::vector<size_t>().swap(pos);
+    }
+
     void rebuild_epos()
     {
+        thaw();
         _epos.resize(_last_idx + 1);
         for (size_t i = 0; i < _out_edges.size(); ++i)
         {
@@ -342,20 +499,20 @@ private:
     edges<>(const adj_list<Vertex>& g);
 
     friend std::pair<edge_descriptor, bool>
-    edge<>(Vertex s, Vertex t, const adj_list<Vertex>& g);
+    edge<>(vertex_t s, vertex_t t, const adj_list<Vertex>& g);
 
-    friend size_t out_degree<>(Vertex v, const adj_list<Vertex>& g);
+    friend size_t out_degree<>(vertex_t v, const adj_list<Vertex>& g);
 
-    friend size_t in_degree<>(Vertex v, const adj_list<Vertex>& g);
+    friend size_t in_degree<>(vertex_t v, const adj_list<Vertex>& g);
 
     friend std::pair<out_edge_iterator, out_edge_iterator>
-    out_edges<>(Vertex v, const adj_list<Vertex>& g);
+    out_edges<>(vertex_t v, const adj_list<Vertex>& g);
 
     friend std::pair<in_edge_iterator, in_edge_iterator>
-    in_edges<>(Vertex v, const adj_list<Vertex>& g);
+    in_edges<>(vertex_t v, const adj_list<Vertex>& g);
 
     friend std::pair<adjacency_iterator, adjacency_iterator>
-    adjacent_vertices<>(Vertex v, const adj_list<Vertex>& g);
+    adjacent_vertices<>(vertex_t v, const adj_list<Vertex>& g);
 
     friend size_t num_vertices<>(const adj_list<Vertex>& g);
 
@@ -363,16 +520,16 @@ private:
 
     friend Vertex add_vertex<>(adj_list<Vertex>& g);
 
-    friend void clear_vertex<>(Vertex v, adj_list<Vertex>& g);
+    friend void clear_vertex<>(vertex_t v, adj_list<Vertex>& g);
 
-    friend void remove_vertex<>(Vertex v, adj_list<Vertex>& g);
+    friend void remove_vertex<>(vertex_t v, adj_list<Vertex>& g);
 
-    friend void remove_vertex_fast<>(Vertex v, adj_list<Vertex>& g);
+    friend void remove_vertex_fast<>(vertex_t v, adj_list<Vertex>& g);
 
     friend std::pair<edge_descriptor, bool>
-    add_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
+    add_edge<>(vertex_t s, vertex_t t, adj_list<Vertex>& g);
 
-    friend void remove_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
+    friend void remove_edge<>(vertex_t s, vertex_t t, adj_list<Vertex>& g);
 
     friend void remove_edge<>(const edge_descriptor& e, adj_list<Vertex>& g);
 };
@@ -405,8 +562,10 @@ struct graph_traits<adj_list<Vertex> >
     typedef allow_parallel_edge_tag edge_parallel_category;
     typedef adj_list_traversal_tag traversal_category;
 
-    typedef Vertex vertices_size_type;
-    typedef Vertex edges_size_type;
+    // these match the return types of num_vertices() and num_edges(), which
+    // some BGL algorithms (e.g. make_biconnected_planar()) rely on
+    typedef size_t vertices_size_type;
+    typedef size_t edges_size_type;
     typedef size_t degree_size_type;
 
     static Vertex null_vertex() { return adj_list<Vertex>::null_vertex(); }
@@ -455,7 +614,7 @@ std::pair<typename adj_list<Vertex>::vertex_iterator,
 vertices(const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::vertex_iterator vi_t;
-    return std::make_pair(vi_t(0), vi_t(g._out_edges.size()));
+    return std::make_pair(vi_t(0), vi_t(num_vertices(g)));
 }
 
 
@@ -465,22 +624,8 @@ std::pair<typename adj_list<Vertex>::edge_iterator,
           typename adj_list<Vertex>::edge_iterator>
 edges(const adj_list<Vertex>& g)
 {
-    typedef typename adj_list<Vertex>::edge_list_t::const_iterator ei_t;
-    typedef typename adj_list<Vertex>::vertex_list_t::const_iterator vi_t;
-    ei_t ei_begin = g._out_edges.empty() ? ei_t() : g._out_edges[0].begin();
-    vi_t last_vi = g._out_edges.end();
-    if (!g._out_edges.empty())
-        --last_vi;
-    ei_t ei_end = g._out_edges.empty() ? ei_t() : last_vi->end();
-    typename adj_list<Vertex>::edge_iterator ebegin(g._out_edges.begin(),
-                                                    g._out_edges.end(),
-                                                    g._out_edges.begin(),
-                                                    ei_begin);
-    typename adj_list<Vertex>::edge_iterator eend(g._out_edges.begin(),
-                                                  g._out_edges.end(),
-                                                  last_vi,
-                                                  ei_end);
-    return std::make_pair(ebegin, eend);
+    typedef typename adj_list<Vertex>::edge_iterator ei_t;
+    return std::make_pair(ei_t(g, 0), ei_t(g, num_vertices(g)));
 }
 
 template <class Vertex>
@@ -493,13 +638,14 @@ Vertex vertex(size_t i, const adj_list<Vertex>&)
 template <class Vertex>
 inline __attribute__((always_inline))
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-edge(Vertex s, Vertex t, const adj_list<Vertex>& g)
+edge(typename adj_list<Vertex>::vertex_t s,
+     typename adj_list<Vertex>::vertex_t t, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
-    const auto& oes = g._out_edges[s];
-    for (size_t i = 0; i < oes.size(); ++i)
-        if (oes[i].first == t)
-            return std::make_pair(edge_descriptor(s, t, oes[i].second,
+    auto oes = g.get_out_list(s);
+    for (auto iter = oes.first; iter != oes.second; ++iter)
+        if (iter->first == t)
+            return std::make_pair(edge_descriptor(s, t, iter->second,
                                                   false),
                                   true);
     Vertex v = graph_traits<adj_list<Vertex> >::null_vertex();
@@ -508,21 +654,28 @@ edge(Vertex s, Vertex t, const adj_list<Vertex>& g)
 
 template <class Vertex>
 inline __attribute__((always_inline))
-size_t out_degree(Vertex v, const adj_list<Vertex>& g)
+size_t out_degree(typename adj_list<Vertex>::vertex_t v,
+                  const adj_list<Vertex>& g)
 {
+    if (g._frozen)
+        return g._out_pos[v + 1] - g._out_pos[v];
     return g._out_edges[v].size();
 }
 
 template <class Vertex>
 inline __attribute__((always_inline))
-size_t in_degree(Vertex v, const adj_list<Vertex>& g)
+size_t in_degree(typename adj_list<Vertex>::vertex_t v,
+                 const adj_list<Vertex>& g)
 {
+    if (g._frozen)
+        return g._in_pos[v + 1] - g._in_pos[v];
     return g._in_edges[v].size();
 }
 
 template <class Vertex>
 inline __attribute__((always_inline))
-size_t degree(Vertex v, const adj_list<Vertex>& g)
+size_t degree(typename adj_list<Vertex>::vertex_t v,
+              const adj_list<Vertex>& g)
 {
     return in_degree(v, g) + out_degree(v, g);
 }
@@ -531,41 +684,48 @@ template <class Vertex>
 inline __attribute__((always_inline))
 std::pair<typename adj_list<Vertex>::out_edge_iterator,
           typename adj_list<Vertex>::out_edge_iterator>
-out_edges(Vertex v, const adj_list<Vertex>& g)
+out_edges(typename adj_list<Vertex>::vertex_t v,
+          const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::out_edge_iterator ei_t;
     typedef typename adj_list<Vertex>::make_out_edge mk_edge;
-    return std::make_pair(ei_t(g._out_edges[v].begin(), mk_edge(v)),
-                          ei_t(g._out_edges[v].end(), mk_edge(v)));
+    auto oes = g.get_out_list(v);
+    return std::make_pair(ei_t(oes.first, mk_edge(v)),
+                          ei_t(oes.second, mk_edge(v)));
 }
 
 template <class Vertex>
 inline __attribute__((always_inline))
 std::pair<typename adj_list<Vertex>::in_edge_iterator,
           typename adj_list<Vertex>::in_edge_iterator>
-in_edges(Vertex v, const adj_list<Vertex>& g)
+in_edges(typename adj_list<Vertex>::vertex_t v,
+         const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::in_edge_iterator ei_t;
     typedef typename adj_list<Vertex>::make_in_edge mk_edge;
-    return std::make_pair(ei_t(g._in_edges[v].begin(), mk_edge(v)),
-                          ei_t(g._in_edges[v].end(), mk_edge(v)));
+    auto ies = g.get_in_list(v);
+    return std::make_pair(ei_t(ies.first, mk_edge(v)),
+                          ei_t(ies.second, mk_edge(v)));
 }
 
 template <class Vertex>
 inline __attribute__((always_inline))
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-adjacent_vertices(Vertex v, const adj_list<Vertex>& g)
+adjacent_vertices(typename adj_list<Vertex>::vertex_t v,
+                  const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::adjacency_iterator ai_t;
-    return std::make_pair(ai_t(g._out_edges[v].begin()),
-                          ai_t(g._out_edges[v].end()));
+    auto oes = g.get_out_list(v);
+    return std::make_pair(ai_t(oes.first), ai_t(oes.second));
 }
 
 template <class Vertex>
 inline __attribute__((always_inline))
 size_t num_vertices(const adj_list<Vertex>& g)
 {
+    if (g._frozen)
+        return g._out_pos.size() - 1;
     return g._out_edges.size();
 }
 
@@ -580,15 +740,21 @@ template <class Vertex>
 inline __attribute__((always_inline))
 Vertex add_vertex(adj_list<Vertex>& g)
 {
+    g.thaw();
     size_t n = g._out_edges.size();
+    if (n >= size_t(g.null_vertex()))
+        throw std::overflow_error("maximum number of vertices exceeded for "
+                                  "the index type");
     g._out_edges.resize(n + 1);
     g._in_edges.resize(n + 1);
     return n;
 }
 
 template <class Vertex>
-inline void clear_vertex(Vertex v, adj_list<Vertex>& g)
+inline void clear_vertex(typename adj_list<Vertex>::vertex_t v,
+                         adj_list<Vertex>& g)
 {
+    g.thaw();
     if (!g._keep_epos)
     {
         auto& oes = g._out_edges[v];
@@ -663,9 +829,10 @@ inline void clear_vertex(Vertex v, adj_list<Vertex>& g)
 
 // O(V + E)
 template <class Vertex>
-inline void remove_vertex(Vertex v, adj_list<Vertex>& g)
+inline void remove_vertex(typename adj_list<Vertex>::vertex_t v,
+                          adj_list<Vertex>& g)
 {
-    clear_vertex(v, g);
+    clear_vertex(v, g); // also thaws the graph
     g._out_edges.erase(g._out_edges.begin() + v);
     g._in_edges.erase(g._in_edges.begin() + v);
 
@@ -694,9 +861,10 @@ inline void remove_vertex(Vertex v, adj_list<Vertex>& g)
 
 // O(k + k_last)
 template <class Vertex>
-inline void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
+inline void remove_vertex_fast(typename adj_list<Vertex>::vertex_t v,
+                               adj_list<Vertex>& g)
 {
-    clear_vertex(v, g);
+    clear_vertex(v, g); // also thaws the graph
     Vertex back = g._out_edges.size() - 1;
 
     if (v < back)
@@ -751,11 +919,16 @@ inline void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
 
 template <class Vertex>
 inline typename std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
+add_edge(typename adj_list<Vertex>::vertex_t s,
+         typename adj_list<Vertex>::vertex_t t, adj_list<Vertex>& g)
 {
+    g.thaw();
     Vertex idx;
     if (g._free_indexes.empty())
     {
+        if (g._last_idx >= size_t(g.null_vertex()))
+            throw std::overflow_error("maximum number of edges exceeded for "
+                                      "the index type");
         idx = g._last_idx++;
     }
     else
@@ -781,9 +954,11 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
 }
 
 template <class Vertex>
-inline void remove_edge(Vertex s, Vertex t,
+inline void remove_edge(typename adj_list<Vertex>::vertex_t s,
+                        typename adj_list<Vertex>::vertex_t t,
                         adj_list<Vertex>& g)
 {
+    g.thaw();
     if (!g._keep_epos)
     {
         auto& oes = g._out_edges[s];
@@ -814,6 +989,7 @@ template <class Vertex>
 inline void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
                         adj_list<Vertex>& g)
 {
+    g.thaw();
     auto& s = e.s;
     auto& t = e.t;
     auto& idx = e.idx;
@@ -892,29 +1068,29 @@ Vertex target(const typename adj_list<Vertex>::edge_descriptor& e,
 template <class Vertex>
 struct property_map<adj_list<Vertex>, vertex_index_t>
 {
-    typedef identity_property_map type;
+    typedef typed_identity_property_map<Vertex> type;
     typedef type const_type;
 };
 
 template <class Vertex>
 struct property_map<const adj_list<Vertex>, vertex_index_t>
 {
-    typedef identity_property_map type;
+    typedef typed_identity_property_map<Vertex> type;
     typedef type const_type;
 };
 
 template <class Vertex>
-inline identity_property_map
+inline typed_identity_property_map<Vertex>
 get(vertex_index_t, adj_list<Vertex>&)
 {
-    return identity_property_map();
+    return typed_identity_property_map<Vertex>();
 }
 
 template <class Vertex>
-inline identity_property_map
+inline typed_identity_property_map<Vertex>
 get(vertex_index_t, const adj_list<Vertex>&)
 {
-    return identity_property_map();
+    return typed_identity_property_map<Vertex>();
 }
 
 struct get_edge_index
@@ -355,6 +355,11 @@ boost::python::list get_property_types()
     return plist;
 }
 
+size_t get_index_bits()
+{
+    return sizeof(GraphInterface::vertex_t) * 8;
+}
+
 struct graph_type_name
 {
     typedef void result_type;
@@ -413,6 +418,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
     // random numbers
     class_<rng_t>("rng_t");
     def("get_rng", get_rng);
+    def("clear_parallel_rng", &parallel_rng::clear);
 
     register_exception_translator<GraphException>
         (graph_exception_translator<GraphException>);
@@ -427,6 +433,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("empty", &boost::any::empty);
 
     def("graph_filtering_enabled", &graph_filtering_enabled);
+    def("get_index_bits", &get_index_bits);
     export_openmp();
 
     boost::mpl::for_each<boost::mpl::push_back<scalar_types,string>::type>(export_vector_types());
@@ -442,6 +449,8 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("GetReversed", &GraphInterface::GetReversed)
         .def("SetKeepEpos", &GraphInterface::SetKeepEpos)
         .def("GetKeepEpos", &GraphInterface::GetKeepEpos)
+        .def("SetFrozen", &GraphInterface::SetFrozen)
+        .def("GetFrozen", &GraphInterface::GetFrozen)
         .def("SetVertexFilterProperty",
              &GraphInterface::SetVertexFilterProperty)
         .def("IsVertexFilterActive", &GraphInterface::IsVertexFilterActive)
@@ -455,6 +464,8 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("ReIndexVertexProperty",  &GraphInterface::ReIndexVertexProperty)
         .def("WriteToFile", &GraphInterface::WriteToFile)
         .def("ReadFromFile",&GraphInterface::ReadFromFile)
+        .def("ReadDeferredProperty",&GraphInterface::ReadDeferredProperty)
+        .def("ReadEdgeList",&GraphInterface::ReadEdgeList)
         .def("DegreeMap", &GraphInterface::DegreeMap)
         .def("Clear", &GraphInterface::Clear)
         .def("ClearEdges", &GraphInterface::ClearEdges)
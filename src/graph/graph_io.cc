@@ -18,12 +18,14 @@
 #include <boost/python/extract.hpp>
 
 #include <iostream>
+#include <sys/stat.h>
 #include <boost/iostreams/categories.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/graph/graphml.hpp>
 #include <boost/graph/graphviz.hpp>
 #include <boost/lexical_cast.hpp>
@@ -82,6 +84,8 @@ python::object lexical_cast<python::object,string>(const string& ps)
 }
 
 #include "graph_io_binary.hh"
+#include "graph_io_gzip.hh"
+#include "graph_io_edge_list.hh"
 
 // the following source & sink provide iostream access to python file-like
 // objects
@@ -341,12 +345,67 @@ void build_stream(boost::iostreams::filtering_stream<boost::iostreams::input>& s
 }
 
 
+// returns true if the file can be memory-mapped, i.e. if it is an uncompressed
+// regular file
+bool is_mappable(const string& file, boost::python::object& pfile)
+{
+    if (file == "-" || pfile != boost::python::object())
+        return false;
+    if (boost::ends_with(file, ".gz") || boost::ends_with(file, ".bz2"))
+        return false;
+    struct stat st;
+    if (stat(file.c_str(), &st) != 0)
+        return false;
+    return S_ISREG(st.st_mode) && st.st_size > 0;
+}
+
+// if the file is a gzip file written in independent blocks (see
+// graph_io_gzip.hh), open it with src and return true
+bool open_blocked_gzip(const string& file, boost::python::object& pfile,
+                       blocked_gzip_source& src)
+{
+    if (file == "-" || pfile != boost::python::object() ||
+        !boost::ends_with(file, ".gz"))
+        return false;
+    struct stat st;
+    if (stat(file.c_str(), &st) != 0 || !S_ISREG(st.st_mode) ||
+        st.st_size == 0)
+        return false;
+    return src.open(file);
+}
+
+// identifies the version of a file on disk, to detect if it was rewritten:
+// size, inode, and modification time with nanosecond resolution
+struct file_stamp
+{
+    uint64_t size = 0;
+    uint64_t ino = 0;
+    int64_t mtime = 0;
+
+    bool get(const string& file)
+    {
+        struct stat st;
+        if (stat(file.c_str(), &st) != 0)
+            return false;
+        size = st.st_size;
+        ino = st.st_ino;
+        mtime = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        return true;
+    }
+
+    bool operator==(const file_stamp& o) const
+    {
+        return size == o.size && ino == o.ino && mtime == o.mtime;
+    }
+};
+
 boost::python::tuple GraphInterface::ReadFromFile(string file,
                                                   boost::python::object pfile,
                                                   string format,
                                                   boost::python::list ignore_vp,
                                                   boost::python::list ignore_ep,
-                                                  boost::python::list ignore_gp)
+                                                  boost::python::list ignore_gp,
+                                                  bool lazy)
 {
     if (format != "gt" && format != "dot" && format != "xml" && format != "gml")
         throw ValueException("error reading from file '" + file +
@@ -356,7 +415,17 @@ boost::python::tuple GraphInterface::ReadFromFile(string file,
         boost::iostreams::filtering_stream<boost::iostreams::input>
             stream;
         std::ifstream file_stream;
-        build_stream(stream, file, pfile, file_stream);
+        bool mapped = (format == "gt") && is_mappable(file, pfile);
+        blocked_gzip_source gz_src;
+        if (!mapped && open_blocked_gzip(file, pfile, gz_src))
+        {
+            stream.push(gz_src);
+            stream.exceptions(ios_base::badbit);
+        }
+        else if (!mapped)
+        {
+            build_stream(stream, file, pfile, file_stream);
+        }
 
         std::unordered_set<std::string> ivp, iep, igp;
         for (int i = 0; i < len(ignore_vp); ++i)
@@ -382,12 +451,43 @@ boost::python::tuple GraphInterface::ReadFromFile(string file,
 
 
         boost::python::dict vprops, eprops, gprops;
+        boost::python::list dprops;
         if (format == "gt")
         {
             vector<pair<string, boost::any>> agprops, avprops, aeprops;
-            stream.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
-            _directed = read_graph(stream, *_mg, agprops, avprops, aeprops, igp,
-                                   ivp, iep);
+            if (mapped)
+            {
+                // uncompressed files are decoded directly from memory
+                boost::iostreams::mapped_file_source mfile(file);
+                mapped_istream mstream(mfile.data(), mfile.size());
+                vector<deferred_property> deferred;
+                _directed = read_graph(mstream, *_mg, agprops, avprops,
+                                       aeprops, igp, ivp, iep,
+                                       lazy ? &deferred : nullptr);
+
+                // the file's stamp is kept, to detect if it changes before
+                // the deferred properties are read
+                file_stamp fs;
+                fs.get(file);
+                for (auto& p : deferred)
+                {
+                    string key = (p.key == property_type::Vertex) ? "v" : "e";
+                    boost::python::tuple state =
+                        boost::python::make_tuple(p.val, p.big_endian, p.n,
+                                                  p.offset,
+                                                  fs.size, fs.ino, fs.mtime);
+                    dprops.append(boost::python::make_tuple(key, p.name,
+                                                            type_names[p.val],
+                                                            state));
+                }
+            }
+            else
+            {
+                stream.exceptions(ios_base::badbit | ios_base::failbit |
+                                  ios_base::eofbit);
+                _directed = read_graph(stream, *_mg, agprops, avprops, aeprops,
+                                       igp, ivp, iep);
+            }
             for (auto& p : agprops)
                 gprops[p.first] = find_property_map(p.second, _graph_index);
             for (auto& p : avprops)
@@ -410,7 +510,7 @@ boost::python::tuple GraphInterface::ReadFromFile(string file,
                                                             _graph_index);
             }
         }
-        return boost::python::make_tuple(vprops, eprops, gprops);
+        return boost::python::make_tuple(vprops, eprops, gprops, dprops);
     }
     catch (ios_base::failure &e)
     {
@@ -426,6 +526,188 @@ boost::python::tuple GraphInterface::ReadFromFile(string file,
     }
 };
 
+//==============================================================================
+// ReadDeferredProperty(file, key, state)
+//==============================================================================
+
+boost::python::object
+GraphInterface::ReadDeferredProperty(string file, string key,
+                                     boost::python::tuple state)
+{
+    deferred_property p;
+    p.key = (key == "v") ? property_type::Vertex : property_type::Edge;
+    p.val = boost::python::extract<uint8_t>(state[0]);
+    p.big_endian = boost::python::extract<bool>(state[1]);
+    p.n = boost::python::extract<size_t>(state[2]);
+    p.offset = boost::python::extract<size_t>(state[3]);
+    file_stamp fs, cur;
+    fs.size = boost::python::extract<uint64_t>(state[4]);
+    fs.ino = boost::python::extract<uint64_t>(state[5]);
+    fs.mtime = boost::python::extract<int64_t>(state[6]);
+
+    if (!cur.get(file) || !(cur == fs))
+        throw IOException("error reading from file '" + file + "': the file "
+                          "has changed since the graph was loaded");
+    try
+    {
+        boost::iostreams::mapped_file_source mfile(file);
+        boost::any prop = read_deferred_property(*_mg, p, mfile.data(),
+                                                 mfile.size());
+        if (p.key == property_type::Vertex)
+            return find_property_map(prop, _vertex_index);
+        else
+            return find_property_map(prop, _edge_index);
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+}
+
+//==============================================================================
+// ReadEdgeList(file, pfile, format, ...)
+//==============================================================================
+
+boost::python::tuple GraphInterface::ReadEdgeList(string file,
+                                                  boost::python::object pfile,
+                                                  string format, string delim,
+                                                  string comment,
+                                                  bool skip_first, bool hashed,
+                                                  boost::python::list eprop_types,
+                                                  bool two_pass)
+{
+    vector<std::shared_ptr<edge_list_column>> cols;
+    for (int i = 0; i < len(eprop_types); ++i)
+    {
+        string type = boost::python::extract<string>(eprop_types[i]);
+        std::shared_ptr<edge_list_column> col;
+        boost::mpl::for_each<edge_list_value_types>
+            (std::bind(make_edge_list_column(), std::placeholders::_1,
+                       _edge_index, std::ref(type), std::ref(col)));
+        if (!col)
+            throw ValueException("invalid edge property type for edge list: "
+                                 + type);
+        cols.push_back(col);
+    }
+
+    if (two_pass && (file == "-" || pfile != boost::python::object()))
+        throw ValueException("two-pass reading requires a file name");
+
+    std::unordered_map<string, size_t> vmap;
+    vector<string> names;
+    try
+    {
+        boost::iostreams::filtering_stream<boost::iostreams::input> stream;
+        std::ifstream file_stream;
+        build_stream(stream, file, pfile, file_stream);
+        edge_list_reader reader(stream, format, delim, comment, skip_first,
+                                hashed, cols.size(), vmap, names);
+
+        *_mg = multigraph_t();
+        if (!two_pass)
+        {
+            // edges are inserted in the order they appear, and are indexed
+            // sequentially
+            size_t E = 0;
+            while (reader.next())
+            {
+                auto& edges = reader.edges();
+                for (auto& e : edges)
+                {
+                    while (max(e.first, e.second) >= num_vertices(*_mg))
+                        add_vertex(*_mg);
+                    add_edge(vertex(e.first, *_mg), vertex(e.second, *_mg),
+                             *_mg);
+                }
+
+                for (auto& col : cols)
+                    col->resize(E + edges.size());
+                put_edge_list_values(reader, cols,
+                                     [&](size_t i) { return E + i; });
+                E += edges.size();
+            }
+        }
+        else
+        {
+            // first pass: count the out-degrees
+            vector<size_t> pos;
+            while (reader.next())
+            {
+                for (auto& e : reader.edges())
+                {
+                    size_t n = max(e.first, e.second) + 1;
+                    if (n > pos.size())
+                        pos.resize(n, 0);
+                    pos[e.first]++;
+                }
+            }
+            if (pos.size() > 0 &&
+                pos.size() - 1 >= size_t(graph_traits<multigraph_t>::null_vertex()))
+                throw IOException("too many vertices for the index type");
+
+            size_t E = 0;
+            for (auto& k : pos)
+            {
+                size_t d = k;
+                k = E;
+                E += d;
+            }
+            pos.push_back(E);
+
+            // second pass: place the edges directly in their CSR positions
+            multigraph_t::edge_list_t csr(E);
+            vector<size_t> next(pos.begin(), pos.end() - 1);
+            vector<size_t> idx;
+            for (auto& col : cols)
+                col->resize(E);
+
+            boost::iostreams::filtering_stream<boost::iostreams::input>
+                stream2;
+            std::ifstream file_stream2;
+            build_stream(stream2, file, pfile, file_stream2);
+            edge_list_reader reader2(stream2, format, delim, comment,
+                                     skip_first, hashed, cols.size(), vmap,
+                                     names);
+            while (reader2.next())
+            {
+                auto& edges = reader2.edges();
+                idx.resize(edges.size());
+                for (size_t j = 0; j < edges.size(); ++j)
+                {
+                    size_t k = next[edges[j].first]++;
+                    csr[k].first = edges[j].second;
+                    idx[j] = k;
+                }
+                put_edge_list_values(reader2, cols,
+                                     [&](size_t i) { return idx[i]; });
+            }
+            _mg->assign_frozen(pos, csr);
+        }
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+
+    boost::python::object vname;
+    if (hashed)
+    {
+        checked_vector_property_map<string, vertex_index_map_t>
+            vprop(_vertex_index);
+        vprop.get_storage().swap(names);
+        boost::any avprop = vprop;
+        vname = find_property_map(avprop, _vertex_index);
+    }
+
+    boost::python::list eprops;
+    for (auto& col : cols)
+    {
+        boost::any aeprop = col->get_map();
+        eprops.append(find_property_map(aeprop, _edge_index));
+    }
+    return boost::python::make_tuple(vname, eprops);
+}
+
 template <class IndexMap>
 string graphviz_insert_index(dynamic_properties& dp, IndexMap index_map,
                              bool insert = true)
@@ -527,7 +809,7 @@ void GraphInterface::WriteToFile(string file, boost::python::object pfile,
                                  std::ios_base::binary);
                 file_stream.exceptions(ios_base::badbit | ios_base::failbit);
                 if (boost::ends_with(file,".gz"))
-                    stream.push(boost::iostreams::gzip_compressor());
+                    stream.push(blocked_gzip_compressor());
                 if (boost::ends_with(file,".bz2"))
                     stream.push(boost::iostreams::bzip2_compressor());
                 stream.push(file_stream);
@@ -565,7 +847,7 @@ void GraphInterface::WriteToFile(string file, boost::python::object pfile,
             if (IsVertexFilterActive())
             {
                 // vertex indexes must be between the [0, HardNumVertices(g)] range
-                vector_property_map<size_t> index_map(_vertex_index);
+                vector_property_map<size_t, vertex_index_map_t> index_map(_vertex_index);
                 run_action<>()(*this, std::bind(generate_index(),
                                                 std::placeholders::_1,
                                                 index_map))();
@@ -610,7 +892,7 @@ void GraphInterface::WriteToFile(string file, boost::python::object pfile,
             if (IsVertexFilterActive())
             {
                 // vertex indexes must be between the [0, HardNumVertices(g)] range
-                vector_property_map<size_t> index_map(_vertex_index);
+                vector_property_map<size_t, vertex_index_map_t> index_map(_vertex_index);
                 run_action<>()(*this, boost::bind<void>(generate_index(),
                                                         _1, index_map))();
                 if (format == "dot")
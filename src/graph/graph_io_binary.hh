@@ -19,6 +19,7 @@
 #define GRAPH_IO_BINARY_HH
 
 #include <iostream>
+#include <cstring>
 #include "graph.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
@@ -87,21 +88,65 @@ void write(std::ostream& s, const boost::python::object& v)
 };
 
 
-template <bool BE, typename T>
-void read(std::istream& s, T& v)
+// Memory-mapped input
+// -------------------
+//
+// Uncompressed files are read directly from a read-only memory mapping. The
+// class below has the subset of the std::istream interface used by the
+// functions below, which are templated on the stream type. Since the data can
+// be accessed randomly, the adjacency can be decoded in parallel.
+
+class mapped_istream
+{
+public:
+    mapped_istream(const char* data, size_t size)
+        : _data(data), _pos(0), _size(size) {}
+
+    void read(char* buf, size_t n)
+    {
+        check(n);
+        memcpy(buf, _data + _pos, n);
+        _pos += n;
+    }
+
+    void ignore(size_t n)
+    {
+        check(n);
+        _pos += n;
+    }
+
+    // pointer to the current position
+    const char* get() const { return _data + _pos; }
+
+    size_t tellg() const { return _pos; }
+
+    void check(size_t n) const
+    {
+        if (n > _size - _pos)
+            throw IOException("error reading graph: unexpected end of file");
+    }
+
+private:
+    const char* _data;
+    size_t _pos;
+    size_t _size;
+};
+
+template <bool BE, class Stream, typename T>
+void read(Stream& s, T& v)
 {
     s.read(reinterpret_cast<char*>(&v), sizeof(T));
     byte_swap<BE>(v);
 };
 
-template <bool BE, typename T>
-void skip(std::istream& s, const T&)
+template <bool BE, class Stream, typename T>
+void skip(Stream& s, const T&)
 {
     s.ignore(sizeof(T));
 };
 
-template <bool BE, typename T>
-void read(std::istream& s, std::vector<T>& v)
+template <bool BE, class Stream, typename T>
+void read(Stream& s, std::vector<T>& v)
 {
     uint64_t size = 0;
     read<BE>(s, size);
@@ -113,16 +158,16 @@ void read(std::istream& s, std::vector<T>& v)
         byte_swap<BE>(x);
 };
 
-template <bool BE, typename T>
-void skip(std::istream& s, const std::vector<T>&)
+template <bool BE, class Stream, typename T>
+void skip(Stream& s, const std::vector<T>&)
 {
     uint64_t size = 0;
     read<BE>(s, size);
     s.ignore(sizeof(T) * size);
 };
 
-template <bool BE>
-void read(std::istream& s, std::string& v)
+template <bool BE, class Stream>
+void read(Stream& s, std::string& v)
 {
     uint64_t size = 0;
     read<BE>(s, size);
@@ -131,8 +176,8 @@ void read(std::istream& s, std::string& v)
 };
 
 
-template <bool BE>
-void read(std::istream& s, std::vector<std::string>& v)
+template <bool BE, class Stream>
+void read(Stream& s, std::vector<std::string>& v)
 {
     uint64_t size = 0;
     read<BE>(s, size);
@@ -142,16 +187,25 @@ void read(std::istream& s, std::vector<std::string>& v)
         read<BE>(s, x);
 };
 
-template <bool BE>
-void skip(std::istream& s, const std::string&)
+template <bool BE, class Stream>
+void skip(Stream& s, const std::string&)
 {
     uint64_t size = 0;
     read<BE>(s, size);
     s.ignore(size);
 };
 
-template <bool BE>
-void read(std::istream& s, boost::python::object& v)
+template <bool BE, class Stream>
+void skip(Stream& s, const std::vector<std::string>&)
+{
+    uint64_t size = 0;
+    read<BE>(s, size);
+    for (size_t i = 0; i < size; ++i)
+        skip<BE>(s, std::string());
+};
+
+template <bool BE, class Stream>
+void read(Stream& s, boost::python::object& v)
 {
     std::string buf;
     read<BE>(s, buf);
@@ -159,8 +213,8 @@ void read(std::istream& s, boost::python::object& v)
 };
 
 
-template <bool BE>
-void skip(std::istream& s, const boost::python::object&)
+template <bool BE, class Stream>
+void skip(Stream& s, const boost::python::object&)
 {
     skip<BE>(s, std::string());
 };
@@ -198,27 +252,76 @@ void write_adjacency(Graph& g, const VProp& vindex, uint64_t N,
         write_adjacency_dispatch<uint64_t>(g, vindex, s);
 }
 
-template <bool BE, class Vint, class Graph>
-void read_adjacency_dispatch(Graph& g, size_t N, std::istream& s)
-{
-    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+// The adjacency is read directly into the frozen (CSR) storage of the graph,
+// with the edges indexed sequentially, in the same order as they were written.
 
-    for (vertex_t v = 0; v < N; ++v)
+template <bool BE, class Vint, class Stream, class EdgeList>
+void read_adjacency_dispatch(size_t N, std::vector<size_t>& pos,
+                             EdgeList& csr, Stream& s)
+{
+    pos.resize(N + 1);
+    pos[0] = 0;
+    std::vector<Vint> us;
+    for (size_t v = 0; v < N; ++v)
     {
-        std::vector<Vint> us;
         read<BE>(s, us);
-        for (vertex_t u : us)
+        pos[v + 1] = pos[v] + us.size();
+        for (Vint u : us)
         {
             if (u >= N)
                 throw IOException("error reading graph: vertex index not in range");
-            add_edge(v, u, g);
+            csr.emplace_back(u, 0);
+        }
+    }
+}
+
+// if the file is memory-mapped, the list sizes are collected first, and the
+// lists themselves are decoded in parallel
+template <bool BE, class Vint, class EdgeList>
+void read_adjacency_dispatch(size_t N, std::vector<size_t>& pos,
+                             EdgeList& csr, mapped_istream& s)
+{
+    const char* base = s.get();
+    pos.resize(N + 1);
+    pos[0] = 0;
+    for (size_t v = 0; v < N; ++v)
+    {
+        uint64_t k = 0;
+        read<BE>(s, k);
+        if (k > (std::numeric_limits<uint64_t>::max() - pos[v]) / sizeof(Vint))
+            throw IOException("error reading graph: invalid edge list size");
+        s.ignore(sizeof(Vint) * k);
+        pos[v + 1] = pos[v] + k;
+    }
+
+    size_t E = pos[N];
+    csr.resize(E);
+    bool valid = true;
+    int v;
+    #pragma omp parallel for default(shared) private(v) \
+        schedule(runtime) if (N > 100)
+    for (v = 0; v < int(N); ++v)
+    {
+        const char* us = base + sizeof(uint64_t) * (v + 1) +
+            sizeof(Vint) * pos[v];
+        for (size_t i = pos[v]; i < pos[v + 1]; ++i)
+        {
+            Vint u;
+            memcpy(&u, us, sizeof(Vint));
+            byte_swap<BE>(u);
+            us += sizeof(Vint);
+            if (u >= N)
+                valid = false;
+            csr[i].first = u;
         }
     }
+    if (!valid)
+        throw IOException("error reading graph: vertex index not in range");
 }
 
 
-template <bool BE, class Graph>
-bool read_adjacency(Graph& g, std::istream& s)
+template <bool BE, class Graph, class Stream>
+bool read_adjacency(Graph& g, Stream& s)
 {
     uint8_t directed = false;
     read<BE>(s, directed);
@@ -226,18 +329,26 @@ bool read_adjacency(Graph& g, std::istream& s)
     uint64_t N = 0;
     read<BE>(s, N);
 
-    for (size_t i = 0; i < N; ++i)
-        add_vertex(g);
+    if (N >= size_t(graph_traits<Graph>::null_vertex()))
+        throw IOException("error reading graph: number of vertices exceeds "
+                          "the range of the index type");
 
+    typename Graph::edge_list_t csr;
+    std::vector<size_t> pos;
     if (N <= numeric_limits<uint8_t>::max())
-        read_adjacency_dispatch<BE, uint8_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint8_t>(N, pos, csr, s);
     else if (N <= numeric_limits<uint16_t>::max())
-        read_adjacency_dispatch<BE, uint16_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint16_t>(N, pos, csr, s);
     else if (N <= numeric_limits<uint32_t>::max())
-        read_adjacency_dispatch<BE, uint32_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint32_t>(N, pos, csr, s);
     else
-        read_adjacency_dispatch<BE, uint64_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint64_t>(N, pos, csr, s);
 
+    if (csr.size() >= size_t(graph_traits<Graph>::null_vertex()))
+        throw IOException("error reading graph: number of edges exceeds "
+                          "the range of the index type");
+
+    g.assign_frozen(pos, csr);
     return directed;
 }
 
@@ -271,6 +382,9 @@ struct graph_range_traits
     template <class Graph>
     static graph_range get_range(Graph&) { return graph_range(); }
 
+    template <class Graph>
+    static size_t get_size(Graph&) { return 1; }
+
     static property_type get_property_id() { return property_type::Graph; }
 };
 
@@ -285,6 +399,9 @@ struct vertex_range_traits
     IterRange<typename boost::graph_traits<Graph>::vertex_iterator>
     static get_range(Graph& g) { return vertices_range(g); }
 
+    template <class Graph>
+    static size_t get_size(Graph& g) { return num_vertices(g); }
+
     static property_type get_property_id() { return property_type::Vertex; }
 };
 
@@ -299,6 +416,9 @@ struct edge_range_traits
     IterRange<typename boost::graph_traits<Graph>::edge_iterator>
     static get_range(Graph& g) { return edges_range(g); }
 
+    template <class Graph>
+    static size_t get_size(Graph& g) { return num_edges(g); }
+
     static property_type get_property_id() { return property_type::Edge; }
 };
 
@@ -383,42 +503,88 @@ void write_property(Graph& g, std::string& name, boost::any& prop, std::ostream&
 }
 
 
+// Since the graph was just read, the vertices and edges are iterated in the
+// order of their indexes, and hence the values can be read directly into the
+// property map storage, in bulk for scalar properties (which are then also
+// skipped in O(1) when ignored).
+
 template <bool BE, class RangeTraits>
 struct read_property_dispatch
 {
-    template <class T, class Graph>
-    void operator()(T, Graph& g, boost::any& aprop, uint8_t val, bool ignore,
-                    bool& found, std::istream& s) const
+    template <class T, class Stream>
+    void operator()(T, typename RangeTraits::index_map_t index,
+                    boost::any& aprop, uint8_t val, size_t n, bool ignore,
+                    bool& found, Stream& s) const
     {
         typedef typename mpl::find<val_types, T>::type pos;
         if (mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value == val)
         {
             typedef typename property_map_type::apply<T, typename RangeTraits::index_map_t>::type pmap_t;
-            pmap_t prop(RangeTraits::get_index_map(g));
+            typename std::is_arithmetic<T>::type is_scalar;
             if (!ignore)
             {
-                for (auto x : RangeTraits::get_range(g))
-                    read<BE>(s, prop[x]);
+                pmap_t prop(index);
+                read_values(prop, n, s, is_scalar);
                 aprop = prop;
             }
             else
             {
-                T y;
-                for (auto x : RangeTraits::get_range(g))
-                {
-                    (void)x;
-                    skip<BE>(s, y);
-                }
+                skip_values(T(), n, s, is_scalar);
             }
             found = true;
         }
     }
+
+    template <class PMap, class Stream>
+    void read_values(PMap& prop, size_t n, Stream& s, std::true_type) const
+    {
+        auto& vals = prop.get_storage();
+        vals.resize(n);
+        s.read(reinterpret_cast<char*>(vals.data()),
+               sizeof(typename PMap::value_type) * vals.size());
+        for (auto& x : vals)
+            byte_swap<BE>(x);
+    }
+
+    template <class PMap, class Stream>
+    void read_values(PMap& prop, size_t n, Stream& s, std::false_type) const
+    {
+        auto& vals = prop.get_storage();
+        vals.resize(n);
+        for (auto& x : vals)
+            read<BE>(s, x);
+    }
+
+    template <class T, class Stream>
+    void skip_values(const T&, size_t n, Stream& s, std::true_type) const
+    {
+        s.ignore(sizeof(T) * n);
+    }
+
+    template <class T, class Stream>
+    void skip_values(const T& y, size_t n, Stream& s, std::false_type) const
+    {
+        for (size_t i = 0; i < n; ++i)
+            skip<BE>(s, y);
+    }
 };
 
-template <bool BE, class RangeTraits, class Graph>
+// A property map whose values were not read with the rest of the graph, but
+// which can be read later from the same (memory-mapped) file.
+struct deferred_property
+{
+    std::string name;
+    property_type key;
+    uint8_t val;      // value type index
+    bool big_endian;
+    size_t n;         // number of values
+    size_t offset;    // position of the values in the file
+};
+
+template <bool BE, class RangeTraits, class Graph, class Stream>
 std::pair<std::string, boost::any>
 read_property(Graph& g, const std::unordered_set<std::string>& ignore,
-              std::istream& s)
+              Stream& s, std::vector<deferred_property>* deferred = nullptr)
 {
     boost::any prop;
     bool found = false;
@@ -427,16 +593,66 @@ read_property(Graph& g, const std::unordered_set<std::string>& ignore,
     bool skip = ignore.find(name) != ignore.end();
     uint8_t val = 0;
     read<BE>(s, val);
+    size_t n = RangeTraits::get_size(g);
+    if (!skip && deferred != nullptr &&
+        val < mpl::size<value_types>::type::value)
+    {
+        deferred->push_back({name, RangeTraits::get_property_id(), val, BE, n,
+                             size_t(s.tellg())});
+        skip = true;
+    }
     mpl::for_each<val_types>(std::bind(read_property_dispatch<BE, RangeTraits>(),
-                                       std::placeholders::_1, std::ref(g),
-                                       std::ref(prop), val, skip, std::ref(found),
-                                       std::ref(s)));
+                                       std::placeholders::_1,
+                                       RangeTraits::get_index_map(g),
+                                       std::ref(prop), val, n, skip,
+                                       std::ref(found), std::ref(s)));
     if (!found)
         throw IOException("Error reading graph: invalid property value type index "
                           + boost::lexical_cast<std::string>(val));
     return make_pair(name, prop);
 }
 
+template <bool BE, class RangeTraits, class Graph>
+boost::any read_deferred_property(Graph& g, const deferred_property& p,
+                                  mapped_istream& s)
+{
+    boost::any prop;
+    bool found = false;
+    s.ignore(p.offset);
+    mpl::for_each<val_types>(std::bind(read_property_dispatch<BE, RangeTraits>(),
+                                       std::placeholders::_1,
+                                       RangeTraits::get_index_map(g),
+                                       std::ref(prop), p.val, p.n, false,
+                                       std::ref(found), std::ref(s)));
+    if (!found)
+        throw IOException("Error reading graph: invalid property value type index "
+                          + boost::lexical_cast<std::string>(p.val));
+    return prop;
+}
+
+// Reads a property map previously deferred by read_graph(), from the same file
+// contents. The vertex and edge indexes must not have changed in the meantime.
+template <class Graph>
+boost::any read_deferred_property(Graph& g, const deferred_property& p,
+                                  const char* data, size_t size)
+{
+    mapped_istream s(data, size);
+    if (p.key == property_type::Vertex)
+    {
+        if (p.big_endian)
+            return read_deferred_property<true, vertex_range_traits>(g, p, s);
+        else
+            return read_deferred_property<false, vertex_range_traits>(g, p, s);
+    }
+    else
+    {
+        if (p.big_endian)
+            return read_deferred_property<true, edge_range_traits>(g, p, s);
+        else
+            return read_deferred_property<false, edge_range_traits>(g, p, s);
+    }
+}
+
 
 template <class Graph, class VProp>
 void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
@@ -469,7 +685,7 @@ void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
         write_property<edge_range_traits>(g, p.first, p.second, s);
 }
 
-template <bool BE, class Graph>
+template <bool BE, class Graph, class Stream>
 bool read_graph_dispatch(Graph& g,
                          std::vector<std::pair<std::string, boost::any>>& gprops,
                          std::vector<std::pair<std::string, boost::any>>& vprops,
@@ -477,7 +693,8 @@ bool read_graph_dispatch(Graph& g,
                          const std::unordered_set<std::string>& ignore_gp,
                          const std::unordered_set<std::string>& ignore_vp,
                          const std::unordered_set<std::string>& ignore_ep,
-                         std::istream& s)
+                         std::vector<deferred_property>* deferred,
+                         Stream& s)
 {
     bool directed = read_adjacency<BE>(g, s);
     uint64_t nprops;
@@ -495,12 +712,14 @@ bool read_graph_dispatch(Graph& g,
                 gprops.push_back(p);
             break;
         case property_type::Vertex:
-            p = read_property<BE, vertex_range_traits>(g, ignore_vp, s);
+            p = read_property<BE, vertex_range_traits>(g, ignore_vp, s,
+                                                       deferred);
             if (!p.second.empty())
                 vprops.push_back(p);
             break;
         case property_type::Edge:
-            p = read_property<BE, edge_range_traits>(g, ignore_ep, s);
+            p = read_property<BE, edge_range_traits>(g, ignore_ep, s,
+                                                     deferred);
             if (!p.second.empty())
                 eprops.push_back(p);
             break;
@@ -513,14 +732,15 @@ bool read_graph_dispatch(Graph& g,
 }
 
 
-template <class Graph>
-bool read_graph(std::istream& s, Graph& g,
+template <class Stream, class Graph>
+bool read_graph(Stream& s, Graph& g,
                 std::vector<std::pair<std::string, boost::any>>& gprops,
                 std::vector<std::pair<std::string, boost::any>>& vprops,
                 std::vector<std::pair<std::string, boost::any>>& eprops,
                 const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>(),
                 const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
-                const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>())
+                const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>(),
+                std::vector<deferred_property>* deferred = nullptr)
 {
     char magic[_magic_length];
     s.read(magic, _magic_length);
@@ -538,10 +758,10 @@ bool read_graph(std::istream& s, Graph& g,
 
     if (big_end)
         return read_graph_dispatch<true>(g, gprops, vprops, eprops, ignore_gp,
-                                         ignore_vp, ignore_ep, s);
+                                         ignore_vp, ignore_ep, deferred, s);
     else
         return read_graph_dispatch<false>(g, gprops, vprops, eprops, ignore_gp,
-                                          ignore_vp, ignore_ep, s);
+                                          ignore_vp, ignore_ep, deferred, s);
 }
 
 } // namespace graph_tool
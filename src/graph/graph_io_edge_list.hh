@@ -0,0 +1,479 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_IO_EDGE_LIST_HH
+#define GRAPH_IO_EDGE_LIST_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <istream>
+#include <unordered_map>
+#include <boost/lexical_cast.hpp>
+#include <boost/mpl/vector.hpp>
+#include <boost/mpl/find.hpp>
+
+#include "graph_properties.hh"
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+
+// Streaming edge lists
+// --------------------
+//
+// Edge lists are read in chunks of complete lines (or fixed-size records, for
+// binary files), so that the memory used is bounded by the chunk size,
+// independently of the size of the file. Each chunk is split into tokens and
+// parsed in parallel; only the mapping of vertex names to indexes (if
+// required) is done sequentially.
+//
+// Text lines contain the source and target vertices, followed by the values
+// of the edge properties, separated by a single delimiter character (or by
+// any amount of white space, if the delimiter is empty). Quoting is not
+// supported. Binary files contain only pairs of int32_t or int64_t values, in
+// the native byte order.
+
+const size_t _edge_list_chunk_size = 1 << 24;
+
+// a value in the chunk buffer
+struct edge_list_token
+{
+    const char* data;
+    size_t size;
+};
+
+// value types which can be read from edge lists (the scalar types and strings)
+typedef boost::mpl::vector<uint8_t, int16_t, int32_t, int64_t, double,
+                           long double, string> edge_list_value_types;
+
+template <class Value>
+Value parse_edge_list_value(const char* s, size_t n)
+{
+    return boost::lexical_cast<Value>(s, n);
+}
+
+template <>
+inline uint8_t parse_edge_list_value<uint8_t>(const char* s, size_t n)
+{
+    if (n == 4 && strncmp(s, "true", 4) == 0)
+        return 1;
+    if (n == 5 && strncmp(s, "false", 5) == 0)
+        return 0;
+    return boost::lexical_cast<int>(s, n) != 0;
+}
+
+template <>
+inline string parse_edge_list_value<string>(const char* s, size_t n)
+{
+    return string(s, n);
+}
+
+// A column of edge property values. The put() function is called in parallel
+// for different edges, and must therefore touch only the respective entry.
+class edge_list_column
+{
+public:
+    virtual ~edge_list_column() {}
+    virtual void resize(size_t n) = 0;
+    virtual void put(size_t e, const edge_list_token& t) = 0;
+    virtual boost::any get_map() = 0;
+};
+
+template <class Value, class IndexMap>
+class typed_edge_list_column: public edge_list_column
+{
+public:
+    typed_edge_list_column(IndexMap index): _map(index) {}
+
+    virtual void resize(size_t n)
+    {
+        _map.get_storage().resize(n);
+    }
+
+    virtual void put(size_t e, const edge_list_token& t)
+    {
+        _map.get_storage()[e] = parse_edge_list_value<Value>(t.data, t.size);
+    }
+
+    virtual boost::any get_map() { return _map; }
+
+private:
+    checked_vector_property_map<Value, IndexMap> _map;
+};
+
+struct make_edge_list_column
+{
+    template <class Value, class IndexMap>
+    void operator()(Value, IndexMap index, const string& type_name,
+                    std::shared_ptr<edge_list_column>& col) const
+    {
+        size_t i = boost::mpl::find<value_types,Value>::type::pos::value;
+        if (type_name == type_names[i])
+            col = std::make_shared<typed_edge_list_column<Value, IndexMap>>(index);
+    }
+};
+
+// Reads an edge list from a stream, one chunk at a time. After each call of
+// next(), edges() contains the (source, target) pairs in the chunk, and
+// value(i, j) the j-th property value of the i-th edge.
+class edge_list_reader
+{
+public:
+    edge_list_reader(std::istream& s, const string& format,
+                     const string& delim, const string& comment,
+                     bool skip_first, bool hashed, size_t nprops,
+                     std::unordered_map<string, size_t>& vmap,
+                     vector<string>& names,
+                     size_t chunk_size = _edge_list_chunk_size)
+        : _s(s), _delim(delim), _comment(comment), _skip_first(skip_first),
+          _hashed(hashed), _ncols(nprops + 2), _vmap(vmap), _names(names),
+          _chunk_size(chunk_size), _rsize(0), _consumed(0), _line(0)
+    {
+        if (format == "int32")
+            _rsize = 2 * sizeof(int32_t);
+        else if (format == "int64")
+            _rsize = 2 * sizeof(int64_t);
+        else if (format != "text")
+            throw ValueException("invalid edge list format: " + format);
+        if (_rsize > 0 && (hashed || nprops > 0))
+            throw ValueException("binary edge lists cannot contain vertex "
+                                 "names or edge properties");
+        if (delim.size() > 1)
+            throw ValueException("the delimiter must be a single character");
+        _chunk_size = std::max(_chunk_size, _rsize);
+    }
+
+    bool next()
+    {
+        if (!read_chunk())
+            return false;
+        if (_rsize > 0)
+            parse_binary();
+        else
+            parse_text();
+        return true;
+    }
+
+    vector<pair<size_t, size_t>>& edges() { return _edges; }
+
+    const edge_list_token& value(size_t i, size_t j) const
+    {
+        return _tokens[i * _ncols + 2 + j];
+    }
+
+    // the line of the i-th edge in the last chunk
+    size_t line(size_t i) const { return _lines[i]; }
+
+private:
+    // Reads the next chunk of complete lines (or records) into the buffer;
+    // returns false if there is nothing left.
+    bool read_chunk()
+    {
+        _buf.erase(_buf.begin(), _buf.begin() + _consumed);
+        _consumed = 0;
+        while (true)
+        {
+            size_t pos = _buf.size();
+            _buf.resize(pos + _chunk_size);
+            _s.read(_buf.data() + pos, _chunk_size);
+            size_t n = _s.gcount();
+            _buf.resize(pos + n);
+            bool eof = n < _chunk_size;
+
+            if (_rsize > 0)
+            {
+                _consumed = _buf.size() - _buf.size() % _rsize;
+                if (eof && _consumed < _buf.size())
+                    throw IOException("truncated binary edge list");
+            }
+            else
+            {
+                for (size_t i = _buf.size(); i > pos; --i)
+                {
+                    if (_buf[i - 1] == '\n')
+                    {
+                        _consumed = i;
+                        break;
+                    }
+                }
+                if (eof)
+                    _consumed = _buf.size();
+            }
+
+            // lines longer than the chunk size make the buffer grow
+            if (_consumed > 0 || eof)
+                break;
+        }
+        return _consumed > 0;
+    }
+
+    void parse_binary()
+    {
+        size_t M = _consumed / _rsize;
+        _edges.resize(M);
+        _lines.resize(M);
+        bool valid = true;
+        int i, N = M;
+        #pragma omp parallel for default(shared) private(i) \
+            schedule(runtime) if (N > 100)
+        for (i = 0; i < N; ++i)
+        {
+            const char* r = _buf.data() + i * _rsize;
+            int64_t s, t;
+            if (_rsize == 2 * sizeof(int32_t))
+            {
+                int32_t x[2];
+                memcpy(x, r, sizeof(x));
+                s = x[0];
+                t = x[1];
+            }
+            else
+            {
+                memcpy(&s, r, sizeof(s));
+                memcpy(&t, r + sizeof(s), sizeof(t));
+            }
+            if (s < 0 || t < 0)
+                valid = false;
+            _edges[i] = make_pair(size_t(s), size_t(t));
+            _lines[i] = _line + i + 1;
+        }
+        if (!valid)
+            throw IOException("negative vertex index in binary edge list");
+        _line += M;
+    }
+
+    void parse_text()
+    {
+        // split lines
+        _starts.clear();
+        const char* buf = _buf.data();
+        const char* end = buf + _consumed;
+        for (const char* p = buf; p < end;)
+        {
+            _starts.push_back(p - buf);
+            const char* nl = (const char*) memchr(p, '\n', end - p);
+            p = (nl == 0) ? end : nl + 1;
+        }
+        _starts.push_back(_consumed);
+
+        // tokenize lines in parallel
+        size_t L = _starts.size() - 1;
+        _tokens.resize(L * _ncols);
+        _status.resize(L);
+        int i, N = L;
+        #pragma omp parallel for default(shared) private(i) \
+            schedule(runtime) if (N > 100)
+        for (i = 0; i < N; ++i)
+            _status[i] = tokenize(buf + _starts[i], buf + _starts[i + 1],
+                                  &_tokens[i * _ncols]);
+
+        // the skipped line is the first one which is not empty or a comment,
+        // which may lie in a later chunk
+        for (size_t i = 0; _skip_first && i < L; ++i)
+        {
+            if (_status[i] != 0)
+            {
+                _status[i] = 0;
+                _skip_first = false;
+            }
+        }
+
+        // compact valid lines
+        size_t M = 0;
+        _lines.clear();
+        for (size_t i = 0; i < L; ++i)
+        {
+            if (_status[i] < 0)
+                throw IOException("error reading edge list: line " +
+                                  boost::lexical_cast<string>(_line + i + 1) +
+                                  " has fewer than " +
+                                  boost::lexical_cast<string>(_ncols) + " columns");
+            if (_status[i] == 0)
+                continue;
+            if (M < i)
+                std::copy(&_tokens[i * _ncols], &_tokens[(i + 1) * _ncols],
+                          &_tokens[M * _ncols]);
+            _lines.push_back(_line + i + 1);
+            M++;
+        }
+        _line += L;
+        _edges.resize(M);
+
+        if (_hashed)
+        {
+            for (size_t i = 0; i < M; ++i)
+            {
+                _edges[i].first = get_vertex(_tokens[i * _ncols]);
+                _edges[i].second = get_vertex(_tokens[i * _ncols + 1]);
+            }
+        }
+        else
+        {
+            size_t bad = std::numeric_limits<size_t>::max();
+            N = M;
+            #pragma omp parallel for default(shared) private(i) \
+                schedule(runtime) if (N > 100)
+            for (i = 0; i < N; ++i)
+            {
+                auto& s = _tokens[i * _ncols];
+                auto& t = _tokens[i * _ncols + 1];
+                if (!parse_index(s, _edges[i].first) ||
+                    !parse_index(t, _edges[i].second))
+                {
+                    #pragma omp critical
+                    bad = std::min(bad, size_t(i));
+                }
+            }
+            if (bad != std::numeric_limits<size_t>::max())
+                throw IOException("error reading edge list: invalid vertex "
+                                  "index in line " +
+                                  boost::lexical_cast<string>(_lines[bad]));
+        }
+    }
+
+    bool is_delim(char c) const
+    {
+        if (_delim.empty())
+            return c == ' ' || c == '\t';
+        return c == _delim[0];
+    }
+
+    // splits the line into _ncols tokens; returns 0 for empty and comment
+    // lines, -1 if there are too few columns, and 1 otherwise
+    int tokenize(const char* p, const char* end, edge_list_token* tokens) const
+    {
+        while (end > p && (end[-1] == '\n' || end[-1] == '\r'))
+            --end;
+        if (p == end)
+            return 0;
+        if (!_comment.empty() && size_t(end - p) >= _comment.size() &&
+            strncmp(p, _comment.c_str(), _comment.size()) == 0)
+            return 0;
+
+        bool ws = _delim.empty();
+        size_t j = 0;
+        while (j < _ncols)
+        {
+            if (ws)
+            {
+                while (p < end && is_delim(*p))
+                    ++p;
+                if (p == end)
+                    break;
+            }
+            const char* q = p;
+            while (q < end && !is_delim(*q))
+                ++q;
+            tokens[j].data = p;
+            tokens[j].size = q - p;
+            ++j;
+            if (q == end)
+                break;
+            p = q + 1;
+        }
+        if (j == 0)
+            return 0;
+        return (j < _ncols) ? -1 : 1;
+    }
+
+    static bool parse_index(const edge_list_token& t, size_t& x)
+    {
+        if (t.size == 0)
+            return false;
+        x = 0;
+        for (size_t i = 0; i < t.size; ++i)
+        {
+            char c = t.data[i];
+            if (c < '0' || c > '9')
+                return false;
+            x = x * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    size_t get_vertex(const edge_list_token& t)
+    {
+        string name(t.data, t.size);
+        auto iter = _vmap.find(name);
+        if (iter != _vmap.end())
+            return iter->second;
+        size_t v = _names.size();
+        _vmap[name] = v;
+        _names.push_back(name);
+        return v;
+    }
+
+    std::istream& _s;
+    string _delim;
+    string _comment;
+    bool _skip_first;
+    bool _hashed;
+    size_t _ncols;
+    std::unordered_map<string, size_t>& _vmap;
+    vector<string>& _names;
+    size_t _chunk_size;
+    size_t _rsize;
+
+    vector<char> _buf;
+    size_t _consumed;
+    size_t _line;
+    vector<size_t> _starts;
+    vector<edge_list_token> _tokens;
+    vector<int> _status;
+    vector<size_t> _lines;
+    vector<pair<size_t, size_t>> _edges;
+};
+
+// Sets the property values of the edges in the last chunk read, in parallel;
+// the i-th edge of the chunk has index eindex(i).
+template <class EdgeIndex>
+void put_edge_list_values(edge_list_reader& reader,
+                          vector<std::shared_ptr<edge_list_column>>& cols,
+                          EdgeIndex eindex)
+{
+    if (cols.empty())
+        return;
+    size_t bad = std::numeric_limits<size_t>::max();
+    int i, N = reader.edges().size();
+    #pragma omp parallel for default(shared) private(i) \
+        schedule(runtime) if (N > 100)
+    for (i = 0; i < N; ++i)
+    {
+        try
+        {
+            for (size_t j = 0; j < cols.size(); ++j)
+                cols[j]->put(eindex(i), reader.value(i, j));
+        }
+        catch (boost::bad_lexical_cast&)
+        {
+            #pragma omp critical
+            bad = std::min(bad, size_t(i));
+        }
+    }
+    if (bad != std::numeric_limits<size_t>::max())
+        throw IOException("error reading edge list: invalid property value "
+                          "in line " +
+                          boost::lexical_cast<string>(reader.line(bad)));
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_IO_EDGE_LIST_HH
@@ -0,0 +1,346 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_IO_GZIP_HH
+#define GRAPH_IO_GZIP_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <boost/crc.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/operations.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "graph_exceptions.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+// Blocked gzip files
+// ------------------
+//
+// Compressed files are written as a sequence of independent gzip members
+// ("blocks"), each holding at most _gz_block_size bytes of uncompressed
+// data. Since a concatenation of gzip members is itself a valid gzip file, the
+// result can be read by any gzip-capable tool. The header of each member
+// contains an extra field (with subfield id "GT") holding the total compressed
+// size of the member, so that the blocks can be located without decompressing
+// them. This allows both compression and decompression to be done in parallel
+// (this is the same idea as the BGZF format, with larger blocks).
+
+const size_t _gz_block_size = 1 << 20;
+const size_t _gz_header_size = 20;  // 10 (fixed) + 2 (XLEN) + 8 (subfield)
+const size_t _gz_trailer_size = 8;  // CRC32 + ISIZE
+
+inline void gz_put_uint(std::string& buf, uint32_t x, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+        buf.push_back(char((x >> (8 * i)) & 0xff));
+}
+
+inline uint32_t gz_get_uint(const char* buf, size_t bytes)
+{
+    uint32_t x = 0;
+    for (size_t i = 0; i < bytes; ++i)
+        x |= uint32_t(uint8_t(buf[i])) << (8 * i);
+    return x;
+}
+
+// compress a single block into a gzip member
+inline void gz_compress_block(const char* data, size_t size, std::string& out)
+{
+    std::string deflated;
+    {
+        boost::iostreams::zlib_params params;
+        params.noheader = true; // raw deflate stream
+        boost::iostreams::filtering_ostream s;
+        s.push(boost::iostreams::zlib_compressor(params));
+        s.push(boost::iostreams::back_inserter(deflated));
+        s.write(data, size);
+    }
+
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+
+    out.clear();
+    out.reserve(_gz_header_size + deflated.size() + _gz_trailer_size);
+    const char header[] = {'\x1f', '\x8b', // magic
+                           '\x08',         // deflate
+                           '\x04',         // FEXTRA
+                           0, 0, 0, 0,     // MTIME
+                           0,              // XFL
+                           '\xff'};        // OS (unknown)
+    out.append(header, sizeof(header));
+    gz_put_uint(out, 8, 2);                // XLEN
+    out.push_back('G');
+    out.push_back('T');
+    gz_put_uint(out, 4, 2);                // subfield length
+    gz_put_uint(out, _gz_header_size + deflated.size() + _gz_trailer_size, 4);
+    out.append(deflated);
+    gz_put_uint(out, crc.checksum(), 4);
+    gz_put_uint(out, size, 4);
+}
+
+// returns the total size of the member starting at buf, or zero if it is not
+// a block written by gz_compress_block()
+inline size_t gz_block_size(const char* buf, size_t size)
+{
+    if (size < _gz_header_size + _gz_trailer_size)
+        return 0;
+    if (buf[0] != '\x1f' || buf[1] != '\x8b' || buf[2] != '\x08' ||
+        buf[3] != '\x04' || gz_get_uint(buf + 10, 2) != 8 ||
+        buf[12] != 'G' || buf[13] != 'T' || gz_get_uint(buf + 14, 2) != 4)
+        return 0;
+    size_t bsize = gz_get_uint(buf + 16, 4);
+    if (bsize < _gz_header_size + _gz_trailer_size || bsize > size)
+        return 0;
+    return bsize;
+}
+
+// decompress a single member into out, which must have the correct size
+inline bool gz_decompress_block(const char* buf, size_t bsize, char* out,
+                                size_t out_size)
+{
+    boost::iostreams::zlib_params params;
+    params.noheader = true;
+    boost::iostreams::filtering_istream s;
+    s.push(boost::iostreams::zlib_decompressor(params));
+    s.push(boost::iostreams::array_source(buf + _gz_header_size,
+                                          bsize - _gz_header_size -
+                                          _gz_trailer_size));
+    s.read(out, out_size);
+    if (size_t(s.gcount()) != out_size)
+        return false;
+
+    boost::crc_32_type crc;
+    crc.process_bytes(out, out_size);
+    return crc.checksum() == gz_get_uint(buf + bsize - _gz_trailer_size, 4);
+}
+
+// number of blocks which are compressed or decompressed together, enough to
+// keep all threads busy
+inline size_t gz_batch_blocks()
+{
+#ifdef USING_OPENMP
+    return 4 * omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Source device which reads a blocked gzip file through a memory mapping. The
+// blocks are decompressed a batch at a time (in parallel), so that only a
+// bounded amount of uncompressed data is kept in memory.
+class blocked_gzip_source
+{
+public:
+    typedef char char_type;
+    typedef boost::iostreams::source_tag category;
+
+    blocked_gzip_source() : _state(new state_t()) {}
+
+    // Map the file and locate its blocks. Returns false if the data is not in
+    // the blocked format (in which case it must be read sequentially).
+    bool open(const std::string& file)
+    {
+        state_t& st = *_state;
+        st.mfile.open(file);
+        const char* buf = st.mfile.data();
+        size_t size = st.mfile.size();
+
+        size_t pos = 0;
+        st.opos = {0};
+        while (pos < size)
+        {
+            size_t bsize = gz_block_size(buf + pos, size - pos);
+            if (bsize == 0)
+            {
+                if (st.bpos.empty())
+                {
+                    st.mfile.close();
+                    return false;
+                }
+                throw IOException("error reading compressed file: invalid "
+                                  "block at position " + std::to_string(pos));
+            }
+            st.bpos.push_back(pos);
+            pos += bsize;
+            st.opos.push_back(st.opos.back() +
+                              gz_get_uint(buf + pos - _gz_trailer_size + 4, 4));
+        }
+        if (st.bpos.empty())
+        {
+            st.mfile.close();
+            return false;
+        }
+        st.bpos.push_back(size);
+        return true;
+    }
+
+    std::streamsize read(char* s, std::streamsize n)
+    {
+        state_t& st = *_state;
+        std::streamsize count = 0;
+        while (count < n)
+        {
+            if (st.pos == st.buf.size() && !next_batch())
+                break;
+            size_t m = std::min(size_t(n - count), st.buf.size() - st.pos);
+            std::memcpy(s + count, st.buf.data() + st.pos, m);
+            st.pos += m;
+            count += m;
+        }
+        return (count > 0) ? count : -1;
+    }
+
+private:
+    // decompress the next batch of blocks into the buffer; returns false if
+    // there are none left
+    bool next_batch()
+    {
+        state_t& st = *_state;
+        size_t first = st.next;
+        size_t N = std::min(gz_batch_blocks(), st.bpos.size() - 1 - first);
+        if (N == 0)
+            return false;
+
+        const char* buf = st.mfile.data();
+        size_t offset = st.opos[first];
+        st.buf.resize(st.opos[first + N] - offset);
+        bool valid = true;
+        int i;
+        #pragma omp parallel for default(shared) private(i) schedule(dynamic)
+        for (i = 0; i < int(N); ++i)
+        {
+            size_t j = first + i;
+            try
+            {
+                if (!gz_decompress_block(buf + st.bpos[j],
+                                         st.bpos[j + 1] - st.bpos[j],
+                                         st.buf.data() + st.opos[j] - offset,
+                                         st.opos[j + 1] - st.opos[j]))
+                    valid = false;
+            }
+            catch (std::exception&)
+            {
+                valid = false;
+            }
+        }
+        if (!valid)
+            throw IOException("error reading compressed file: corrupted data");
+        st.next += N;
+        st.pos = 0;
+        return true;
+    }
+
+    // devices are copied around, so the state must be shared
+    struct state_t
+    {
+        state_t() : next(0), pos(0) {}
+        boost::iostreams::mapped_file_source mfile;
+        std::vector<size_t> bpos, opos; // compressed and uncompressed offsets
+        size_t next;                    // next block to be decompressed
+        std::vector<char> buf;          // current batch
+        size_t pos;                     // read position in buf
+    };
+    std::shared_ptr<state_t> _state;
+};
+
+// Output filter which compresses the data in blocks, in parallel. The data is
+// accumulated until there are enough blocks to keep all threads busy.
+class blocked_gzip_compressor
+{
+public:
+    typedef char char_type;
+    struct category
+        : boost::iostreams::multichar_output_filter_tag,
+          boost::iostreams::closable_tag {};
+
+    blocked_gzip_compressor() : _state(new state_t()) {}
+
+    template <class Sink>
+    std::streamsize write(Sink& snk, const char* s, std::streamsize n)
+    {
+        _state->buf.append(s, n);
+        if (_state->buf.size() >= get_batch_size())
+            flush(snk, false);
+        return n;
+    }
+
+    template <class Sink>
+    void close(Sink& snk)
+    {
+        flush(snk, true);
+    }
+
+private:
+    static size_t get_batch_size()
+    {
+        return gz_batch_blocks() * _gz_block_size;
+    }
+
+    template <class Sink>
+    void flush(Sink& snk, bool all)
+    {
+        std::string& buf = _state->buf;
+        size_t N = buf.size() / _gz_block_size;
+        if (all && (buf.size() % _gz_block_size > 0 || !_state->written))
+            N++; // an empty file still needs a (empty) member
+        if (N == 0)
+            return;
+
+        std::vector<std::string> blocks(N);
+        int i;
+        #pragma omp parallel for default(shared) private(i) schedule(dynamic)
+        for (i = 0; i < int(N); ++i)
+        {
+            size_t pos = i * _gz_block_size;
+            gz_compress_block(buf.data() + pos,
+                              std::min(_gz_block_size, buf.size() - pos),
+                              blocks[i]);
+        }
+
+        for (auto& b : blocks)
+            boost::iostreams::write(snk, b.data(), b.size());
+        buf.erase(0, std::min(buf.size(), N * _gz_block_size));
+        _state->written = true;
+    }
+
+    // filters are copied around, so the state must be shared
+    struct state_t
+    {
+        state_t() : written(false) {}
+        std::string buf;
+        bool written;
+    };
+    std::shared_ptr<state_t> _state;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_IO_GZIP_HH
@@ -16,6 +16,8 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "graph.hh"
+#include "random.hh"
+#include "parallel_loops.hh"
 
 #include <boost/python.hpp>
 
@@ -50,6 +52,7 @@ void openmp_set_num_threads(int n)
 {
 #ifdef USING_OPENMP
     omp_set_num_threads(n);
+    parallel_rng::clear();
 #else
     throw GraphException("OpenMP was not enabled during compilation");
 #endif
@@ -107,6 +110,31 @@ void openmp_set_schedule(string skind, int chunk)
 }
 
 
+static bool _degree_balance = false;
+
+bool graph_tool::get_openmp_degree_balance()
+{
+    return _degree_balance;
+}
+
+bool openmp_get_degree_balance()
+{
+#ifdef USING_OPENMP
+    return _degree_balance;
+#else
+    throw GraphException("OpenMP was not enabled during compilation");
+#endif
+}
+
+void openmp_set_degree_balance(bool balance)
+{
+#ifdef USING_OPENMP
+    _degree_balance = balance;
+#else
+    throw GraphException("OpenMP was not enabled during compilation");
+#endif
+}
+
 void export_openmp()
 {
     using namespace boost::python;
@@ -116,4 +144,6 @@ void export_openmp()
     def("openmp_set_num_threads", &openmp_set_num_threads);
     def("openmp_get_schedule", &openmp_get_schedule);
     def("openmp_set_schedule", &openmp_set_schedule);
+    def("openmp_get_degree_balance", &openmp_get_degree_balance);
+    def("openmp_set_degree_balance", &openmp_set_degree_balance);
 };
@@ -224,8 +224,10 @@ struct do_edge_difference
                     boost::any eprop) const
     {
         typedef typename property_traits<VertexPropertyMap>::value_type vval_t;
-        typedef typename boost::mpl::if_<std::is_same<vval_t, size_t>, int32_t, vval_t>::type
-            val_t;
+        // the index map is converted to int32_t
+        typedef typename boost::mpl::if_<std::is_same<vval_t,
+                                                      GraphInterface::vertex_t>,
+                                         int32_t, vval_t>::type val_t;
         typedef typename property_map_type::apply<val_t, EdgeIndexMap>::type
             eprop_t;
         eprop_t ediff = any_cast<eprop_t>(eprop);
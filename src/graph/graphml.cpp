@@ -388,7 +388,7 @@ private:
             //strip leading "n" from name
             size_t id = lexical_cast<size_t>(std::string(v,1));
             if (m_integer_vertices)
-                return id;
+                return m_g.get_vertex(id);
             return m_canonical_vertex[id];
         }
         else
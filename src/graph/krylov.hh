@@ -0,0 +1,615 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef KRYLOV_HH
+#define KRYLOV_HH
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <random>
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+//
+// Krylov eigensolvers
+// ===================
+//
+// Eigensolvers for large sparse matrices which are only accessible through
+// their products with vectors, given by a function object matvec(x, y) which
+// computes y = A x, where x and y are vectors of size N. The vector operations
+// run in parallel. The projected problems are small, and are solved serially.
+
+typedef std::vector<double> kvec_t;
+
+enum eig_which_t
+{
+    LARGEST_ALGEBRAIC,
+    SMALLEST_ALGEBRAIC,
+    LARGEST_MAGNITUDE
+};
+
+inline double kdot(const kvec_t& x, const kvec_t& y)
+{
+    double d = 0;
+    int i, N = x.size();
+    #pragma omp parallel for default(shared) private(i) \
+        schedule(static) reduction(+:d) if (N > 1000)
+    for (i = 0; i < N; ++i)
+        d += x[i] * y[i];
+    return d;
+}
+
+inline double knorm(const kvec_t& x)
+{
+    return std::sqrt(kdot(x, x));
+}
+
+inline void kscale(kvec_t& x, double a)
+{
+    int i, N = x.size();
+    #pragma omp parallel for default(shared) private(i) \
+        schedule(static) if (N > 1000)
+    for (i = 0; i < N; ++i)
+        x[i] *= a;
+}
+
+// Orthogonalizes w against the first n vectors of V, with two passes of
+// classical Gram-Schmidt, and adds the projections to h. Returns the norm of
+// w afterwards.
+inline double korthogonalize(const std::vector<kvec_t>& V, size_t n,
+                             kvec_t& w, kvec_t& h)
+{
+    int i, N = w.size();
+    size_t num_threads = 1;
+#ifdef USING_OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        // per-thread partial sums, which are added in a fixed order
+        std::vector<kvec_t> partial(num_threads, kvec_t(n, 0));
+        #pragma omp parallel default(shared) private(i) if (N > 1000)
+        {
+            size_t tid = 0;
+#ifdef USING_OPENMP
+            tid = omp_get_thread_num();
+#endif
+            kvec_t& c = partial[tid];
+            #pragma omp for schedule(static)
+            for (i = 0; i < N; ++i)
+            {
+                for (size_t j = 0; j < n; ++j)
+                    c[j] += V[j][i] * w[i];
+            }
+        }
+
+        kvec_t c(n, 0);
+        for (auto& pc : partial)
+            for (size_t j = 0; j < n; ++j)
+                c[j] += pc[j];
+
+        #pragma omp parallel for default(shared) private(i) \
+            schedule(static) if (N > 1000)
+        for (i = 0; i < N; ++i)
+        {
+            double s = 0;
+            for (size_t j = 0; j < n; ++j)
+                s += c[j] * V[j][i];
+            w[i] -= s;
+        }
+
+        for (size_t j = 0; j < n; ++j)
+            h[j] += c[j];
+    }
+    return knorm(w);
+}
+
+// y = sum_j V[j] * s[j * stride + col], for j < n
+inline void kcombine(const std::vector<kvec_t>& V, size_t n, const kvec_t& s,
+                     size_t stride, size_t col, kvec_t& y)
+{
+    int i, N = V[0].size();
+    y.resize(N);
+    #pragma omp parallel for default(shared) private(i) \
+        schedule(static) if (N > 1000)
+    for (i = 0; i < N; ++i)
+    {
+        double r = 0;
+        for (size_t j = 0; j < n; ++j)
+            r += V[j][i] * s[j * stride + col];
+        y[i] = r;
+    }
+}
+
+// Eigendecomposition of a small dense symmetric matrix A (m x m, row-major)
+// with the cyclic Jacobi method. A is destroyed. The eigenvectors are stored
+// in the columns of Q (row-major).
+inline void symmetric_eigen(size_t m, kvec_t& A, kvec_t& evals, kvec_t& Q)
+{
+    Q.assign(m * m, 0);
+    for (size_t i = 0; i < m; ++i)
+        Q[i * m + i] = 1;
+
+    for (size_t sweep = 0; sweep < 100; ++sweep)
+    {
+        double off = 0, total = 0;
+        for (size_t i = 0; i < m; ++i)
+        {
+            for (size_t j = 0; j < m; ++j)
+            {
+                total += A[i * m + j] * A[i * m + j];
+                if (i != j)
+                    off += A[i * m + j] * A[i * m + j];
+            }
+        }
+        if (off <= std::numeric_limits<double>::epsilon() *
+            std::numeric_limits<double>::epsilon() * total)
+            break;
+
+        for (size_t p = 0; p < m; ++p)
+        {
+            for (size_t q = p + 1; q < m; ++q)
+            {
+                double apq = A[p * m + q];
+                if (apq == 0)
+                    continue;
+                double theta = (A[q * m + q] - A[p * m + p]) / (2 * apq);
+                double t = (theta >= 0 ? 1. : -1.) /
+                    (std::abs(theta) + std::sqrt(theta * theta + 1));
+                double c = 1 / std::sqrt(t * t + 1);
+                double s = t * c;
+                for (size_t k = 0; k < m; ++k)
+                {
+                    double akp = A[k * m + p], akq = A[k * m + q];
+                    A[k * m + p] = c * akp - s * akq;
+                    A[k * m + q] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < m; ++k)
+                {
+                    double apk = A[p * m + k], aqk = A[q * m + k];
+                    A[p * m + k] = c * apk - s * aqk;
+                    A[q * m + k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < m; ++k)
+                {
+                    double qkp = Q[k * m + p], qkq = Q[k * m + q];
+                    Q[k * m + p] = c * qkp - s * qkq;
+                    Q[k * m + q] = s * qkp + c * qkq;
+                }
+            }
+        }
+    }
+
+    evals.resize(m);
+    for (size_t i = 0; i < m; ++i)
+        evals[i] = A[i * m + i];
+}
+
+// Returns the order in which the eigenvalues should be reported.
+inline std::vector<size_t> eig_order(const kvec_t& evals, eig_which_t which)
+{
+    std::vector<size_t> idx(evals.size());
+    for (size_t i = 0; i < idx.size(); ++i)
+        idx[i] = i;
+    std::sort(idx.begin(), idx.end(),
+              [&](size_t i, size_t j)
+              {
+                  switch (which)
+                  {
+                  case LARGEST_ALGEBRAIC:
+                      return evals[i] > evals[j];
+                  case SMALLEST_ALGEBRAIC:
+                      return evals[i] < evals[j];
+                  default:
+                      return std::abs(evals[i]) > std::abs(evals[j]);
+                  }
+              });
+    return idx;
+}
+
+// Computes k eigenpairs of a symmetric operator with the thick-restart Lanczos
+// method [wu-thick-restart-2000], with full reorthogonalization. The Krylov
+// basis has at most m vectors, and is restarted from the best Ritz vectors
+// found so far. The eigenvalues are returned in 'evals', sorted according to
+// 'which', and the eigenvectors in 'evecs'. A Ritz pair is considered
+// converged if its residual norm is below tol times the largest Ritz value
+// magnitude. The starting vector
+// v0 must be nonzero; if the search hits an invariant subspace, either inside
+// the basis or at a restart, new random directions are drawn from rng, with the
+// same support as v0. Returns the number of matrix-vector products.
+template <class MatVec, class RNG>
+size_t lanczos(MatVec&& matvec, const kvec_t& v0, size_t k, eig_which_t which,
+               double tol, size_t max_iter, kvec_t& evals,
+               std::vector<kvec_t>& evecs, RNG& rng, size_t m = 0)
+{
+    size_t N = v0.size();
+    size_t support = 0;
+    for (size_t i = 0; i < N; ++i)
+        if (v0[i] != 0)
+            ++support;
+    k = std::min(k, support);
+    if (m == 0)
+        m = std::max(2 * k + 1, k + 20);
+    m = std::min(m, support);
+
+    std::normal_distribution<double> normal;
+
+    // A new basis vector is taken as numerically zero if orthogonalization
+    // removed all but a fraction sqrt(eps) of its norm, since it is then
+    // dominated by rounding errors, and normalizing it would destroy the
+    // orthogonality of the basis.
+    const double breakdown = std::sqrt(std::numeric_limits<double>::epsilon());
+
+    // replaces x by a random unit vector orthogonal to the first n vectors
+    // of B
+    auto random_direction = [&](const std::vector<kvec_t>& B, size_t n,
+                                kvec_t& x)
+        {
+            double xn, wn;
+            do
+            {
+                for (size_t i = 0; i < N; ++i)
+                    x[i] = (v0[i] != 0) ? normal(rng) : 0;
+                xn = knorm(x);
+                kvec_t hh(n, 0);
+                wn = korthogonalize(B, n, x, hh);
+            }
+            while (wn <= breakdown * xn);
+            kscale(x, 1. / wn);
+        };
+
+    std::vector<kvec_t> V(1, v0);
+    kscale(V[0], 1. / knorm(V[0]));
+
+    kvec_t T(m * m, 0), S, theta, w(N), h;
+    std::vector<size_t> idx;
+    size_t j0 = 0, nmv = 0, n = m;
+    double beta = 0, wnorm = 0;
+    bool invariant = false;
+
+    // computes the Ritz pairs of the first n basis vectors, and returns how
+    // many of the first k have converged
+    auto ritz = [&](size_t n) -> size_t
+        {
+            kvec_t Tc(n * n);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    Tc[i * n + j] = T[i * m + j];
+            symmetric_eigen(n, Tc, theta, S);
+            idx = eig_order(theta, which);
+
+            size_t nconv = 0;
+            double scale = 0;
+            for (auto t : theta)
+                scale = std::max(scale, std::abs(t));
+            for (size_t l = 0; l < std::min(k, n); ++l)
+            {
+                double res = std::abs(beta * S[(n - 1) * n + idx[l]]);
+                if (res > tol * std::max(std::abs(theta[idx[l]]), scale))
+                    break;
+                ++nconv;
+            }
+            return nconv;
+        };
+
+    while (true)
+    {
+        // extend the basis up to m vectors, stopping early if the wanted
+        // Ritz pairs have already converged, unless an invariant subspace
+        // was found in this cycle, since then there may be missing
+        // multiplicities
+        bool done = false;
+        invariant = false;
+        n = m;
+        for (size_t j = j0; j < m; ++j)
+        {
+            matvec(V[j], w);
+            ++nmv;
+            wnorm = knorm(w);
+            h.assign(j + 1, 0);
+            beta = korthogonalize(V, j + 1, w, h);
+            for (size_t i = 0; i <= j; ++i)
+                T[i * m + j] = T[j * m + i] = h[i];
+
+            if (j + 1 == m)
+                break;
+
+            if (beta <= breakdown * wnorm)
+            {
+                // invariant subspace: continue with a new random direction
+                random_direction(V, j + 1, w);
+                beta = 0;
+                invariant = true;
+            }
+            else
+            {
+                if (!invariant && j + 1 > k && ritz(j + 1) == k)
+                {
+                    n = j + 1;
+                    done = true;
+                    break;
+                }
+                kscale(w, 1. / beta);
+            }
+            T[(j + 1) * m + j] = T[j * m + j + 1] = beta;
+            if (V.size() < j + 2)
+                V.push_back(w);
+            else
+                V[j + 1] = w;
+        }
+
+        if (!done)
+            done = (ritz(n) == k);
+
+        if (done || n == support || (max_iter > 0 && nmv >= max_iter))
+        {
+            evals.resize(k);
+            evecs.resize(k);
+            for (size_t l = 0; l < k; ++l)
+            {
+                evals[l] = theta[idx[l]];
+                kcombine(V, n, S, n, idx[l], evecs[l]);
+            }
+            break;
+        }
+
+        // thick restart, keeping the best Ritz vectors
+        size_t p = std::min(k + (m - k) / 2, m - 1);
+        std::vector<kvec_t> nV(p + 1);
+        for (size_t l = 0; l < p; ++l)
+            kcombine(V, n, S, n, idx[l], nV[l]);
+        nV[p] = w;
+        if (beta <= breakdown * wnorm)
+        {
+            // the basis ended in an invariant subspace, which contains the
+            // kept Ritz vectors; continue with a new random direction
+            random_direction(V, n, nV[p]);
+            beta = 0;
+        }
+        else
+        {
+            kscale(nV[p], 1. / beta);
+        }
+
+        T.assign(m * m, 0);
+        for (size_t l = 0; l < p; ++l)
+        {
+            T[l * m + l] = theta[idx[l]];
+            T[l * m + p] = T[p * m + l] = beta * S[(n - 1) * n + idx[l]];
+        }
+        V.swap(nV);
+        j0 = p;
+    }
+    return nmv;
+}
+
+// Eigenvalues of a small upper Hessenberg matrix H (m x m, row-major), with
+// the single-shift complex QR algorithm.
+inline std::vector<std::complex<double> >
+hessenberg_eigenvalues(size_t m, const kvec_t& H)
+{
+    typedef std::complex<double> cd;
+    std::vector<cd> A(H.begin(), H.end());
+    std::vector<cd> evals;
+    double eps = std::numeric_limits<double>::epsilon();
+
+    size_t n = m, iter = 0;
+    while (n > 0)
+    {
+        if (n == 1)
+        {
+            evals.push_back(A[0]);
+            break;
+        }
+
+        // look for a negligible subdiagonal element
+        size_t l = n - 1;
+        while (l > 0 && std::abs(A[l * m + l - 1]) >
+               eps * (std::abs(A[l * m + l]) + std::abs(A[(l - 1) * m + l - 1])))
+            --l;
+
+        if (l == n - 1 || iter > 100 * m)
+        {
+            evals.push_back(A[(n - 1) * m + n - 1]);
+            --n;
+            iter = 0;
+            continue;
+        }
+
+        // Wilkinson shift, with an occasional exceptional shift
+        cd a = A[(n - 2) * m + n - 2], b = A[(n - 2) * m + n - 1],
+            c = A[(n - 1) * m + n - 2], d = A[(n - 1) * m + n - 1];
+        cd mu;
+        if (iter > 0 && iter % 10 == 0)
+        {
+            mu = d + std::abs(c);
+        }
+        else
+        {
+            cd tr = a + d, det = a * d - b * c;
+            cd disc = std::sqrt(tr * tr / 4. - det);
+            cd mu1 = tr / 2. + disc, mu2 = tr / 2. - disc;
+            mu = (std::abs(mu1 - d) < std::abs(mu2 - d)) ? mu1 : mu2;
+        }
+
+        // QR step on the active block [l, n), with Givens rotations
+        for (size_t i = l; i < n; ++i)
+            A[i * m + i] -= mu;
+        std::vector<cd> cs(n), ss(n);
+        for (size_t q = l; q + 1 < n; ++q)
+        {
+            cd x = A[q * m + q], y = A[(q + 1) * m + q];
+            double r = std::sqrt(std::norm(x) + std::norm(y));
+            cd cq = (r > 0) ? x / r : cd(1), sq = (r > 0) ? y / r : cd(0);
+            cs[q] = cq;
+            ss[q] = sq;
+            for (size_t j = q; j < n; ++j)
+            {
+                cd u = A[q * m + j], v = A[(q + 1) * m + j];
+                A[q * m + j] = std::conj(cq) * u + std::conj(sq) * v;
+                A[(q + 1) * m + j] = -sq * u + cq * v;
+            }
+        }
+        for (size_t q = l; q + 1 < n; ++q)
+        {
+            cd cq = cs[q], sq = ss[q];
+            for (size_t i = l; i <= std::min(q + 1, n - 1); ++i)
+            {
+                cd u = A[i * m + q], v = A[i * m + q + 1];
+                A[i * m + q] = u * cq + v * sq;
+                A[i * m + q + 1] = -u * std::conj(sq) + v * std::conj(cq);
+            }
+        }
+        for (size_t i = l; i < n; ++i)
+            A[i * m + i] += mu;
+        ++iter;
+    }
+    return evals;
+}
+
+// Solves the dense system A x = b (m x m, row-major) in place, with Gaussian
+// elimination with partial pivoting. Singular pivots are perturbed.
+inline void dense_solve(size_t m, kvec_t A, kvec_t& b)
+{
+    double tiny = std::numeric_limits<double>::epsilon();
+    for (size_t c = 0; c < m; ++c)
+    {
+        size_t p = c;
+        for (size_t r = c + 1; r < m; ++r)
+            if (std::abs(A[r * m + c]) > std::abs(A[p * m + c]))
+                p = r;
+        if (p != c)
+        {
+            for (size_t j = 0; j < m; ++j)
+                std::swap(A[c * m + j], A[p * m + j]);
+            std::swap(b[c], b[p]);
+        }
+        if (std::abs(A[c * m + c]) < tiny)
+            A[c * m + c] = tiny;
+        for (size_t r = c + 1; r < m; ++r)
+        {
+            double f = A[r * m + c] / A[c * m + c];
+            for (size_t j = c; j < m; ++j)
+                A[r * m + j] -= f * A[c * m + j];
+            b[r] -= f * b[c];
+        }
+    }
+    for (size_t c = m; c-- > 0;)
+    {
+        for (size_t j = c + 1; j < m; ++j)
+            b[c] -= A[c * m + j] * b[j];
+        b[c] /= A[c * m + c];
+    }
+}
+
+// Computes the eigenpair of a general operator with the eigenvalue of largest
+// real part, which must be real (as is the case for the Perron eigenvalue of a
+// non-negative matrix), with the explicitly restarted Arnoldi method. Each
+// cycle builds a Krylov basis of m vectors from the current approximation,
+// and restarts from the Ritz vector. The eigenvector is stored in v, which
+// must contain the starting vector. Returns the eigenvalue; 'nmv' is set to
+// the number of matrix-vector products.
+template <class MatVec>
+double arnoldi(MatVec&& matvec, kvec_t& v, double tol, size_t max_iter,
+               size_t& nmv, size_t m = 20)
+{
+    size_t N = v.size();
+    size_t support = 0;
+    for (size_t i = 0; i < N; ++i)
+        if (v[i] != 0)
+            ++support;
+    m = std::max(std::min(m, support), size_t(1));
+
+    std::vector<kvec_t> V(m + 1);
+    kvec_t H, s, h, w(N);
+    double lambda = 0;
+    nmv = 0;
+    kscale(v, 1. / knorm(v));
+    while (true)
+    {
+        V[0] = v;
+        H.assign((m + 1) * m, 0);
+        size_t n = m;
+        for (size_t j = 0; j < m; ++j)
+        {
+            matvec(V[j], w);
+            ++nmv;
+            h.assign(j + 1, 0);
+            double beta = korthogonalize(V, j + 1, w, h);
+            for (size_t i = 0; i <= j; ++i)
+                H[i * m + j] = h[i];
+            H[(j + 1) * m + j] = beta;
+            if (beta <= std::numeric_limits<double>::epsilon() *
+                std::max(std::abs(h[j]), 1.))
+            {
+                n = j + 1; // invariant subspace
+                break;
+            }
+            kscale(w, 1. / beta);
+            V[j + 1] = w;
+        }
+
+        // Ritz value with the largest real part
+        kvec_t Hn(n * n);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                Hn[i * n + j] = H[i * m + j];
+        auto ev = hessenberg_eigenvalues(n, Hn);
+        lambda = ev[0].real();
+        for (auto& l : ev)
+            lambda = std::max(lambda, l.real());
+
+        // Ritz vector, by inverse iteration on the projected matrix
+        double shift = lambda + std::numeric_limits<double>::epsilon() *
+            std::max(std::abs(lambda), 1.) * 1e3;
+        for (size_t i = 0; i < n; ++i)
+            Hn[i * n + i] -= shift;
+        s.assign(n, 1);
+        for (size_t it = 0; it < 3; ++it)
+        {
+            dense_solve(n, Hn, s);
+            double sn = 0;
+            for (auto x : s)
+                sn += x * x;
+            sn = std::sqrt(sn);
+            for (auto& x : s)
+                x /= sn;
+        }
+
+        kcombine(V, n, s, 1, 0, v);
+        double vn = knorm(v);
+        kscale(v, 1. / vn);
+
+        double res = std::abs(H[n * m + n - 1] * s[n - 1]) / vn;
+        if (n < m || res <= tol * std::max(std::abs(lambda), tol) ||
+            (max_iter > 0 && nmv >= max_iter))
+            break;
+    }
+    return lambda;
+}
+
+} // namespace graph_tool
+
+#endif // KRYLOV_HH
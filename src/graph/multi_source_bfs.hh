@@ -0,0 +1,158 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MULTI_SOURCE_BFS_HH
+#define MULTI_SOURCE_BFS_HH
+
+#include <vector>
+#include <cstdint>
+#include <boost/graph/graph_traits.hpp>
+
+#include "graph_selectors.hh"
+
+namespace graph_tool
+{
+
+// Multi-source breadth-first search [then-more-2014]. Up to 64 unweighted
+// searches are run at once, with one bit of a machine word per source, so
+// that a vertex which is reached at the same distance by several sources is
+// visited, and its edges are scanned, only once per level for all of them.
+// Since in small-world graphs most of the searches reach most of the vertices
+// within a few levels, this amortizes the edge scans over the whole batch.
+//
+// The object holds the per-vertex bit sets, which are reset after every
+// search by touching only the vertices that were actually reached, hence it
+// is meant to be kept alive by each thread and reused for many batches.
+//
+// [then-more-2014] M. Then, M. Kaufmann, F. Chirigati, T.-A. Hoang-Vu, K.
+// Pham, A. Kemper, T. Neumann and H. T. Vo, "The more the merrier: efficient
+// multi-source graph traversal", Proceedings of the VLDB Endowment 8, 449-460
+// (2014).
+
+template <class Graph, class VertexIndex>
+class multi_source_bfs
+{
+public:
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef uint64_t mask_t;
+    static const size_t width = 64;
+
+    multi_source_bfs(const Graph& g, VertexIndex vertex_index)
+        : _g(g), _vertex_index(vertex_index), _seen(num_vertices(g), 0),
+          _visit(num_vertices(g), 0), _visit_next(num_vertices(g), 0) {}
+
+    // Searches from the sources in the range [begin, end), which must contain
+    // at most 'width' distinct vertices. For every vertex u reached at a
+    // distance d > 0, f(u, d, mask) is called exactly once, where bit i of
+    // 'mask' is set for every source begin[i] which reaches u at distance
+    // d. The sources themselves (d = 0) are not reported. If 'reversed' is
+    // true, the edges are followed backwards, i.e. the distances are those
+    // from u to the sources.
+    template <class Iter, class F>
+    void run(Iter begin, Iter end, F&& f, bool reversed = false)
+    {
+        _frontier.clear();
+        mask_t bit = 1;
+        for (Iter s = begin; s != end; ++s)
+        {
+            size_t i = get(_vertex_index, *s);
+            if (_seen[i] == 0)
+            {
+                _frontier.push_back(*s);
+                _touched.push_back(i);
+            }
+            _seen[i] |= bit;
+            _visit[i] |= bit;
+            bit <<= 1;
+        }
+
+        size_t d = 0;
+        while (!_frontier.empty())
+        {
+            ++d;
+            _next.clear();
+            for (auto v : _frontier)
+            {
+                mask_t m = _visit[get(_vertex_index, v)];
+                auto push = [&](vertex_t u)
+                    {
+                        size_t j = get(_vertex_index, u);
+                        mask_t D = m & ~_seen[j];
+                        if (D == 0)
+                            return;
+                        if (_visit_next[j] == 0)
+                            _next.push_back(u);
+                        _visit_next[j] |= D;
+                    };
+                if (reversed)
+                {
+                    typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+                    for (boost::tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, _g);
+                         e != e_end; ++e)
+                    {
+                        if (is_directed::apply<Graph>::type::value)
+                            push(source(*e, _g));
+                        else
+                            push(target(*e, _g));
+                    }
+                }
+                else
+                {
+                    typename boost::graph_traits<Graph>::adjacency_iterator a, a_end;
+                    for (boost::tie(a, a_end) = adjacent_vertices(v, _g); a != a_end; ++a)
+                        push(*a);
+                }
+            }
+
+            for (auto v : _frontier)
+                _visit[get(_vertex_index, v)] = 0;
+
+            // the new bits are only merged after the whole level is done, so
+            // that every vertex is reported once per distance
+            for (auto u : _next)
+            {
+                size_t j = get(_vertex_index, u);
+                mask_t D = _visit_next[j];
+                if (_seen[j] == 0)
+                    _touched.push_back(j);
+                _seen[j] |= D;
+                _visit[j] = D;
+                _visit_next[j] = 0;
+                f(u, d, D);
+            }
+            _frontier.swap(_next);
+        }
+
+        for (auto i : _touched)
+            _seen[i] = 0;
+        _touched.clear();
+    }
+
+private:
+    const Graph& _g;
+    VertexIndex _vertex_index;
+    std::vector<mask_t> _seen;
+    std::vector<mask_t> _visit;
+    std::vector<mask_t> _visit_next;
+    std::vector<vertex_t> _frontier;
+    std::vector<vertex_t> _next;
+    std::vector<size_t> _touched;
+};
+
+} // namespace graph_tool
+
+#endif // MULTI_SOURCE_BFS_HH
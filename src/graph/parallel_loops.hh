@@ -0,0 +1,170 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PARALLEL_LOOPS_HH
+#define PARALLEL_LOOPS_HH
+
+#include <vector>
+#include <boost/graph/graph_traits.hpp>
+
+#include "graph_selectors.hh"
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+//
+// Parallel loops
+// ==============
+//
+// By default, the parallel loops over the vertices are distributed among the
+// threads according to the OpenMP runtime schedule (see
+// openmp_set_schedule()), which splits the vertex indexes into ranges of equal
+// size. If degree balancing is enabled (see openmp_set_degree_balance()),
+// the index range is instead split into many contiguous blocks of
+// approximately equal total weight (by default the vertex degrees), which are
+// handed out dynamically to the threads, so that threads that finish early
+// take over the remaining blocks, instead of waiting for the one which got the
+// hubs.
+
+bool get_openmp_degree_balance();
+
+// Splits the range [0, N) into contiguous blocks of approximately equal total
+// weight, where the weight of each index i is given by w(i). The block
+// boundaries are stored in 'blocks', which will contain the first index of
+// every block, followed by N.
+template <class Weight>
+void get_balanced_partition(size_t N, Weight&& w, std::vector<size_t>& blocks)
+{
+    blocks.clear();
+    blocks.push_back(0);
+    if (N == 0)
+        return;
+
+    size_t num_threads = 1;
+#ifdef USING_OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    // enough blocks to even out the load, but not so many that the block
+    // bookkeeping dominates
+    size_t n_blocks = std::min(N, num_threads * 32);
+
+    std::vector<size_t> cum(N);
+    size_t W = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        W += w(i);
+        cum[i] = W;
+    }
+
+    size_t k = 1;
+    for (size_t i = 0; i < N - 1; ++i)
+    {
+        // cut after i if the prefix sum has reached the k-th fraction of the
+        // total weight
+        if (k < n_blocks && cum[i] * n_blocks >= W * k)
+        {
+            blocks.push_back(i + 1);
+            while (k < n_blocks && cum[i] * n_blocks >= W * k)
+                ++k;
+        }
+    }
+    blocks.push_back(N);
+}
+
+// Returns the partition of the vertex indexes used by the parallel vertex
+// loops, which is empty if degree balancing is disabled. Each vertex is
+// weighted by its total degree, plus one, to account for the per-vertex
+// overhead. This is O(V + E), and should be computed only once if the same
+// loop is repeated many times.
+template <class Graph>
+std::vector<size_t> get_vertex_partition(const Graph& g)
+{
+    std::vector<size_t> blocks;
+    if (!get_openmp_degree_balance())
+        return blocks;
+    get_balanced_partition
+        (num_vertices(g),
+         [&](size_t i) -> size_t
+         {
+             auto v = vertex(i, g);
+             if (v == boost::graph_traits<Graph>::null_vertex())
+                 return 0;
+             return total_degreeS()(v, g) + 1;
+         }, blocks);
+    return blocks;
+}
+
+// Calls f(i) for every i in [0, N), splitting the work among the threads of
+// the enclosing parallel region, which must be entered by all of them. If
+// 'blocks' is empty, the OpenMP runtime schedule is used, otherwise the
+// blocks are scheduled dynamically.
+template <class F>
+void parallel_loop_no_spawn(size_t N, const std::vector<size_t>& blocks,
+                            F&& f)
+{
+    int i;
+    if (blocks.empty())
+    {
+        #pragma omp for schedule(runtime)
+        for (i = 0; i < int(N); ++i)
+            f(size_t(i));
+    }
+    else
+    {
+        int NB = blocks.size() - 1;
+        #pragma omp for schedule(dynamic, 1)
+        for (i = 0; i < NB; ++i)
+        {
+            for (size_t j = blocks[i]; j < blocks[i + 1]; ++j)
+                f(j);
+        }
+    }
+}
+
+// Calls f(v) for every valid vertex v, as above.
+template <class Graph, class F>
+void parallel_vertex_loop_no_spawn(const Graph& g,
+                                   const std::vector<size_t>& blocks, F&& f)
+{
+    parallel_loop_no_spawn
+        (num_vertices(g), blocks,
+         [&](size_t i)
+         {
+             auto v = vertex(i, g);
+             if (v == boost::graph_traits<Graph>::null_vertex())
+                 return;
+             f(v);
+         });
+}
+
+// Spawns a parallel region if the graph has more than 'thres' vertices, and
+// calls f(v) for every valid vertex v.
+template <class Graph, class F>
+void parallel_vertex_loop(const Graph& g, F&& f, size_t thres = 100)
+{
+    std::vector<size_t> blocks = get_vertex_partition(g);
+    #pragma omp parallel if (num_vertices(g) > thres)
+    parallel_vertex_loop_no_spawn(g, blocks, f);
+}
+
+} // namespace graph_tool
+
+#endif // PARALLEL_LOOPS_HH
@@ -15,10 +15,54 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
+#include "config.h"
+
+#include <array>
+#include <algorithm>
+#include <functional>
+
 #include "random.hh"
 
+#ifdef USING_OPENMP
+#include <omp.h>
+#endif
+
 rng_t get_rng(size_t seed)
 {
     std::seed_seq seq{seed, seed + 1, seed + 2, seed + 3, seed + 4};
     return rng_t(seq);
 }
+
+std::vector<rng_t> parallel_rng::_rngs;
+
+parallel_rng::parallel_rng(rng_t& rng)
+    : _rng(rng)
+{
+    size_t num_threads = 1;
+#ifdef USING_OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    for (size_t i = _rngs.size(); i + 1 < num_threads; ++i)
+    {
+        std::array<int, rng_t::state_size> seed_data;
+        std::generate_n(seed_data.data(), seed_data.size(), std::ref(rng));
+        std::seed_seq seq(std::begin(seed_data), std::end(seed_data));
+        _rngs.emplace_back(seq);
+    }
+}
+
+rng_t& parallel_rng::get()
+{
+    size_t tid = 0;
+#ifdef USING_OPENMP
+    tid = omp_get_thread_num();
+#endif
+    if (tid == 0)
+        return _rng;
+    return _rngs[tid - 1];
+}
+
+void parallel_rng::clear()
+{
+    _rngs.clear();
+}
@@ -19,9 +19,36 @@
 #define RANDOM_HH
 
 #include <random>
+#include <vector>
 
 typedef std::mt19937 rng_t;
 
 rng_t get_rng(size_t seed);
 
+// Per-thread RNGs for parallel algorithms. The first thread uses the master RNG
+// (the one passed from python) itself, and the other threads use RNGs which
+// are seeded from it the first time they are needed, and are then kept across
+// calls. The pool is cleared whenever the master RNG is re-seeded or the
+// number of OpenMP threads changes, so that the results are reproducible for a
+// given seed and number of threads, as long as the work is distributed among
+// the threads deterministically (e.g. with a static schedule).
+//
+// An instance must be created outside of the parallel region, after which
+// get() can be called concurrently by each thread without locking.
+
+class parallel_rng
+{
+public:
+    parallel_rng(rng_t& rng);
+
+    // returns the RNG of the calling thread
+    rng_t& get();
+
+    static void clear();
+
+private:
+    rng_t& _rng;
+    static std::vector<rng_t> _rngs;
+};
+
 #endif
@@ -0,0 +1,237 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEARCH_WORKSPACE_HH
+#define SEARCH_WORKSPACE_HH
+
+#include <vector>
+#include <limits>
+#include <memory>
+#include <cstdint>
+#include <functional>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/detail/d_ary_heap.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+
+// Workspace for single-source searches. It holds the per-vertex distances,
+// predecessors, colors and heap positions, which are allocated once, together
+// with the list of the vertices reached by the last search. Only these are
+// reset, when the next search begins, so that a search costs time
+// proportional to the part of the graph it explores, instead of the number of
+// vertices, and its results remain available until then. The vertices are
+// identified by their indexes.
+//
+// Unreached vertices have the distance given by 'init' (by default the
+// maximum value of the type), which also acts as the infinite distance.
+
+template <class Value>
+class search_workspace
+{
+public:
+    enum color_t : uint8_t { WHITE = 0, GRAY, BLACK };
+
+    search_workspace(size_t N, Value init = std::numeric_limits<Value>::max())
+        : _init(init), _dist(N, init), _pred(N), _color(N, WHITE), _pos(N) {}
+
+    size_t size() const { return _dist.size(); }
+    Value init() const { return _init; }
+
+    Value& dist(size_t i) { return _dist[i]; }
+    Value dist(size_t i) const { return _dist[i]; }
+    size_t& pred(size_t i) { return _pred[i]; }
+    size_t pred(size_t i) const { return _pred[i]; }
+    uint8_t& color(size_t i) { return _color[i]; }
+    uint8_t color(size_t i) const { return _color[i]; }
+
+    // indexes of the vertices reached by the last search, in the order in
+    // which they were discovered
+    const std::vector<size_t>& touched() const { return _touched; }
+
+    // marks vertex i as reached for the first time
+    void discover(size_t i, Value d, size_t pred)
+    {
+        _dist[i] = d;
+        _pred[i] = pred;
+        _color[i] = GRAY;
+        _touched.push_back(i);
+    }
+
+    void reset()
+    {
+        for (auto i : _touched)
+        {
+            _dist[i] = _init;
+            _color[i] = WHITE;
+        }
+        _touched.clear();
+    }
+
+    // property maps over the distances and the heap positions, for use with
+    // boost::d_ary_heap_indirect
+    typedef boost::iterator_property_map<typename std::vector<Value>::iterator,
+                                         boost::identity_property_map>
+        dist_map_t;
+    typedef boost::iterator_property_map<std::vector<size_t>::iterator,
+                                         boost::identity_property_map>
+        pos_map_t;
+    dist_map_t get_dist_map() { return dist_map_t(_dist.begin()); }
+    pos_map_t get_pos_map() { return pos_map_t(_pos.begin()); }
+
+    std::vector<size_t>& queue() { return _queue; }
+
+private:
+    Value _init;
+    std::vector<Value> _dist;
+    std::vector<size_t> _pred;
+    std::vector<uint8_t> _color;
+    std::vector<size_t> _pos;
+    std::vector<size_t> _touched;
+    std::vector<size_t> _queue;
+};
+
+// Returns a workspace for graphs with at least N vertices, which is owned by
+// the calling thread and kept between calls, so that repeated searches
+// neither allocate nor initialize O(N) memory. Algorithms which need several
+// workspaces at once take them from different slots.
+template <class Value, size_t Slot = 0>
+search_workspace<Value>& get_search_workspace(size_t N)
+{
+    static thread_local std::unique_ptr<search_workspace<Value>> ws;
+    if (!ws || ws->size() < N)
+        ws.reset(new search_workspace<Value>(N));
+    return *ws;
+}
+
+// Breadth-first search from s, following the out-edges. The search stops
+// after the vertex 'tgt' is discovered, or before a vertex farther than
+// 'max_dist' is examined.
+template <class Graph, class VertexIndex, class Value>
+void workspace_bfs(const Graph& g, VertexIndex vertex_index,
+                   typename boost::graph_traits<Graph>::vertex_descriptor s,
+                   search_workspace<Value>& ws,
+                   Value max_dist = std::numeric_limits<Value>::max(),
+                   typename boost::graph_traits<Graph>::vertex_descriptor tgt
+                       = boost::graph_traits<Graph>::null_vertex())
+{
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef search_workspace<Value> ws_t;
+    ws.reset();
+
+    std::vector<size_t>& queue = ws.queue();
+    queue.clear();
+
+    size_t is = get(vertex_index, s);
+    ws.discover(is, 0, is);
+    queue.push_back(is);
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        size_t i = queue[head];
+        if (ws.dist(i) > max_dist)
+            break;
+        vertex_t v = vertex(i, g);
+        Value d = ws.dist(i) + 1;
+        typename boost::graph_traits<Graph>::out_edge_iterator e, e_end;
+        for (boost::tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
+        {
+            vertex_t u = target(*e, g);
+            size_t j = get(vertex_index, u);
+            if (ws.color(j) != ws_t::WHITE)
+                continue;
+            ws.discover(j, d, i);
+            queue.push_back(j);
+            if (u == tgt)
+                return;
+        }
+        ws.color(i) = ws_t::BLACK;
+    }
+}
+
+// Dijkstra search from s, following the out-edges, with non-negative
+// weights. The search stops before a vertex farther than 'max_dist', or the
+// vertex 'tgt', is examined. The distances of the vertices still in the
+// queue at that point are their tentative values.
+template <class Graph, class VertexIndex, class Weight, class Value>
+void workspace_dijkstra(const Graph& g, VertexIndex vertex_index,
+                        typename boost::graph_traits<Graph>::vertex_descriptor s,
+                        Weight weight, search_workspace<Value>& ws,
+                        Value max_dist = std::numeric_limits<Value>::max(),
+                        typename boost::graph_traits<Graph>::vertex_descriptor tgt
+                            = boost::graph_traits<Graph>::null_vertex())
+{
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef search_workspace<Value> ws_t;
+    typedef typename ws_t::dist_map_t dist_map_t;
+    typedef typename ws_t::pos_map_t pos_map_t;
+    ws.reset();
+
+    boost::d_ary_heap_indirect<size_t, 4, pos_map_t, dist_map_t,
+                               std::less<Value>>
+        queue(ws.get_dist_map(), ws.get_pos_map());
+
+    size_t is = get(vertex_index, s);
+    ws.discover(is, 0, is);
+    queue.push(is);
+
+    while (!queue.empty())
+    {
+        size_t i = queue.top();
+        queue.pop();
+        if (ws.dist(i) > max_dist)
+            break;
+        vertex_t v = vertex(i, g);
+        if (v == tgt)
+            break;
+        ws.color(i) = ws_t::BLACK;
+
+        Value d = ws.dist(i);
+        typename boost::graph_traits<Graph>::out_edge_iterator e, e_end;
+        for (boost::tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
+        {
+            auto w = get(weight, *e);
+            if (w < 0)
+                throw ValueException("the edge weights must be non-negative");
+            size_t j = get(vertex_index, target(*e, g));
+            if (ws.color(j) == ws_t::BLACK)
+                continue;
+            Value nd = Value(d + w);
+            if (!(nd < ws.dist(j)))
+                continue;
+            if (ws.color(j) == ws_t::WHITE)
+            {
+                ws.discover(j, nd, i);
+                queue.push(j);
+            }
+            else
+            {
+                ws.dist(j) = nd;
+                ws.pred(j) = i;
+                queue.update(j);
+            }
+        }
+    }
+}
+
+} // namespace graph_tool
+
+#endif // SEARCH_WORKSPACE_HH
@@ -31,10 +31,10 @@ struct get_adjacency
     template <class Graph, class Index, class Weight>
     void operator()(Graph& g, Index index, Weight weight,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int,1>& i,
-                    multi_array_ref<int,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (const auto& e : edges_range(g))
         {
             data[pos] = get(weight, e);
@@ -31,10 +31,10 @@ struct get_incidence
     template <class Graph, class VIndex, class EIndex>
     void operator()(Graph& g, VIndex vindex, EIndex eindex,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (auto v : vertices_range(g))
         {
             for (const auto& e : out_edges_range(v, g))
@@ -74,10 +74,10 @@ struct get_laplacian
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (const auto& e : edges_range(g))
         {
             if (source(e, g) == target(e, g))
@@ -126,10 +126,10 @@ struct get_norm_laplacian
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (auto v : vertices_range(g))
         {
             double ks = 0;
@@ -17,6 +17,7 @@
 
 #include <boost/python.hpp>
 #include "graph.hh"
+#include "random.hh"
 
 using namespace std;
 using namespace boost;
@@ -46,6 +47,17 @@ void transition(GraphInterface& g, boost::any index, boost::any weight,
                 python::object odata, python::object oi,
                 python::object oj);
 
+void degrees(GraphInterface& g, boost::any index, boost::any weight,
+             string sdeg, python::object od);
+
+void matmat(GraphInterface& g, boost::any index, boost::any weight,
+            string stype, bool transpose, python::object od,
+            python::object ox, python::object oret);
+size_t eigenpairs(GraphInterface& g, boost::any index, boost::any weight,
+                  string stype, string swhich, double tol, size_t max_iter,
+                  python::object od, python::object oevals,
+                  python::object oevecs, rng_t& rng);
+
 BOOST_PYTHON_MODULE(libgraph_tool_spectral)
 {
     using namespace boost::python;
@@ -54,4 +66,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_spectral)
     def("norm_laplacian", &norm_laplacian);
     def("incidence", &incidence);
     def("transition", &transition);
+    def("degrees", &degrees);
+    def("matmat", &matmat);
+    def("eigenpairs", &eigenpairs);
 }
@@ -0,0 +1,143 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/python.hpp>
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "numpy_bind.hh"
+
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+#include "random.hh"
+
+#include "graph_matvec.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+typedef ConstantPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+    weight_props_t;
+
+static void check_matvec_args(boost::any& index, boost::any& weight)
+{
+    if (!belongs<vertex_scalar_properties>()(index))
+        throw ValueException("index vertex property must have a scalar value type");
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t(1.0);
+}
+
+void degrees(GraphInterface& g, boost::any index, boost::any weight,
+             string sdeg, python::object od)
+{
+    check_matvec_args(index, weight);
+
+    deg_t deg;
+    if (sdeg == "in")
+        deg = IN_DEG;
+    else if (sdeg == "out")
+        deg = OUT_DEG;
+    else if (sdeg == "total")
+        deg = TOTAL_DEG;
+    else
+        throw ValueException("invalid degree type: " + sdeg);
+
+    multi_array_ref<double,1> d = get_array<double,1>(od);
+    run_action<>()
+        (g, std::bind(get_degrees(),
+                      placeholders::_1, placeholders::_2, placeholders::_3,
+                      deg, std::ref(d)),
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+}
+
+void matmat(GraphInterface& g, boost::any index, boost::any weight,
+            string stype, bool transpose, python::object od,
+            python::object ox, python::object oret)
+{
+    check_matvec_args(index, weight);
+
+    matrix_t type;
+    if (stype == "adjacency")
+        type = ADJACENCY;
+    else if (stype == "laplacian")
+        type = LAPLACIAN;
+    else if (stype == "norm_laplacian")
+        type = NORM_LAPLACIAN;
+    else if (stype == "transition")
+        type = TRANSITION;
+    else
+        throw ValueException("invalid matrix type: " + stype);
+
+    multi_array_ref<double,1> d = get_array<double,1>(od);
+    multi_array_ref<double,2> x = get_array<double,2>(ox);
+    multi_array_ref<double,2> ret = get_array<double,2>(oret);
+    run_action<>()
+        (g, std::bind(get_matmat(),
+                      placeholders::_1, placeholders::_2, placeholders::_3,
+                      type, transpose, std::ref(d), std::ref(x),
+                      std::ref(ret)),
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+}
+
+size_t eigenpairs(GraphInterface& g, boost::any index, boost::any weight,
+                  string stype, string swhich, double tol, size_t max_iter,
+                  python::object od, python::object oevals,
+                  python::object oevecs, rng_t& rng)
+{
+    check_matvec_args(index, weight);
+
+    matrix_t type;
+    if (stype == "adjacency")
+        type = ADJACENCY;
+    else if (stype == "laplacian")
+        type = LAPLACIAN;
+    else if (stype == "norm_laplacian")
+        type = NORM_LAPLACIAN;
+    else
+        throw ValueException("invalid symmetric matrix type: " + stype);
+
+    eig_which_t which;
+    if (swhich == "LA")
+        which = LARGEST_ALGEBRAIC;
+    else if (swhich == "SA")
+        which = SMALLEST_ALGEBRAIC;
+    else if (swhich == "LM")
+        which = LARGEST_MAGNITUDE;
+    else
+        throw ValueException("invalid eigenvalue selection: " + swhich);
+
+    multi_array_ref<double,1> d = get_array<double,1>(od);
+    multi_array_ref<double,1> evals = get_array<double,1>(oevals);
+    multi_array_ref<double,2> evecs = get_array<double,2>(oevecs);
+    size_t nmv = 0;
+    run_action<>()
+        (g, std::bind(get_eigenpairs(),
+                      placeholders::_1, placeholders::_2, placeholders::_3,
+                      type, which, tol, max_iter, std::ref(d), std::ref(evals),
+                      std::ref(evecs), std::ref(rng), std::ref(nmv)),
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+    return nmv;
+}
@@ -0,0 +1,260 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_MATVEC_HH
+#define GRAPH_MATVEC_HH
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "parallel_loops.hh"
+#include "krylov.hh"
+
+#include "graph_laplacian.hh"
+
+namespace graph_tool
+{
+using namespace boost;
+
+// Matrix-free products of the matrices in this module with blocks of column
+// vectors, computed directly on the graph. Every row is computed by a single
+// thread, by pulling the values of its neighbours, so no synchronization is
+// needed. The entries are the same as in the sparse matrices built by
+// get_adjacency(), get_laplacian(), get_norm_laplacian() and
+// get_transition().
+
+enum matrix_t
+{
+    ADJACENCY,
+    LAPLACIAN,
+    NORM_LAPLACIAN,
+    TRANSITION
+};
+
+// weighted degrees, as used by the Laplacian and transition matrices
+struct get_degrees
+{
+    template <class Graph, class Index, class Weight>
+    void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
+                    multi_array_ref<double,1>& d) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 double k = 0;
+                 switch (deg)
+                 {
+                 case OUT_DEG:
+                     k = sum_degree(g, v, weight, out_edge_iteratorS<Graph>());
+                     break;
+                 case IN_DEG:
+                     k = sum_degree(g, v, weight, in_edge_iteratorS<Graph>());
+                     break;
+                 case TOTAL_DEG:
+                     k = sum_degree(g, v, weight, all_edges_iteratorS<Graph>());
+                 }
+                 d[get(index, v)] = k;
+             });
+    }
+};
+
+struct get_matmat
+{
+    // Calls f(e, u) for every edge e which contributes to the row of v, where
+    // u is the vertex of the corresponding column. Row i of the adjacency
+    // matrix collects the edges pointing to i, hence the in-edges are used,
+    // or the out-edges for the transpose.
+    template <class Graph, class F>
+    static void row_edges(const Graph& g,
+                          typename graph_traits<Graph>::vertex_descriptor v,
+                          bool transpose, F&& f)
+    {
+        if (!transpose)
+        {
+            typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+            for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, g);
+                 e != e_end; ++e)
+            {
+                if (is_directed::apply<Graph>::type::value)
+                    f(*e, source(*e, g));
+                else
+                    f(*e, target(*e, g));
+            }
+        }
+        else
+        {
+            typename graph_traits<Graph>::out_edge_iterator e, e_end;
+            for (tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
+                f(*e, target(*e, g));
+        }
+    }
+
+    template <class Graph, class Index, class Weight>
+    void operator()(const Graph& g, Index index, Weight weight,
+                    matrix_t type, bool transpose,
+                    multi_array_ref<double,1>& d,
+                    multi_array_ref<double,2>& x,
+                    multi_array_ref<double,2>& ret) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        size_t M = x.shape()[1];
+
+        // the transition matrix is indexed as (source, target), unlike the
+        // others
+        if (type == TRANSITION)
+            transpose = !transpose;
+
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 size_t i = get(index, v);
+                 auto y = ret[i];
+                 for (size_t k = 0; k < M; ++k)
+                     y[k] = 0;
+
+                 switch (type)
+                 {
+                 case ADJACENCY:
+                     row_edges(g, v, transpose,
+                               [&](const typename graph_traits<Graph>::edge_descriptor& e,
+                                   vertex_t u)
+                               {
+                                   double w = get(weight, e);
+                                   auto xu = x[get(index, u)];
+                                   for (size_t k = 0; k < M; ++k)
+                                       y[k] += w * xu[k];
+                               });
+                     break;
+                 case LAPLACIAN:
+                     row_edges(g, v, transpose,
+                               [&](const typename graph_traits<Graph>::edge_descriptor& e,
+                                   vertex_t u)
+                               {
+                                   if (u == v)
+                                       return;
+                                   double w = get(weight, e);
+                                   auto xu = x[get(index, u)];
+                                   for (size_t k = 0; k < M; ++k)
+                                       y[k] -= w * xu[k];
+                               });
+                     for (size_t k = 0; k < M; ++k)
+                         y[k] += d[i] * x[i][k];
+                     break;
+                 case NORM_LAPLACIAN:
+                     row_edges(g, v, transpose,
+                               [&](const typename graph_traits<Graph>::edge_descriptor& e,
+                                   vertex_t u)
+                               {
+                                   size_t j = get(index, u);
+                                   if (u == v || d[i] * d[j] <= 0)
+                                       return;
+                                   double w = get(weight, e) / sqrt(d[i] * d[j]);
+                                   auto xu = x[j];
+                                   for (size_t k = 0; k < M; ++k)
+                                       y[k] -= w * xu[k];
+                               });
+                     if (d[i] > 0)
+                     {
+                         for (size_t k = 0; k < M; ++k)
+                             y[k] += x[i][k];
+                     }
+                     break;
+                 case TRANSITION:
+                     // entry (s, t) is w / k_s, i.e. the degree of the row for
+                     // the direct product, and of the column for the
+                     // transpose
+                     row_edges(g, v, transpose,
+                               [&](const typename graph_traits<Graph>::edge_descriptor& e,
+                                   vertex_t u)
+                               {
+                                   size_t j = get(index, u);
+                                   double w = get(weight, e) /
+                                       (transpose ? d[i] : d[j]);
+                                   auto xu = x[j];
+                                   for (size_t k = 0; k < M; ++k)
+                                       y[k] += w * xu[k];
+                               });
+                 }
+             });
+    }
+};
+
+// Extremal eigenpairs of the symmetric matrices of undirected graphs, with the
+// Lanczos method on top of get_matmat.
+struct get_eigenpairs
+{
+    template <class Graph, class Index, class Weight, class RNG>
+    void operator()(const Graph& g, Index index, Weight weight,
+                    matrix_t type, eig_which_t which, double tol,
+                    size_t max_iter, multi_array_ref<double,1>& d,
+                    multi_array_ref<double,1>& evals,
+                    multi_array_ref<double,2>& evecs, RNG& rng,
+                    size_t& nmv) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        if (is_directed::apply<Graph>::type::value)
+            throw ValueException("the matrix must be symmetric, which requires "
+                                 "an undirected graph");
+
+        size_t N = evecs.shape()[0], k = evals.shape()[0];
+
+        auto matvec = [&](const kvec_t& x, kvec_t& y)
+            {
+                y.assign(N, 0);
+                multi_array_ref<double,2> mx(const_cast<double*>(x.data()),
+                                             extents[N][1]);
+                multi_array_ref<double,2> my(y.data(), extents[N][1]);
+                get_matmat()(g, index, weight, type, false, d, mx, my);
+            };
+
+        // random starting vector, supported only on the rows of the graph
+        kvec_t x0(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](vertex_t v)
+             {
+                 x0[get(index, v)] = 1;
+             });
+        std::normal_distribution<double> normal;
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (x0[i] != 0)
+                x0[i] = normal(rng);
+        }
+
+        kvec_t vals;
+        std::vector<kvec_t> vecs;
+        nmv = lanczos(matvec, x0, k, which, tol, max_iter, vals, vecs, rng);
+        if (vals.size() < k)
+            throw ValueException("the number of requested eigenpairs exceeds "
+                                 "the number of vertices");
+
+        for (size_t l = 0; l < k; ++l)
+        {
+            evals[l] = vals[l];
+            for (size_t i = 0; i < N; ++i)
+                evecs[i][l] = vecs[l][i];
+        }
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_MATVEC_HH
@@ -57,8 +57,8 @@ void norm_laplacian(GraphInterface& g, boost::any index, boost::any weight,
         deg = TOTAL_DEG;
 
     multi_array_ref<double,1> data = get_array<double,1>(odata);
-    multi_array_ref<int32_t,1> i = get_array<int32_t,1>(oi);
-    multi_array_ref<int32_t,1> j = get_array<int32_t,1>(oj);
+    multi_array_ref<int64_t,1> i = get_array<int64_t,1>(oi);
+    multi_array_ref<int64_t,1> j = get_array<int64_t,1>(oj);
     run_action<>()
         (g, std::bind(get_norm_laplacian(),
                       placeholders::_1,  placeholders::_2,  placeholders::_3,
@@ -52,10 +52,10 @@ struct get_transition
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight,
                     multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    multi_array_ref<int64_t,1>& i,
+                    multi_array_ref<int64_t,1>& j) const
     {
-        int pos = 0;
+        size_t pos = 0;
         for (auto v: vertices_range(g))
         {
             double k = sum_degree(g, v, weight, out_edge_iteratorS<Graph>());
@@ -18,15 +18,14 @@
 #ifndef GRAPH_DISTANCE_SAMPLED_HH
 #define GRAPH_DISTANCE_SAMPLED_HH
 
-#include <boost/graph/breadth_first_search.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
-
 #include <boost/python/object.hpp>
 #include <boost/python/list.hpp>
 #include <boost/python/extract.hpp>
 
 #include "histogram.hh"
 #include "numpy_bind.hh"
+#include "multi_source_bfs.hh"
+#include "search_workspace.hh"
 
 namespace graph_tool
 {
@@ -59,12 +58,6 @@ struct get_sampled_distance_histogram
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
 
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
         typedef Histogram<val_type, size_t, 1> hist_t;
@@ -85,42 +78,31 @@ struct get_sampled_distance_histogram
                 sources.push_back(vertex(i,g));
         n_samples = min(n_samples, sources.size());
 
+        // draw the sources (without replacement) beforehand, so that the
+        // parallel loop needs no locking, and the sample does not depend on
+        // the number of threads
+        for (size_t j = 0; j < n_samples; ++j)
+        {
+            uniform_int_distribution<size_t> randint(j, sources.size() - 1);
+            swap(sources[j], sources[randint(rng)]);
+        }
+
         typename hist_t::point_t point;
-        get_vertex_dists_t get_vertex_dists;
         #pragma omp parallel for default(shared) private(i,point) \
             firstprivate(s_hist) schedule(runtime) if (num_vertices(g) * n_samples > 100)
         for (i = 0; i < int(n_samples); ++i)
         {
-            vertex_t v;
-            #pragma omp critical
-            {
-                uniform_int_distribution<size_t> randint(0, sources.size()-1);
-                size_t j = randint(rng);
-                v = sources[j];
-                swap(sources[j], sources.back());
-                sources.pop_back();
-            }
+            vertex_t v = sources[i];
+            auto& ws = get_search_workspace<val_type>(num_vertices(g));
+            workspace_dijkstra(g, vertex_index, v, weights, ws);
 
-            unchecked_vector_property_map<val_type,VertexIndex>
-                dist_map(vertex_index, num_vertices(g));
-
-            for (size_t j = 0; j < num_vertices(g); ++j)
+            for (auto j : ws.touched())
             {
-                if (vertex(i,g) != graph_traits<Graph>::null_vertex())
-                    dist_map[vertex(j,g)] =  numeric_limits<val_type>::max();
+                if (j == get(vertex_index, v))
+                    continue;
+                point[0] = ws.dist(j);
+                s_hist.PutValue(point);
             }
-
-            dist_map[v] = 0;
-            get_vertex_dists(g, v, vertex_index, dist_map, weights);
-
-            typename graph_traits<Graph>::vertex_iterator v2, v_end;
-            for (tie(v2, v_end) = vertices(g); v2 != v_end; ++v2)
-                if (*v2 != v &&
-                    dist_map[*v2] != numeric_limits<val_type>::max())
-                {
-                    point[0] = dist_map[*v2];
-                    s_hist.PutValue(point);
-                }
         }
         s_hist.Gather();
 
@@ -130,41 +112,66 @@ struct get_sampled_distance_histogram
         phist = ret;
     }
 
-    // weighted version. Use dijkstra_shortest_paths()
-    struct get_dists_djk
+    // unweighted version: the searches are run from 64 sources at once with
+    // multi_source_bfs, and every vertex reached at a given distance is
+    // counted once for all the sources in its bit mask
+    template <class Graph, class VertexIndex, class RNG>
+    void operator()(const Graph& g, VertexIndex vertex_index, no_weightS,
+                    size_t n_samples, const vector<long double>& obins,
+                    python::object& phist, RNG& rng) const
     {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap, class WeightMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, WeightMap weights) const
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef multi_source_bfs<Graph, VertexIndex> msbfs_t;
+        typedef typename msbfs_t::mask_t mask_t;
+        typedef Histogram<size_t, size_t, 1> hist_t;
+
+        std::array<vector<size_t>,1> bins;
+        bins[0].resize(obins.size());
+        for (size_t i = 0; i < obins.size(); ++i)
+            bins[0][i] = obins[i];
+
+        hist_t hist(bins);
+        SharedHistogram<hist_t> s_hist(hist);
+
+        vector<vertex_t> sources;
+        sources.reserve(num_vertices(g));
+        for (size_t i = 0; i < num_vertices(g); ++i)
+            if (vertex(i,g) != graph_traits<Graph>::null_vertex())
+                sources.push_back(vertex(i,g));
+        n_samples = min(n_samples, sources.size());
+
+        for (size_t j = 0; j < n_samples; ++j)
         {
-            dijkstra_shortest_paths(g, s, vertex_index_map(vertex_index).
-                                    weight_map(weights).distance_map(dist_map));
+            uniform_int_distribution<size_t> randint(j, sources.size() - 1);
+            swap(sources[j], sources[randint(rng)]);
         }
-    };
 
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
+        int n_batches = (n_samples + msbfs_t::width - 1) / msbfs_t::width;
+        #pragma omp parallel firstprivate(s_hist) if (num_vertices(g) * n_samples > 100)
         {
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef unordered_map<vertex_t,default_color_type,
-                                  DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
+            msbfs_t bfs(g, vertex_index);
+            typename hist_t::point_t point;
+
+            #pragma omp for schedule(runtime)
+            for (int b = 0; b < n_batches; ++b)
+            {
+                size_t first = b * msbfs_t::width;
+                size_t last = min(first + msbfs_t::width, n_samples);
+                bfs.run(sources.begin() + first, sources.begin() + last,
+                        [&](vertex_t, size_t d, mask_t m)
+                        {
+                            point[0] = d;
+                            s_hist.PutValue(point, __builtin_popcountll(m));
+                        });
+            }
         }
-    };
+        s_hist.Gather();
+
+        python::list ret;
+        ret.append(wrap_multi_array_owned<size_t,1>(hist.GetArray()));
+        ret.append(wrap_vector_owned<size_t>(hist.GetBins()[0]));
+        phist = ret;
+    }
 };
 
 } // boost namespace
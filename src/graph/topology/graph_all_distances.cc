@@ -17,6 +17,7 @@
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "multi_source_bfs.hh"
 
 #include <boost/python.hpp>
 
@@ -61,20 +62,82 @@ struct do_all_pairs_search
     }
 };
 
+// unweighted version: the searches are run from 64 sources at once with
+// multi_source_bfs, and every row of the distance matrix is written only by the
+// thread which handles its source
+struct do_all_pairs_bfs
+{
+    template <class Graph, class VertexIndexMap, class DistMap>
+    void operator()(const Graph& g, VertexIndexMap vertex_index,
+                    DistMap dist_map) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef typename property_traits<DistMap>::value_type::value_type
+            dist_t;
+        typedef multi_source_bfs<Graph, VertexIndexMap> msbfs_t;
+        typedef typename msbfs_t::mask_t mask_t;
+
+        vector<vertex_t> sources;
+        for (size_t i = 0; i < num_vertices(g); ++i)
+        {
+            vertex_t v = vertex(i, g);
+            if (v != graph_traits<Graph>::null_vertex())
+                sources.push_back(v);
+        }
+
+        int n_batches = (sources.size() + msbfs_t::width - 1) / msbfs_t::width;
+        size_t N = num_vertices(g);
+        #pragma omp parallel if (N > 100)
+        {
+            msbfs_t bfs(g, vertex_index);
+
+            #pragma omp for schedule(runtime)
+            for (int b = 0; b < n_batches; ++b)
+            {
+                size_t first = b * msbfs_t::width;
+                size_t last = min(first + msbfs_t::width, sources.size());
+                for (size_t l = first; l < last; ++l)
+                {
+                    vertex_t v = sources[l];
+                    dist_map[v].clear();
+                    dist_map[v].resize(N, numeric_limits<dist_t>::max());
+                    dist_map[v][get(vertex_index, v)] = 0;
+                }
+
+                bfs.run(sources.begin() + first, sources.begin() + last,
+                        [&](vertex_t u, size_t d, mask_t m)
+                        {
+                            size_t j = get(vertex_index, u);
+                            while (m != 0)
+                            {
+                                size_t l = __builtin_ctzll(m);
+                                m &= m - 1;
+                                dist_map[sources[first + l]][j] = d;
+                            }
+                        });
+            }
+        }
+    }
+};
+
 void get_all_dists(GraphInterface& gi, boost::any dist_map, boost::any weight,
                    bool dense)
 {
-    typedef ConstantPropertyMap<size_t,GraphInterface::edge_t> cweight_map_t;
-
     if (weight.empty())
-        weight = boost::any(cweight_map_t(1));
+    {
+        run_action<>()
+            (gi, std::bind(do_all_pairs_bfs(), placeholders::_1,
+                           gi.GetVertexIndex(), placeholders::_2),
+             vertex_scalar_vector_properties())(dist_map);
+        return;
+    }
 
     run_action<>()
         (gi, std::bind(do_all_pairs_search(), placeholders::_1,
                        gi.GetVertexIndex(), placeholders::_2, placeholders::_3,
                        dense),
          vertex_scalar_vector_properties(),
-         mpl::push_back<edge_scalar_properties,cweight_map_t>::type())
+         edge_scalar_properties())
         (dist_map, weight);
 }
 
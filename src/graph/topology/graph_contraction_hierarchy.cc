@@ -0,0 +1,68 @@
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+
+#include "graph_contraction_hierarchy.hh"
+#include "graph_point_to_point.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+typedef boost::mpl::push_back<edge_scalar_properties, unit_weight_map_t>::type
+    ch_weight_props_t;
+
+void do_build_contraction_hierarchy(GraphInterface& gi,
+                                    contraction_hierarchy& ch,
+                                    boost::any weight, size_t limit)
+{
+    if (weight.empty())
+        weight = unit_weight_map_t(1);
+    else if (!belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    run_action<>()
+        (gi, std::bind(build_contraction_hierarchy(), placeholders::_1,
+                       gi.GetVertexIndex(), placeholders::_2, std::ref(ch),
+                       limit),
+         ch_weight_props_t())(weight);
+}
+
+void export_contraction_hierarchy()
+{
+    using namespace boost::python;
+    void (contraction_hierarchy::*distances)(object, object, object) const =
+        &contraction_hierarchy::distances;
+    object (contraction_hierarchy::*path)(size_t, size_t) const =
+        &contraction_hierarchy::path;
+    class_<contraction_hierarchy>("ContractionHierarchy")
+        .def("distance", &contraction_hierarchy::distance)
+        .def("distances", distances)
+        .def("path", path)
+        .def("num_vertices", &contraction_hierarchy::get_num_vertices)
+        .def("num_shortcuts", &contraction_hierarchy::get_num_shortcuts)
+        .def("num_arcs", &contraction_hierarchy::get_num_arcs)
+        .def("memory_usage", &contraction_hierarchy::memory_usage)
+        .def("get_state", &contraction_hierarchy::get_state)
+        .def("set_state", &contraction_hierarchy::set_state)
+        .enable_pickling();
+    def("build_contraction_hierarchy", &do_build_contraction_hierarchy);
+}
@@ -0,0 +1,748 @@
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CONTRACTION_HIERARCHY_HH
+#define GRAPH_CONTRACTION_HIERARCHY_HH
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/python/object.hpp>
+#include <boost/python/tuple.hpp>
+
+#include "graph.hh"
+#include "graph_selectors.hh"
+#include "numpy_bind.hh"
+#include "search_workspace.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Contraction hierarchy [geisberger-contraction-2008] for repeated
+// point-to-point shortest distance queries on a static graph.
+//
+// The vertices are contracted one by one, in the order given by their rank:
+// a contracted vertex is removed from the remaining graph, and a shortcut
+// u -> w through it is inserted whenever u -> v -> w is the only shortest
+// path between its neighbours u and w, as determined by a bounded local
+// search (the "witness" search). Every edge and shortcut is then kept only at
+// its endpoint of lower rank, either as an upward out-edge (_up) or as an
+// upward in-edge (_dn), so that a query is a bidirectional Dijkstra search
+// which only climbs the hierarchy from both ends, and explores a tiny part of
+// the graph.
+//
+// The contraction proceeds in rounds, where all vertices whose priority
+// (number of shortcuts minus the number of removed edges, plus the number of
+// contracted neighbours) is smaller than that of their neighbours are
+// contracted in parallel. Since these form an independent set, their
+// shortcuts can be computed independently, as long as the witness searches
+// avoid all of them.
+//
+// [geisberger-contraction-2008] R. Geisberger, P. Sanders, D. Schultes and
+// D. Delling, "Contraction hierarchies: faster and simpler hierarchical
+// routing in road networks", Proceedings of the 7th International Workshop
+// on Experimental Algorithms, LNCS 5038, 319-333 (2008).
+
+struct ch_arc
+{
+    size_t v;
+    double w;
+    int64_t mid;  // contracted vertex of a shortcut, or -1 for an edge
+};
+
+// The remaining graph during the contraction, with in- and out-adjacency
+// lists over vertex indexes, without parallel edges and self-loops.
+class ch_builder
+{
+public:
+    ch_builder(size_t N, size_t limit)
+        : _out(N), _in(N), _deleted(N, 0), _prio(N, 0), _sel(N, false),
+          _limit(limit) {}
+
+    void add_arc(size_t u, size_t v, double w, int64_t mid)
+    {
+        if (u == v)
+            return;
+        for (auto& a : _out[u])
+        {
+            if (a.v != v)
+                continue;
+            if (w < a.w)
+            {
+                a.w = w;
+                a.mid = mid;
+                for (auto& b : _in[v])
+                {
+                    if (b.v == u)
+                    {
+                        b.w = w;
+                        b.mid = mid;
+                        break;
+                    }
+                }
+            }
+            return;
+        }
+        _out[u].push_back({v, w, mid});
+        _in[v].push_back({u, w, mid});
+    }
+
+    // removes v from the remaining graph
+    template <class F>
+    void remove(size_t v, F&& touch)
+    {
+        auto drop = [v](vector<ch_arc>& as)
+            {
+                for (size_t i = 0; i < as.size(); ++i)
+                {
+                    if (as[i].v == v)
+                    {
+                        as[i] = as.back();
+                        as.pop_back();
+                        break;
+                    }
+                }
+            };
+        for (auto& a : _out[v])
+        {
+            drop(_in[a.v]);
+            _deleted[a.v]++;
+            touch(a.v);
+        }
+        for (auto& a : _in[v])
+        {
+            drop(_out[a.v]);
+            _deleted[a.v]++;
+            touch(a.v);
+        }
+        _out[v].clear();
+        _in[v].clear();
+    }
+
+    // Dijkstra search from u which avoids v and the vertices selected for
+    // contraction, up to the distance max_d, until the n_targets vertices
+    // marked in 'target' are settled, or until _limit vertices are
+    // settled. Every reached vertex has a path of at most its distance.
+    void witness(size_t u, size_t v, double max_d,
+                 const vector<uint8_t>& target, size_t n_targets,
+                 search_workspace<double>& ws) const
+    {
+        typedef search_workspace<double> ws_t;
+        ws.reset();
+        d_ary_heap_indirect<size_t, 4, typename ws_t::pos_map_t,
+                            typename ws_t::dist_map_t, std::less<double>>
+            queue(ws.get_dist_map(), ws.get_pos_map());
+        ws.discover(u, 0, u);
+        queue.push(u);
+        size_t settled = 0;
+        while (!queue.empty())
+        {
+            size_t i = queue.top();
+            queue.pop();
+            ws.color(i) = ws_t::BLACK;
+            double d = ws.dist(i);
+            if (d > max_d || ++settled > _limit)
+                break;
+            if (target[i] && i != u && --n_targets == 0)
+                break;
+            for (auto& a : _out[i])
+            {
+                size_t j = a.v;
+                if (j == v || _sel[j] || ws.color(j) == ws_t::BLACK)
+                    continue;
+                double nd = d + a.w;
+                if (!(nd < ws.dist(j)))
+                    continue;
+                if (ws.color(j) == ws_t::WHITE)
+                {
+                    ws.discover(j, nd, i);
+                    queue.push(j);
+                }
+                else
+                {
+                    ws.dist(j) = nd;
+                    queue.update(j);
+                }
+            }
+        }
+    }
+
+    // calls f(u, w, d) for every shortcut needed if v is contracted, and
+    // returns their number
+    template <class F>
+    size_t shortcuts(size_t v, search_workspace<double>& ws, F&& f) const
+    {
+        static thread_local vector<uint8_t> target;
+        if (target.size() < _out.size())
+            target.resize(_out.size(), false);
+
+        double max_out = 0;
+        for (auto& b : _out[v])
+        {
+            max_out = max(max_out, b.w);
+            target[b.v] = true;
+        }
+        size_t n = 0;
+        for (auto& a : _in[v])
+        {
+            size_t n_targets = _out[v].size() - size_t(target[a.v]);
+            witness(a.v, v, a.w + max_out, target, n_targets, ws);
+            for (auto& b : _out[v])
+            {
+                if (b.v == a.v)
+                    continue;
+                double d = a.w + b.w;
+                if (ws.dist(b.v) <= d)
+                    continue;
+                f(a.v, b.v, d);
+                ++n;
+            }
+        }
+        for (auto& b : _out[v])
+            target[b.v] = false;
+        return n;
+    }
+
+    void update_priority(size_t v, search_workspace<double>& ws)
+    {
+        size_t n = shortcuts(v, ws, [](size_t, size_t, double) {});
+        _prio[v] = 2 * (double(n) - double(_out[v].size() + _in[v].size())) +
+            _deleted[v];
+    }
+
+    // whether v precedes all its neighbours in the contraction order
+    bool is_local_min(size_t v) const
+    {
+        auto precedes = [&](size_t u)
+            {
+                return (_prio[v] < _prio[u] ||
+                        (_prio[v] == _prio[u] && hash(v) < hash(u)));
+            };
+        for (auto& a : _out[v])
+            if (!precedes(a.v))
+                return false;
+        for (auto& a : _in[v])
+            if (!precedes(a.v))
+                return false;
+        return true;
+    }
+
+    // breaks the ties between vertices of equal priority in a scattered
+    // order, since the vertex indexes are often spatially correlated
+    static size_t hash(size_t v)
+    {
+        v ^= v >> 33;
+        v *= 0xff51afd7ed558ccdULL;
+        v ^= v >> 33;
+        return v;
+    }
+
+    vector<vector<ch_arc>> _out, _in;
+    vector<size_t> _deleted;
+    vector<double> _prio;
+    vector<uint8_t> _sel;
+    size_t _limit;
+};
+
+class contraction_hierarchy
+{
+public:
+    typedef search_workspace<double> ws_t;
+
+    contraction_hierarchy() : _N(0), _num_shortcuts(0) {}
+
+    template <class Graph, class VertexIndex, class Weight>
+    void build(const Graph& g, VertexIndex vertex_index, Weight weight,
+               size_t limit)
+    {
+        _N = num_vertices(g);
+        ch_builder b(_N, limit);
+
+        vector<size_t> remaining;
+        for (size_t i = 0; i < _N; ++i)
+        {
+            if (vertex(i, g) != graph_traits<Graph>::null_vertex())
+                remaining.push_back(i);
+        }
+
+        typename graph_traits<Graph>::edge_iterator e, e_end;
+        for (tie(e, e_end) = edges(g); e != e_end; ++e)
+        {
+            double w = get(weight, *e);
+            if (w < 0)
+                throw ValueException("the edge weights must be non-negative");
+            size_t s = get(vertex_index, source(*e, g));
+            size_t t = get(vertex_index, target(*e, g));
+            b.add_arc(s, t, w, -1);
+            if (!is_directed::apply<Graph>::type::value)
+                b.add_arc(t, s, w, -1);
+        }
+
+        auto update = [&](const vector<size_t>& vs)
+            {
+                int i, n = vs.size();
+                #pragma omp parallel for default(shared) private(i) \
+                    schedule(runtime) if (n > 100)
+                for (i = 0; i < n; ++i)
+                    b.update_priority(vs[i], get_search_workspace<double>(_N));
+            };
+        update(remaining);
+
+        _rank.assign(_N, -1);
+        vector<vector<ch_arc>> up(_N), dn(_N);
+        vector<uint8_t> dirty(_N, false);
+        vector<size_t> sel, touched;
+        vector<vector<std::tuple<size_t, size_t, double>>> sc;
+        int64_t r = 0;
+        while (!remaining.empty())
+        {
+            int i, n = remaining.size();
+            #pragma omp parallel for default(shared) private(i) \
+                schedule(runtime) if (n > 100)
+            for (i = 0; i < n; ++i)
+                b._sel[remaining[i]] = b.is_local_min(remaining[i]);
+
+            sel.clear();
+            for (auto v : remaining)
+                if (b._sel[v])
+                    sel.push_back(v);
+
+            sc.clear();
+            sc.resize(sel.size());
+            n = sel.size();
+            #pragma omp parallel for default(shared) private(i) \
+                schedule(runtime) if (n > 1)
+            for (i = 0; i < n; ++i)
+            {
+                auto& sci = sc[i];
+                b.shortcuts(sel[i], get_search_workspace<double>(_N),
+                            [&](size_t u, size_t w, double d)
+                            { sci.emplace_back(u, w, d); });
+            }
+
+            touched.clear();
+            auto touch = [&](size_t u)
+                {
+                    if (!dirty[u])
+                        touched.push_back(u);
+                    dirty[u] = true;
+                };
+            for (size_t k = 0; k < sel.size(); ++k)
+            {
+                size_t v = sel[k];
+                _rank[v] = r++;
+                up[v] = b._out[v];
+                dn[v] = b._in[v];
+                b.remove(v, touch);
+            }
+            for (size_t k = 0; k < sel.size(); ++k)
+            {
+                for (auto& s : sc[k])
+                    b.add_arc(std::get<0>(s), std::get<1>(s), std::get<2>(s),
+                              sel[k]);
+            }
+
+            for (auto v : sel)
+            {
+                b._sel[v] = false;
+                dirty[v] = false;
+            }
+            remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+                                           [&](size_t v)
+                                           { return _rank[v] >= 0; }),
+                            remaining.end());
+
+            vector<size_t> upd;
+            for (auto u : touched)
+            {
+                if (dirty[u] && _rank[u] < 0)
+                    upd.push_back(u);
+                dirty[u] = false;
+            }
+            update(upd);
+        }
+
+        _num_shortcuts = 0;
+        flatten(up, _up_ptr, _up_v, _up_w, _up_mid);
+        flatten(dn, _dn_ptr, _dn_v, _dn_w, _dn_mid);
+    }
+
+    // Returns the distance from s to t, or infinity if there is no path.
+    double distance(size_t s, size_t t) const
+    {
+        check(s);
+        check(t);
+        size_t meet;
+        return query(s, t, get_search_workspace<double, 0>(_N),
+                     get_search_workspace<double, 1>(_N), meet);
+    }
+
+    // Distances between the pairs (sources[i], targets[i]), which are
+    // distributed among the threads.
+    template <class Array, class DArray>
+    void distances(const Array& sources, const Array& targets,
+                   DArray& dists) const
+    {
+        int i, n = sources.size();
+        for (i = 0; i < n; ++i)
+        {
+            check(sources[i]);
+            check(targets[i]);
+        }
+        #pragma omp parallel for default(shared) private(i) \
+            schedule(runtime) if (n > 1)
+        for (i = 0; i < n; ++i)
+        {
+            size_t meet;
+            dists[i] = query(sources[i], targets[i],
+                             get_search_workspace<double, 0>(_N),
+                             get_search_workspace<double, 1>(_N), meet);
+        }
+    }
+
+    void distances(python::object osources, python::object otargets,
+                   python::object odists) const
+    {
+        multi_array_ref<int64_t,1> sources = get_array<int64_t,1>(osources);
+        multi_array_ref<int64_t,1> targets = get_array<int64_t,1>(otargets);
+        multi_array_ref<double,1> dists = get_array<double,1>(odists);
+        distances(sources, targets, dists);
+    }
+
+    // Puts in p the vertices of a shortest path from s to t, with the
+    // shortcuts expanded, or leaves it empty if there is no path.
+    void path(size_t s, size_t t, vector<int64_t>& p) const
+    {
+        check(s);
+        check(t);
+        p.clear();
+        auto& fwd = get_search_workspace<double, 0>(_N);
+        auto& bwd = get_search_workspace<double, 1>(_N);
+        size_t meet;
+        if (std::isinf(query(s, t, fwd, bwd, meet)))
+            return;
+
+        vector<size_t> up_path;
+        for (size_t i = meet; i != s; i = fwd.pred(i))
+            up_path.push_back(i);
+        up_path.push_back(s);
+        std::reverse(up_path.begin(), up_path.end());
+
+        p.push_back(s);
+        for (size_t k = 0; k + 1 < up_path.size(); ++k)
+            unpack(up_path[k], up_path[k + 1], p);
+        for (size_t i = meet; i != t; i = bwd.pred(i))
+            unpack(i, bwd.pred(i), p);
+    }
+
+    python::object path(size_t s, size_t t) const
+    {
+        vector<int64_t> p;
+        path(s, t, p);
+        return wrap_vector_owned(p);
+    }
+
+    size_t get_num_vertices() const { return _N; }
+    size_t get_num_shortcuts() const { return _num_shortcuts; }
+
+    size_t get_num_arcs() const { return _up_v.size() + _dn_v.size(); }
+
+    // number of bytes used by the index
+    size_t memory_usage() const
+    {
+        return (sizeof(int64_t) * (_rank.size() + _up_ptr.size() +
+                                   _up_v.size() + _up_mid.size() +
+                                   _dn_ptr.size() + _dn_v.size() +
+                                   _dn_mid.size()) +
+                sizeof(double) * (_up_w.size() + _dn_w.size()));
+    }
+
+    python::tuple get_state()
+    {
+        return python::make_tuple(wrap_vector_owned(_rank),
+                                  wrap_vector_owned(_up_ptr),
+                                  wrap_vector_owned(_up_v),
+                                  wrap_vector_owned(_up_w),
+                                  wrap_vector_owned(_up_mid),
+                                  wrap_vector_owned(_dn_ptr),
+                                  wrap_vector_owned(_dn_v),
+                                  wrap_vector_owned(_dn_w),
+                                  wrap_vector_owned(_dn_mid));
+    }
+
+    void set_state(python::tuple state)
+    {
+        load(state[0], _rank);
+        load(state[1], _up_ptr);
+        load(state[2], _up_v);
+        load(state[3], _up_w);
+        load(state[4], _up_mid);
+        load(state[5], _dn_ptr);
+        load(state[6], _dn_v);
+        load(state[7], _dn_w);
+        load(state[8], _dn_mid);
+        _N = _rank.size();
+        if (!check_arcs(_up_ptr, _up_v, _up_w, _up_mid) ||
+            !check_arcs(_dn_ptr, _dn_v, _dn_w, _dn_mid))
+        {
+            *this = contraction_hierarchy();
+            throw ValueException("invalid contraction hierarchy state");
+        }
+        _num_shortcuts = 0;
+        for (auto m : _up_mid)
+            _num_shortcuts += (m >= 0);
+        for (auto m : _dn_mid)
+            _num_shortcuts += (m >= 0);
+    }
+
+private:
+    template <class Value>
+    static void load(python::object oa, vector<Value>& x)
+    {
+        multi_array_ref<Value,1> a = get_array<Value,1>(oa);
+        x.assign(a.begin(), a.end());
+    }
+
+    // checks that the flattened arc lists of a loaded state are consistent,
+    // so that the queries never index out of bounds
+    bool check_arcs(const vector<int64_t>& ptr, const vector<int64_t>& vs,
+                    const vector<double>& ws,
+                    const vector<int64_t>& mid) const
+    {
+        if (ptr.size() != _N + 1 || ptr[0] != 0)
+            return false;
+        for (size_t i = 0; i < _N; ++i)
+        {
+            if (ptr[i + 1] < ptr[i])
+                return false;
+        }
+        size_t E = ptr.back();
+        if (vs.size() != E || ws.size() != E || mid.size() != E)
+            return false;
+        for (size_t k = 0; k < E; ++k)
+        {
+            if (vs[k] < 0 || size_t(vs[k]) >= _N)
+                return false;
+            if (mid[k] < -1 || mid[k] >= int64_t(_N))
+                return false;
+        }
+        return true;
+    }
+
+    void check(size_t v) const
+    {
+        if (v >= _N)
+            throw ValueException("invalid vertex index: " +
+                                 lexical_cast<string>(v));
+    }
+
+    void flatten(const vector<vector<ch_arc>>& as, vector<int64_t>& ptr,
+                 vector<int64_t>& vs, vector<double>& ws,
+                 vector<int64_t>& mid)
+    {
+        ptr.assign(1, 0);
+        vs.clear();
+        ws.clear();
+        mid.clear();
+        for (auto& a : as)
+        {
+            for (auto& x : a)
+            {
+                vs.push_back(x.v);
+                ws.push_back(x.w);
+                mid.push_back(x.mid);
+                _num_shortcuts += (x.mid >= 0);
+            }
+            ptr.push_back(vs.size());
+        }
+    }
+
+    // Bidirectional search over the upward edges. Each direction stops when
+    // its smallest distance reaches that of the shortest path found so far,
+    // which passes through 'meet', the vertex of highest rank in it.
+    double query(size_t s, size_t t, ws_t& fwd, ws_t& bwd, size_t& meet) const
+    {
+        typedef d_ary_heap_indirect<size_t, 4, typename ws_t::pos_map_t,
+                                    typename ws_t::dist_map_t,
+                                    std::less<double>> heap_t;
+        fwd.reset();
+        bwd.reset();
+        meet = s;
+        if (s == t)
+            return 0;
+
+        heap_t qf(fwd.get_dist_map(), fwd.get_pos_map());
+        heap_t qb(bwd.get_dist_map(), bwd.get_pos_map());
+        fwd.discover(s, 0, s);
+        qf.push(s);
+        bwd.discover(t, 0, t);
+        qb.push(t);
+
+        double mu = numeric_limits<double>::infinity();
+        bool forward = true;
+        while (!qf.empty() || !qb.empty())
+        {
+            if (qf.empty() || fwd.dist(qf.top()) >= mu)
+            {
+                if (qb.empty() || bwd.dist(qb.top()) >= mu)
+                    break;
+                forward = false;
+            }
+            else if (qb.empty() || bwd.dist(qb.top()) >= mu)
+            {
+                forward = true;
+            }
+
+            auto& ws = forward ? fwd : bwd;
+            auto& other = forward ? bwd : fwd;
+            auto& queue = forward ? qf : qb;
+            auto& ptr = forward ? _up_ptr : _dn_ptr;
+            auto& vs = forward ? _up_v : _dn_v;
+            auto& wv = forward ? _up_w : _dn_w;
+            auto& rptr = forward ? _dn_ptr : _up_ptr;
+            auto& rvs = forward ? _dn_v : _up_v;
+            auto& rwv = forward ? _dn_w : _up_w;
+
+            size_t i = queue.top();
+            queue.pop();
+            ws.color(i) = ws_t::BLACK;
+            double d = ws.dist(i);
+            if (other.color(i) != ws_t::WHITE && d + other.dist(i) < mu)
+            {
+                mu = d + other.dist(i);
+                meet = i;
+            }
+
+            // "stall-on-demand": if a vertex of higher rank already reached
+            // gives a shorter path to i, then i cannot be in the upward part
+            // of a shortest path, and its edges need not be relaxed
+            bool stalled = false;
+            for (int64_t k = rptr[i]; k < rptr[i + 1]; ++k)
+            {
+                if (ws.dist(rvs[k]) + rwv[k] < d)
+                {
+                    stalled = true;
+                    break;
+                }
+            }
+            if (stalled)
+            {
+                forward = !forward;
+                continue;
+            }
+
+            for (int64_t k = ptr[i]; k < ptr[i + 1]; ++k)
+            {
+                size_t j = vs[k];
+                if (ws.color(j) == ws_t::BLACK)
+                    continue;
+                double nd = d + wv[k];
+                if (!(nd < ws.dist(j)))
+                    continue;
+                if (ws.color(j) == ws_t::WHITE)
+                {
+                    ws.discover(j, nd, i);
+                    queue.push(j);
+                }
+                else
+                {
+                    ws.dist(j) = nd;
+                    ws.pred(j) = i;
+                    queue.update(j);
+                }
+            }
+            forward = !forward;
+        }
+        return mu;
+    }
+
+    // the contracted vertex of the arc u -> w, which is stored at the
+    // endpoint of lower rank
+    int64_t get_mid(size_t u, size_t w) const
+    {
+        int64_t mid = -1;
+        double best = numeric_limits<double>::infinity();
+        if (_rank[u] < _rank[w])
+        {
+            for (int64_t k = _up_ptr[u]; k < _up_ptr[u + 1]; ++k)
+            {
+                if (size_t(_up_v[k]) == w && _up_w[k] < best)
+                {
+                    best = _up_w[k];
+                    mid = _up_mid[k];
+                }
+            }
+        }
+        else
+        {
+            for (int64_t k = _dn_ptr[w]; k < _dn_ptr[w + 1]; ++k)
+            {
+                if (size_t(_dn_v[k]) == u && _dn_w[k] < best)
+                {
+                    best = _dn_w[k];
+                    mid = _dn_mid[k];
+                }
+            }
+        }
+        return mid;
+    }
+
+    // appends the vertices after u in the path of the arc u -> w
+    void unpack(size_t u, size_t w, vector<int64_t>& p) const
+    {
+        vector<pair<size_t, size_t>> stack = {{u, w}};
+        while (!stack.empty())
+        {
+            auto a = stack.back();
+            stack.pop_back();
+            int64_t m = get_mid(a.first, a.second);
+            if (m < 0)
+            {
+                p.push_back(a.second);
+                continue;
+            }
+            stack.emplace_back(m, a.second);
+            stack.emplace_back(a.first, m);
+        }
+    }
+
+    size_t _N;
+    size_t _num_shortcuts;
+    vector<int64_t> _rank;
+    vector<int64_t> _up_ptr, _up_v, _up_mid;
+    vector<double> _up_w;
+    vector<int64_t> _dn_ptr, _dn_v, _dn_mid;
+    vector<double> _dn_w;
+};
+
+struct build_contraction_hierarchy
+{
+    template <class Graph, class VertexIndex, class Weight>
+    void operator()(const Graph& g, VertexIndex vertex_index, Weight weight,
+                    contraction_hierarchy& ch, size_t limit) const
+    {
+        ch.build(g, vertex_index, weight, limit);
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_CONTRACTION_HIERARCHY_HH
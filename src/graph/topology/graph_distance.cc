@@ -18,8 +18,7 @@
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
 
-#include <boost/graph/breadth_first_search.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
+#include "search_workspace.hh"
 
 #include <boost/python.hpp>
 
@@ -27,80 +26,30 @@ using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
-struct stop_search {};
+// The searches run on the workspace of the calling thread, so that only the
+// vertices which are reached are visited, apart from the initialization of
+// the output distances.
 
-template <class DistMap, class PredMap>
-class bfs_max_visitor:
-    public boost::bfs_visitor<null_visitor>
+template <class DistMap, class PredMap, class Value>
+void copy_search(search_workspace<Value>& ws, DistMap dist_map,
+                 PredMap pred_map, size_t source)
 {
-public:
-    bfs_max_visitor(DistMap dist_map, PredMap pred, size_t max_dist, size_t target)
-        : _dist_map(dist_map), _pred(pred), _max_dist(max_dist), _target(target),
-          _dist(0) {}
-
-    template <class Graph>
-    void tree_edge(typename graph_traits<Graph>::edge_descriptor e,
-                   Graph& g)
+    for (auto i : ws.touched())
     {
-        _pred[target(e,g)] = source(e,g);
+        dist_map[i] = ws.dist(i);
+        if (i != source)
+            pred_map[i] = ws.pred(i);
     }
+}
 
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                        Graph&)
-    {
-        typedef typename property_traits<DistMap>::value_type val_t;
-        if ( _dist_map[v] > val_t(_max_dist))
-            throw stop_search();
-    }
-
-    template <class Graph>
-    void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                         Graph&)
-    {
-        if (size_t(_pred[v]) == v)
-            return;
-        _dist_map[v] = _dist_map[_pred[v]] + 1;
-        if (v == _target)
-            throw stop_search();
-    }
-
-private:
-    DistMap _dist_map;
-    PredMap _pred;
-    size_t _max_dist;
-    size_t _target;
-    size_t _dist;
-};
-
-template <class DistMap>
-class djk_max_visitor:
-    public boost::dijkstra_visitor<null_visitor>
+template <class Graph>
+typename graph_traits<Graph>::vertex_descriptor
+get_target(size_t target, const Graph& g)
 {
-public:
-    djk_max_visitor(DistMap dist_map,
-                    typename property_traits<DistMap>::value_type max_dist, size_t target)
-        : _dist_map(dist_map), _max_dist(max_dist), _target(target) {}
-
-
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor u,
-                        Graph&)
-    {
-        if (_dist_map[u] > _max_dist)
-            throw stop_search();
-
-        if (u == _target)
-            throw stop_search();
-    }
-
-
-private:
-    DistMap _dist_map;
-    typename property_traits<DistMap>::value_type _max_dist;
-    size_t _target;
-};
-
+    if (target == graph_traits<GraphInterface::multigraph_t>::null_vertex())
+        return graph_traits<Graph>::null_vertex();
+    return vertex(target, g);
+}
 
 struct do_bfs_search
 {
@@ -117,20 +66,11 @@ struct do_bfs_search
         #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
         for (i = 0; i < N; ++i)
             dist_map[i] = numeric_limits<dist_t>::max();
-        dist_map[source] = 0;
-
-        pred_map[vertex(source, g)] = vertex(source, g);
-        unchecked_vector_property_map<boost::default_color_type, VertexIndexMap>
-            color_map(vertex_index, num_vertices(g));
-        try
-        {
-            breadth_first_search(g, vertex(source, g),
-                                 visitor(bfs_max_visitor<DistMap, PredMap>
-                                         (dist_map, pred_map, max_d, target)).
-                                 vertex_index_map(vertex_index).
-                                 color_map(color_map));
-        }
-        catch (stop_search&) {}
+
+        auto& ws = get_search_workspace<dist_t>(N);
+        workspace_bfs(g, vertex_index, vertex(source, g), ws, max_d,
+                      get_target(target, g));
+        copy_search(ws, dist_map, pred_map, source);
     }
 };
 
@@ -150,19 +90,11 @@ struct do_djk_search
         #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
         for (i = 0; i < N; ++i)
             dist_map[i] = numeric_limits<dist_t>::max();
-        dist_map[source] = 0;
-
-        try
-        {
-            dijkstra_shortest_paths(g, vertex(source, g),
-                                    weight_map(weight).
-                                    distance_map(dist_map).
-                                    vertex_index_map(vertex_index).
-                                    predecessor_map(pred_map).
-                                    visitor(djk_max_visitor<DistMap>
-                                            (dist_map, max_d, target)));
-        }
-        catch (stop_search&) {}
+
+        auto& ws = get_search_workspace<dist_t>(N);
+        workspace_dijkstra(g, vertex_index, vertex(source, g), weight, ws,
+                           max_d, get_target(target, g));
+        copy_search(ws, dist_map, pred_map, source);
     }
 };
 
@@ -38,8 +38,6 @@ struct do_maximal_vertex_set
         typedef typename graph_traits<Graph>::edge_descriptor edge_t;
         typedef typename property_traits<VertexSet>::value_type wval_t;
 
-        uniform_real_distribution<> sample(0, 1);
-
         VertexSet marked(vertex_index, num_vertices(g));
         vector<vertex_t> vlist;
         double max_deg = 0, tmp_max_deg = 0;
@@ -60,6 +58,7 @@ struct do_maximal_vertex_set
             tmp.clear();
             tmp_max_deg = 0;
 
+            parallel_rng prng(rng);
             int i, N = vlist.size();
             #pragma omp parallel for default(shared) private(i)
             for (i = 0; i < N; ++i)
@@ -90,10 +89,7 @@ struct do_maximal_vertex_set
                     else
                         p = 1. / (2 * out_degree(v, g));
 
-                    #pragma omp critical
-                    {
-                        r = sample(rng);
-                    }
+                    r = uniform_real_distribution<>()(prng.get());
                     if (r < p)
                         include = true;
                 }
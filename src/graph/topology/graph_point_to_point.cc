@@ -0,0 +1,122 @@
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "random.hh"
+
+#include "graph_point_to_point.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+typedef boost::mpl::push_back<edge_scalar_properties, unit_weight_map_t>::type
+    p2p_weight_props_t;
+
+typedef property_map_type
+    ::apply<vector<double>, GraphInterface::vertex_index_map_t>::type lm_map_t;
+
+typedef property_map_type
+    ::apply<int64_t, GraphInterface::vertex_index_map_t>::type pred_map_t;
+
+boost::any get_p2p_weight(boost::any weight)
+{
+    if (weight.empty())
+        return unit_weight_map_t(1);
+    if (!belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+    return weight;
+}
+
+lm_map_t get_lm_map(boost::any alm)
+{
+    if (alm.empty())
+        return lm_map_t();
+    try
+    {
+        return any_cast<lm_map_t>(alm);
+    }
+    catch (bad_any_cast&)
+    {
+        throw ValueException("landmark distances must be a vertex property "
+                             "map of type vector<double>");
+    }
+}
+
+python::object do_get_p2p_distance(GraphInterface& gi, size_t source,
+                                   size_t target, boost::any weight,
+                                   boost::any alm, boost::any apred)
+{
+    lm_map_t lm = get_lm_map(alm);
+    pred_map_t pred;
+    if (!apred.empty())
+        pred = any_cast<pred_map_t>(apred);
+
+    python::object ret;
+    run_action<>()
+        (gi, std::bind(get_p2p_distance(), placeholders::_1,
+                       gi.GetVertexIndex(), placeholders::_2,
+                       lm.get_unchecked(), !alm.empty(), source, target,
+                       pred.get_unchecked(), !apred.empty(), std::ref(ret)),
+         p2p_weight_props_t())(get_p2p_weight(weight));
+    return ret;
+}
+
+void do_get_p2p_distances(GraphInterface& gi, python::object osources,
+                          python::object otargets, boost::any weight,
+                          boost::any alm, python::object odists)
+{
+    lm_map_t lm = get_lm_map(alm);
+    multi_array_ref<int64_t,1> sources = get_array<int64_t,1>(osources);
+    multi_array_ref<int64_t,1> targets = get_array<int64_t,1>(otargets);
+    multi_array_ref<double,1> dists = get_array<double,1>(odists);
+
+    run_action<>()
+        (gi, std::bind(get_p2p_distances(), placeholders::_1,
+                       gi.GetVertexIndex(), placeholders::_2,
+                       lm.get_unchecked(), !alm.empty(), std::ref(sources),
+                       std::ref(targets), std::ref(dists)),
+         p2p_weight_props_t())(get_p2p_weight(weight));
+}
+
+python::object do_get_landmark_distances(GraphInterface& gi, boost::any weight,
+                                         boost::any alm,
+                                         python::object olandmarks, size_t n,
+                                         rng_t& rng)
+{
+    lm_map_t lm = get_lm_map(alm);
+    multi_array_ref<int64_t,1> alandmarks = get_array<int64_t,1>(olandmarks);
+    vector<int64_t> landmarks(alandmarks.begin(), alandmarks.end());
+
+    run_action<>()
+        (gi, std::bind(get_landmark_distances(), placeholders::_1,
+                       gi.GetVertexIndex(), placeholders::_2,
+                       lm.get_unchecked(num_vertices(gi.GetGraph())),
+                       std::ref(landmarks), n, std::ref(rng)),
+         p2p_weight_props_t())(get_p2p_weight(weight));
+    return wrap_vector_owned(landmarks);
+}
+
+void export_point_to_point()
+{
+    python::def("get_p2p_distance", &do_get_p2p_distance);
+    python::def("get_p2p_distances", &do_get_p2p_distances);
+    python::def("get_landmark_distances", &do_get_landmark_distances);
+}
@@ -0,0 +1,553 @@
+// Copyright (C) 2006-2014 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_POINT_TO_POINT_HH
+#define GRAPH_POINT_TO_POINT_HH
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "numpy_bind.hh"
+#include "search_workspace.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+typedef ConstantPropertyMap<int32_t, GraphInterface::edge_t> unit_weight_map_t;
+
+// Point-to-point shortest paths, with bidirectional searches from the source
+// and the target, which stop as soon as the shortest path is known, instead
+// of exploring everything closer to the source than the target.
+//
+// Unweighted searches alternate complete BFS levels, always expanding the
+// smaller frontier. Weighted searches are bidirectional Dijkstra, optionally
+// goal-directed with the landmark (ALT) lower bounds [goldberg-computing-2005]:
+// for every landmark l the distances d(l, v) and d(v, l) are stored at
+// positions 2l and 2l + 1 of the vector of every vertex v, which yield lower
+// bounds pi_t(v) <= d(v, t) and pi_s(v) <= d(s, v) from the triangle
+// inequality. Both searches then run on the edge lengths reduced by the
+// potential p(v) = (pi_t(v) - pi_s(v)) / 2, which remain non-negative, so that
+// they are steered towards each other. Vertices which the bounds show to be
+// unreachable from the source or unable to reach the target are skipped.
+//
+// The distances, colors and heap positions of both searches are kept in
+// search workspaces of the calling thread, and the cost of a query is
+// proportional to the explored part of the graph only.
+//
+// [goldberg-computing-2005] A. V. Goldberg and C. Harrelson, "Computing the
+// shortest path: A* search meets graph theory", Proceedings of the 16th
+// Annual ACM-SIAM Symposium on Discrete Algorithms, 156-165 (2005).
+
+template <class Graph, class VertexIndex, class Weight, class LandmarkMap>
+class p2p_search
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+    typedef typename property_traits<Weight>::value_type wval_t;
+    typedef typename std::common_type<wval_t, double>::type val_t;
+    typedef search_workspace<val_t> ws_t;
+    typedef search_workspace<double> pot_t;
+
+    static const bool unit = std::is_same<Weight, unit_weight_map_t>::value;
+
+    p2p_search(const Graph& g, VertexIndex vertex_index, Weight weight,
+               LandmarkMap lm, bool alt)
+        : _g(g), _vertex_index(vertex_index), _weight(weight), _lm(lm),
+          _alt(alt), _fwd(get_search_workspace<val_t, 0>(num_vertices(g))),
+          _bwd(get_search_workspace<val_t, 1>(num_vertices(g))),
+          _pot(get_search_workspace<double, 2>(num_vertices(g))) {}
+
+    static val_t inf() { return numeric_limits<val_t>::infinity(); }
+
+    // Returns the distance from s to t, or infinity if t is unreachable.
+    val_t run(vertex_t s, vertex_t t)
+    {
+        _fwd.reset();
+        _bwd.reset();
+        _pot.reset();
+        _is = get(_vertex_index, s);
+        _it = get(_vertex_index, t);
+        _meet_u = _meet_w = numeric_limits<size_t>::max();
+
+        if (_is == _it)
+        {
+            _meet_u = _meet_w = _is;
+            return 0;
+        }
+
+        if (_alt)
+        {
+            _ls = &_lm[s];
+            _lt = &_lm[t];
+            _k = min(_ls->size(), _lt->size()) / 2;
+            if (!potential(s, _is) || !potential(t, _it))
+                return inf();
+        }
+
+        if (unit && !_alt)
+            return bfs();
+        return dijkstra();
+    }
+
+    // Sets pred[v] to the predecessor of every vertex v in the path found by
+    // the last query, if any.
+    template <class PredMap>
+    void get_path(PredMap pred)
+    {
+        if (_meet_u == numeric_limits<size_t>::max())
+            return;
+        for (size_t i = _meet_u; i != _is; i = _fwd.pred(i))
+            pred[vertex(i, _g)] = _fwd.pred(i);
+        if (_meet_w != _meet_u)
+            pred[vertex(_meet_w, _g)] = _meet_u;
+        for (size_t i = _meet_w; i != _it; i = _bwd.pred(i))
+            pred[vertex(_bwd.pred(i), _g)] = i;
+    }
+
+    // Plain single-source search from s, following the edges backwards if
+    // 'backward' is true, which is used to compute the landmark distances.
+    // The results remain in the returned workspace until the next search.
+    const ws_t& sweep(vertex_t s, bool backward)
+    {
+        bool alt = _alt;
+        _alt = false;
+        _fwd.reset();
+        _bwd.reset();
+        size_t is = get(_vertex_index, s);
+        _fwd.discover(is, 0, is);
+        val_t mu = inf();
+        if (unit)
+        {
+            std::vector<size_t>& queue = _fwd.queue();
+            queue.clear();
+            queue.push_back(is);
+            size_t head = 0;
+            while (head < queue.size())
+                bfs_level(queue, head, _fwd, _bwd, backward, mu);
+        }
+        else
+        {
+            heap_t queue(_fwd.get_dist_map(), _fwd.get_pos_map());
+            queue.push(is);
+            while (!queue.empty())
+                scan(queue, _fwd, _bwd, backward, mu, 0, 0);
+        }
+        _alt = alt;
+        return _fwd;
+    }
+
+private:
+    typedef d_ary_heap_indirect<size_t, 4, typename ws_t::pos_map_t,
+                                typename ws_t::dist_map_t, std::less<val_t>>
+        heap_t;
+
+    // calls f(e, u) for the out-edges of v, or for its in-edges if
+    // 'backward' is true, where u is the other endpoint
+    template <class F>
+    void for_each_edge(vertex_t v, bool backward, F&& f)
+    {
+        if (backward)
+        {
+            typename in_or_out_edge_iteratorS<Graph>::type e, e_end;
+            for (tie(e, e_end) = in_or_out_edge_iteratorS<Graph>::get_edges(v, _g);
+                 e != e_end; ++e)
+            {
+                if (is_directed::apply<Graph>::type::value)
+                    f(*e, boost::source(*e, _g));
+                else
+                    f(*e, boost::target(*e, _g));
+            }
+        }
+        else
+        {
+            typename graph_traits<Graph>::out_edge_iterator e, e_end;
+            for (tie(e, e_end) = out_edges(v, _g); e != e_end; ++e)
+                f(*e, boost::target(*e, _g));
+        }
+    }
+
+    static void bound(double& b, double x, double y)
+    {
+        if (std::isinf(y))
+            return;
+        b = max(b, x - y);
+    }
+
+    // Computes and caches the potential of v, and returns false if v cannot
+    // lie on a path from s to t.
+    bool potential(vertex_t v, size_t i)
+    {
+        if (_pot.color(i) != pot_t::WHITE)
+            return _pot.color(i) == pot_t::GRAY;
+        const auto& x = _lm[v];
+        const auto& xs = *_ls;
+        const auto& xt = *_lt;
+        double to_t = 0, from_s = 0;
+        for (size_t l = 0; l < _k; ++l)
+        {
+            bound(to_t, x[2 * l + 1], xt[2 * l + 1]);
+            bound(to_t, xt[2 * l], x[2 * l]);
+            bound(from_s, x[2 * l], xs[2 * l]);
+            bound(from_s, xs[2 * l + 1], x[2 * l + 1]);
+        }
+        _pot.discover(i, (to_t - from_s) / 2, i);
+        if (std::isinf(to_t) || std::isinf(from_s))
+        {
+            _pot.color(i) = pot_t::BLACK;
+            return false;
+        }
+        return true;
+    }
+
+    val_t p(size_t i) { return _alt ? _pot.dist(i) : 0; }
+
+    void meet(size_t i, size_t j, bool backward)
+    {
+        _meet_u = backward ? j : i;
+        _meet_w = backward ? i : j;
+    }
+
+    // Pops the closest vertex of one of the searches and relaxes its edges,
+    // recording the shortest path through every edge which reaches the
+    // other search. The stored distances are reduced by the potentials; the
+    // actual ones are recovered with ps = p(s) and pt = p(t).
+    void scan(heap_t& queue, ws_t& ws, ws_t& other, bool backward, val_t& mu,
+              val_t ps, val_t pt)
+    {
+        size_t i = queue.top();
+        queue.pop();
+        ws.color(i) = ws_t::BLACK;
+
+        val_t d = ws.dist(i);
+        val_t pi = p(i);
+        val_t di = backward ? d + pi - pt : d - pi + ps;
+        for_each_edge(vertex(i, _g), backward,
+                      [&](const edge_t& e, vertex_t u)
+                      {
+                          size_t j = get(_vertex_index, u);
+                          if (_alt && !potential(u, j))
+                              return;
+                          val_t w = get(_weight, e);
+                          if (w < 0)
+                              throw ValueException("the edge weights must be "
+                                                   "non-negative");
+                          if (other.color(j) != ws_t::WHITE)
+                          {
+                              val_t dj = backward ?
+                                  other.dist(j) - p(j) + ps :
+                                  other.dist(j) + p(j) - pt;
+                              if (di + w + dj < mu)
+                              {
+                                  mu = di + w + dj;
+                                  meet(i, j, backward);
+                              }
+                          }
+                          if (ws.color(j) == ws_t::BLACK)
+                              return;
+                          val_t rw = backward ? w + pi - p(j) : w + p(j) - pi;
+                          val_t nd = d + max(rw, val_t(0));
+                          if (!(nd < ws.dist(j)))
+                              return;
+                          if (ws.color(j) == ws_t::WHITE)
+                          {
+                              ws.discover(j, nd, i);
+                              queue.push(j);
+                          }
+                          else
+                          {
+                              ws.dist(j) = nd;
+                              ws.pred(j) = i;
+                              queue.update(j);
+                          }
+                      });
+    }
+
+    // Bidirectional Dijkstra, which stops when the sum of the smallest
+    // distances in both queues reaches the (reduced) length of the shortest
+    // path found so far. The search with the smaller queue is advanced.
+    val_t dijkstra()
+    {
+        heap_t qf(_fwd.get_dist_map(), _fwd.get_pos_map());
+        heap_t qb(_bwd.get_dist_map(), _bwd.get_pos_map());
+        val_t ps = p(_is), pt = p(_it);
+        _fwd.discover(_is, 0, _is);
+        qf.push(_is);
+        _bwd.discover(_it, 0, _it);
+        qb.push(_it);
+
+        val_t mu = inf();
+        while (!qf.empty() && !qb.empty())
+        {
+            if (_fwd.dist(qf.top()) + _bwd.dist(qb.top()) >= mu - ps + pt)
+                break;
+            if (qf.size() <= qb.size())
+                scan(qf, _fwd, _bwd, false, mu, ps, pt);
+            else
+                scan(qb, _bwd, _fwd, true, mu, ps, pt);
+        }
+
+        if (std::is_integral<wval_t>::value && mu != inf())
+            mu = std::round(mu);
+        return mu;
+    }
+
+    // Expands a whole BFS level of one of the searches.
+    void bfs_level(std::vector<size_t>& queue, size_t& head, ws_t& ws,
+                   ws_t& other, bool backward, val_t& mu)
+    {
+        size_t end = queue.size();
+        for (; head < end; ++head)
+        {
+            size_t i = queue[head];
+            val_t d = ws.dist(i) + 1;
+            for_each_edge(vertex(i, _g), backward,
+                          [&](const edge_t&, vertex_t u)
+                          {
+                              size_t j = get(_vertex_index, u);
+                              if (other.color(j) != ws_t::WHITE &&
+                                  d + other.dist(j) < mu)
+                              {
+                                  mu = d + other.dist(j);
+                                  meet(i, j, backward);
+                              }
+                              if (ws.color(j) != ws_t::WHITE)
+                                  return;
+                              ws.discover(j, d, i);
+                              queue.push_back(j);
+                          });
+            ws.color(i) = ws_t::BLACK;
+        }
+    }
+
+    // Bidirectional BFS: once a level reaches the other search, every path
+    // it can complete is no longer than any path found later.
+    val_t bfs()
+    {
+        std::vector<size_t>& qf = _fwd.queue();
+        std::vector<size_t>& qb = _bwd.queue();
+        qf.clear();
+        qb.clear();
+        _fwd.discover(_is, 0, _is);
+        qf.push_back(_is);
+        _bwd.discover(_it, 0, _it);
+        qb.push_back(_it);
+
+        size_t hf = 0, hb = 0;
+        val_t mu = inf();
+        while (hf < qf.size() && hb < qb.size())
+        {
+            if (qf.size() - hf <= qb.size() - hb)
+                bfs_level(qf, hf, _fwd, _bwd, false, mu);
+            else
+                bfs_level(qb, hb, _bwd, _fwd, true, mu);
+            if (mu != inf())
+                break;
+        }
+        return mu;
+    }
+
+    const Graph& _g;
+    VertexIndex _vertex_index;
+    Weight _weight;
+    LandmarkMap _lm;
+    bool _alt;
+    ws_t& _fwd;
+    ws_t& _bwd;
+    pot_t& _pot;
+    size_t _is, _it;
+    size_t _meet_u, _meet_w;
+    const std::vector<double>* _ls;
+    const std::vector<double>* _lt;
+    size_t _k;
+};
+
+// converts a distance to the value type of the weights, with the maximum
+// value for unreachable vertices, as in the other distance functions
+template <class Value, class Dist>
+Value p2p_dist_value(Dist d)
+{
+    if (std::isinf(d))
+        return numeric_limits<Value>::max();
+    return Value(d);
+}
+
+struct get_p2p_distance
+{
+    template <class Graph, class VertexIndex, class Weight, class LandmarkMap,
+              class PredMap>
+    void operator()(const Graph& g, VertexIndex vertex_index, Weight weight,
+                    LandmarkMap lm, bool alt, size_t source, size_t target,
+                    PredMap pred, bool path, python::object& ret) const
+    {
+        typedef p2p_search<Graph, VertexIndex, Weight, LandmarkMap> search_t;
+        search_t search(g, vertex_index, weight, lm, alt);
+        auto d = search.run(vertex(source, g), vertex(target, g));
+        if (path)
+            search.get_path(pred);
+        ret = python::object(p2p_dist_value<typename search_t::wval_t>(d));
+    }
+};
+
+// Distances between the pairs (sources[i], targets[i]), which are distributed
+// among the threads. Unreachable pairs get an infinite distance.
+struct get_p2p_distances
+{
+    template <class Graph, class VertexIndex, class Weight, class LandmarkMap>
+    void operator()(const Graph& g, VertexIndex vertex_index, Weight weight,
+                    LandmarkMap lm, bool alt,
+                    multi_array_ref<int64_t,1>& sources,
+                    multi_array_ref<int64_t,1>& targets,
+                    multi_array_ref<double,1>& dists) const
+    {
+        typedef p2p_search<Graph, VertexIndex, Weight, LandmarkMap> search_t;
+        int i, n = sources.shape()[0];
+        string err;
+        #pragma omp parallel private(i) if (n > 1)
+        {
+            search_t search(g, vertex_index, weight, lm, alt);
+            #pragma omp for schedule(runtime)
+            for (i = 0; i < n; ++i)
+            {
+                try
+                {
+                    dists[i] = search.run(vertex(sources[i], g),
+                                          vertex(targets[i], g));
+                }
+                catch (ValueException& e)
+                {
+                    #pragma omp critical
+                    err = e.what();
+                }
+            }
+        }
+        if (!err.empty())
+            throw ValueException(err);
+    }
+};
+
+// Distances from and to the given landmarks, or to n landmarks selected by
+// the farthest-point heuristic: starting from a random vertex, the next
+// landmark is always the vertex with the largest round-trip distance to the
+// closest landmark chosen so far, preferring those not connected to any of
+// them. The searches of the given landmarks are run in parallel.
+struct get_landmark_distances
+{
+    template <class Graph, class VertexIndex, class Weight, class LandmarkMap,
+              class RNG>
+    void operator()(const Graph& g, VertexIndex vertex_index, Weight weight,
+                    LandmarkMap lm, vector<int64_t>& landmarks, size_t n,
+                    RNG& rng) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef p2p_search<Graph, VertexIndex, Weight, LandmarkMap> search_t;
+        const bool directed = is_directed::apply<Graph>::type::value;
+
+        vector<vertex_t> vs;
+        for (size_t i = 0; i < num_vertices(g); ++i)
+        {
+            vertex_t v = vertex(i, g);
+            if (v != graph_traits<Graph>::null_vertex())
+                vs.push_back(v);
+        }
+
+        bool select = landmarks.empty();
+        if (select)
+            n = min(n, vs.size());
+        else
+            n = landmarks.size();
+
+        int i, N = vs.size();
+        #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
+        for (i = 0; i < N; ++i)
+            lm[vs[i]].assign(2 * n, numeric_limits<double>::infinity());
+
+        // stores the distances of landmark l, and returns the round-trip
+        // distances to it
+        auto store = [&](search_t& search, size_t l, bool backward)
+            {
+                const auto& ws = search.sweep(vertex(landmarks[l], g),
+                                              backward);
+                for (auto j : ws.touched())
+                {
+                    auto& x = lm[vertex(j, g)];
+                    x[2 * l + size_t(backward)] = ws.dist(j);
+                    if (!directed)
+                        x[2 * l + 1] = ws.dist(j);
+                }
+            };
+
+        if (!select)
+        {
+            int M = directed ? 2 * n : n;
+            #pragma omp parallel private(i) if (M > 1 && N > 100)
+            {
+                search_t search(g, vertex_index, weight, lm, false);
+                #pragma omp for schedule(runtime)
+                for (i = 0; i < M; ++i)
+                    store(search, i / (directed ? 2 : 1),
+                          directed && (i % 2 == 1));
+            }
+            return;
+        }
+
+        search_t search(g, vertex_index, weight, lm, false);
+        vector<double> score(num_vertices(g),
+                             numeric_limits<double>::infinity());
+        uniform_int_distribution<size_t> random_v(0, vs.size() - 1);
+        vertex_t v = vs[random_v(rng)];
+        for (size_t l = 0; l < n; ++l)
+        {
+            landmarks.push_back(get(vertex_index, v));
+            store(search, l, false);
+            if (directed)
+                store(search, l, true);
+
+            double max_score = -1;
+            for (auto u : vs)
+            {
+                const auto& x = lm[u];
+                size_t j = get(vertex_index, u);
+                score[j] = min(score[j], x[2 * l] + x[2 * l + 1]);
+                if (score[j] > max_score)
+                {
+                    max_score = score[j];
+                    v = u;
+                }
+            }
+            if (max_score <= 0)
+                break;
+        }
+
+        // drop the unused entries if fewer landmarks were found
+        if (landmarks.size() < lm[vs[0]].size() / 2)
+        {
+            #pragma omp parallel for default(shared) private(i) schedule(runtime) if (N > 100)
+            for (i = 0; i < N; ++i)
+                lm[vs[i]].resize(2 * landmarks.size());
+        }
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_POINT_TO_POINT_HH
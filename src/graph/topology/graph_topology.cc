@@ -57,6 +57,8 @@ void export_all_dists();
 void export_diam();
 void export_random_matching();
 void export_maximal_vertex_set();
+void export_point_to_point();
+void export_contraction_hierarchy();
 
 
 BOOST_PYTHON_MODULE(libgraph_tool_topology)
@@ -83,4 +85,6 @@ BOOST_PYTHON_MODULE(libgraph_tool_topology)
     export_diam();
     export_random_matching();
     export_maximal_vertex_set();
+    export_point_to_point();
+    export_contraction_hierarchy();
 }
@@ -35,6 +35,7 @@ Summary
    PropertyMap
    PropertyArray
    load_graph
+   load_graph_from_edge_list
    group_vector_property
    ungroup_vector_property
    infect_vertex_property
@@ -117,11 +118,13 @@ from inspect import ismethod
 __all__ = ["Graph", "GraphView", "Vertex", "Edge", "Vector_bool",
            "Vector_int16_t", "Vector_int32_t", "Vector_int64_t", "Vector_double",
            "Vector_long_double", "Vector_string", "value_types", "load_graph",
+           "load_graph_from_edge_list",
            "PropertyMap", "group_vector_property", "ungroup_vector_property",
            "infect_vertex_property", "edge_difference", "perfect_prop_hash",
            "seed_rng", "show_config", "PropertyArray", "openmp_enabled",
            "openmp_get_num_threads", "openmp_set_num_threads", "openmp_get_schedule",
-           "openmp_set_schedule", "__author__", "__copyright__", "__URL__",
+           "openmp_set_schedule", "openmp_get_degree_balance",
+           "openmp_set_degree_balance", "__author__", "__copyright__", "__URL__",
            "__version__"]
 
 # this is rather pointless, but it works around a sphinx bug
@@ -248,6 +251,7 @@ def show_config():
     print("install prefix:", info.install_prefix)
     print("python dir:", info.python_dir)
     print("graph filtering:", libcore.graph_filtering_enabled())
+    print("index bits:", libcore.get_index_bits())
     print("openmp:", libcore.openmp_enabled())
     print("uname:", " ".join(os.uname()))
 
@@ -757,6 +761,43 @@ class PropertyMap(object):
         self.__register_map()
 
 
+class _DeferredPropertyMap(PropertyMap):
+    """Property map whose values are read from the file in which the graph was
+    stored only when it is first accessed (see :meth:`Graph.load`)."""
+
+    def __init__(self, g, key_type, value_type, file_name, state):
+        PropertyMap.__init__(self, None, g, key_type)
+        self.__value_type = value_type
+        self.__file_name = file_name
+        self.__state = state
+
+    def __get_map(self):
+        if self.__state is not None:
+            g = self.get_graph()
+            self.__map = g._Graph__graph.ReadDeferredProperty(self.__file_name,
+                                                              self.key_type(),
+                                                              self.__state)
+            self.__state = None
+        return self.__map
+
+    def __set_map(self, pmap):
+        self.__map = pmap
+        self.__state = None
+
+    _PropertyMap__map = property(__get_map, __set_map)
+
+    def value_type(self):
+        """Return the value type of the map."""
+        if self.__state is not None:
+            return self.__value_type
+        return PropertyMap.value_type(self)
+
+
+# value type of the vertex and edge index maps, which depends on the index width
+# chosen at compile time (see show_config())
+_index_type = "unsigned int" if libcore.get_index_bits() == 32 else "unsigned long"
+
+
 def _check_prop_writable(prop, name=None):
     if not prop.is_writable():
         raise ValueError("property map%s is not writable." %\
@@ -764,7 +805,7 @@ def _check_prop_writable(prop, name=None):
 
 
 def _check_prop_scalar(prop, name=None, floating=False):
-    scalars = ["bool", "int32_t", "int64_t", "unsigned long",
+    scalars = ["bool", "int32_t", "int64_t", _index_type,
                "double", "long double"]
     if floating:
         scalars = ["double", "long double"]
@@ -776,7 +817,7 @@ def _check_prop_scalar(prop, name=None, floating=False):
 
 
 def _check_prop_vector(prop, name=None, scalar=True, floating=False):
-    scalars = ["bool", "int32_t", "int64_t", "unsigned long",
+    scalars = ["bool", "int32_t", "int64_t", _index_type,
                "double", "long double"]
     if not scalar:
         scalars += ["string"]
@@ -1007,7 +1048,7 @@ def edge_difference(g, prop, ediff=None):
      -44 -16  -8 -13   9 -29  10 -62 -26 -47 -44   3]
     """
     val_t = prop.value_type()
-    if val_t == "unsigned long":
+    if val_t == _index_type:
         val_t = "int32_t"
     if ediff is None:
         ediff = g.new_edge_property(val_t)
@@ -1520,6 +1561,33 @@ class Graph(object):
         enabled."""
         return self.__graph.GetKeepEpos()
 
+    def freeze(self):
+        r"""Pack the adjacency lists into a contiguous, compressed-sparse-row
+        layout, which reduces memory usage and speeds up traversals, since
+        every vertex no longer needs its own separately allocated edge
+        lists. This is most useful before running read-only algorithms on
+        large graphs. The graph remains fully usable, and any modification of
+        it will automatically revert it to the mutable layout (see
+        :meth:`~Graph.thaw`).
+
+        .. note::
+
+           This operation is :math:`O(V + E)`, and does not change the vertex
+           or edge indexes, or the ordering of the edges.
+        """
+        self.__graph.SetFrozen(True)
+
+    def thaw(self):
+        r"""Revert the effects of :meth:`~Graph.freeze`, i.e. restore the
+        per-vertex adjacency lists, which allow for efficient
+        modification. This is done automatically when the graph is modified."""
+        self.__graph.SetFrozen(False)
+
+    def is_frozen(self):
+        r"""Return whether the graph is currently frozen (see
+        :meth:`~Graph.freeze`)."""
+        return self.__graph.GetFrozen()
+
     def clear(self):
         """Remove all vertices and edges from the graph."""
         self.__check_perms("del_vertex")
@@ -1608,6 +1676,13 @@ class Graph(object):
     gp = property(__get_graph_properties,
                   doc="Alias to :attr:`~Graph.graph_properties`.")
 
+    def __read_deferred_properties(self, t):
+        # property maps which were not yet read from file must be read before
+        # the indexes change
+        for k, v in self.__properties.items():
+            if k[0] == t and isinstance(v, _DeferredPropertyMap):
+                v._PropertyMap__map
+
     def own_property(self, prop):
         """Return a version of the property map 'prop' (possibly belonging to
         another graph) which is owned by the current graph."""
@@ -1703,6 +1778,7 @@ class Graph(object):
            be usable, but their contents will still be tied to the old indexes,
            and thus may become scrambled.
         """
+        self.__read_deferred_properties("e")
         self.__graph.ReIndexEdges()
 
     # Property map creation
@@ -1808,7 +1884,7 @@ class Graph(object):
         return fmt
 
     def load(self, file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
-             ignore_gp=None):
+             ignore_gp=None, lazy=False, freeze=False):
         """Load graph from ``file_name`` (which can be either a string or a file-like
         object). The format is guessed from ``file_name``, or can be specified
         by ``fmt``, which can be either "gt", "graphml", "xml", "dot" or "gml".
@@ -1818,6 +1894,21 @@ class Graph(object):
         ``ignore_gp``, should contain a list of property names (vertex, edge or
         graph, respectively) which should be ignored when reading the file.
 
+        Uncompressed "gt" files are memory-mapped and decoded directly from
+        memory, which is considerably faster than reading them through a
+        stream.
+
+        If ``freeze == True``, the loaded graph will be frozen (see
+        :meth:`~Graph.freeze`), otherwise it is returned with the usual mutable
+        layout. The adjacency of "gt" files is decoded directly into the frozen
+        layout, so passing ``freeze=True`` avoids the :math:`O(V + E)` cost of
+        converting it back.
+
+        If ``lazy == True``, and the file is an uncompressed "gt" file, the
+        values of the vertex and edge property maps are not read with the
+        graph, but only when each property map is first accessed. The file must
+        not be modified until then.
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
@@ -1848,16 +1939,21 @@ class Graph(object):
             ignore_gp = []
         if isinstance(file_name, str):
             props = self.__graph.ReadFromFile(file_name, None, fmt, ignore_vp,
-                                              ignore_ep, ignore_gp)
+                                              ignore_ep, ignore_gp, lazy)
         else:
             props = self.__graph.ReadFromFile("", file_name, fmt, ignore_vp,
-                                              ignore_ep, ignore_gp)
+                                              ignore_ep, ignore_gp, lazy)
+        self.__graph.SetFrozen(freeze)
         for name, prop in props[0].items():
             self.vertex_properties[name] = PropertyMap(prop, self, "v")
         for name, prop in props[1].items():
             self.edge_properties[name] = PropertyMap(prop, self, "e")
         for name, prop in props[2].items():
             self.graph_properties[name] = PropertyMap(prop, self, "g")
+        for key, name, value_type, state in props[3]:
+            self.properties[(key, name)] = \
+                _DeferredPropertyMap(self, key, value_type,
+                                     os.path.abspath(file_name), state)
         if "_Graph__save__vfilter" in self.graph_properties:
             self.set_vertex_filter(self.vertex_properties["_Graph__save__vfilter"],
                                    self.graph_properties["_Graph__save__vfilter"])
@@ -1886,6 +1982,13 @@ class Graph(object):
            internal property maps are "gt" and "graphml". Because of this,
            they should be preferred over the other formats whenever possible.
 
+        .. note::
+
+           Files ending in ".gz" are written as a sequence of independently
+           compressed gzip blocks, which are compressed (and later
+           decompressed by :func:`~graph_tool.load_graph`) in parallel, if
+           OpenMP is enabled. The result is still a valid gzip file.
+
         """
 
         u = GraphView(self, reversed=self.is_reversed(), skip_vfilt=True,
@@ -2106,6 +2209,7 @@ class Graph(object):
     def purge_edges(self):
         """Remove all edges of the graph which are currently being filtered out,
         and return it to the unfiltered state. This operation is not reversible."""
+        self.__read_deferred_properties("e")
         self.__graph.PurgeEdges()
         self.set_edge_filter(None)
 
@@ -2175,7 +2279,7 @@ class Graph(object):
 
 
 def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
-               ignore_gp=None):
+               ignore_gp=None, lazy=False, freeze=False):
     """Load a graph from ``file_name`` (which can be either a string or a file-like object).
 
     The format is guessed from ``file_name``, or can be specified by ``fmt``,
@@ -2186,6 +2290,14 @@ def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
     ``ignore_gp``, should contain a list of property names (vertex, edge or
     graph, respectively) which should be ignored when reading the file.
 
+    If ``lazy == True``, the vertex and edge property maps of uncompressed "gt"
+    files are only read when they are first accessed (see
+    :meth:`~graph_tool.Graph.load`).
+
+    If ``freeze == True``, the graph is returned frozen (see
+    :meth:`~graph_tool.Graph.freeze`). This is faster for "gt" files, and is
+    useful if the graph will not be modified.
+
     .. warning::
 
        The only file formats which are capable of perfectly preserving the
@@ -2194,7 +2306,89 @@ def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
 
     """
     g = Graph()
-    g.load(file_name, fmt, ignore_vp, ignore_ep, ignore_gp)
+    g.load(file_name, fmt, ignore_vp, ignore_ep, ignore_gp, lazy, freeze)
+    return g
+
+
+def load_graph_from_edge_list(file_name, directed=True, fmt="text",
+                              delimiter=None, comment="#", skip_first=False,
+                              hashed=False, eprop_types=None, eprop_names=None,
+                              two_pass=False):
+    """Load a graph from an edge list in ``file_name`` (which can be either a
+    string or a file-like object).
+
+    If ``fmt == "text"``, each line of the file should contain the source and
+    target vertices of an edge, followed by the values of the edge properties,
+    separated by ``delimiter`` (a single character), or by white space if
+    ``delimiter`` is ``None``. Empty lines, and lines starting with
+    ``comment``, are ignored. If ``skip_first == True``, the first line of the
+    file which is neither empty nor a comment (e.g. a header) is also
+    ignored. If ``fmt`` is "int32" or "int64", the file should instead contain
+    only pairs of integers of the respective size, in native byte order.
+
+    If ``hashed == False``, the vertices are given as integer indexes,
+    otherwise they can be arbitrary strings, which are mapped to the vertex
+    indexes in the order they first appear, and are stored in the vertex
+    property map "name".
+
+    The types and names of the edge property maps, one for each additional
+    column, are given by the lists ``eprop_types`` and ``eprop_names``,
+    respectively. Only scalar and "string" types are supported.
+
+    The file is read in chunks, which are parsed in parallel, so that the
+    memory used is not significantly larger than the final graph. If
+    ``two_pass == True`` (which requires ``file_name`` to be a string) the file
+    is read twice: the first time to determine the degrees, and the second to
+    place the edges directly into their final positions. This avoids
+    reallocations, and the resulting graph is frozen (see
+    :meth:`~Graph.freeze`). In this case, the edges are indexed in order of
+    their source vertices, instead of the order in which they appear in the
+    file.
+
+    Examples
+    --------
+    >>> import tempfile
+    >>> f = tempfile.NamedTemporaryFile(mode="w", suffix=".csv")
+    >>> f.write("# exported edges\\nsource,target,weight\\na,b,1.5\\nb,c,2\\n")
+    52
+    >>> f.flush()
+    >>> g = gt.load_graph_from_edge_list(f.name, delimiter=",",
+    ...                                  skip_first=True, hashed=True,
+    ...                                  eprop_types=["double"],
+    ...                                  eprop_names=["weight"])
+    >>> f.close()
+    >>> print(g.vertex_properties["name"][g.vertex(2)])
+    c
+    >>> print(g.edge_properties["weight"].a)
+    [ 1.5  2. ]
+
+    """
+    if eprop_types is None:
+        eprop_types = []
+    if eprop_names is None:
+        eprop_names = ["c%d" % i for i in range(len(eprop_types))]
+    if len(eprop_names) != len(eprop_types):
+        raise ValueError("'eprop_names' and 'eprop_types' must have the same length")
+    if delimiter is None:
+        delimiter = ""
+    if comment is None:
+        comment = ""
+    eprop_types = [_type_alias(t) for t in eprop_types]
+
+    g = Graph(directed=directed)
+    if isinstance(file_name, str):
+        file_name = os.path.expanduser(file_name)
+        props = g._Graph__graph.ReadEdgeList(file_name, None, fmt, delimiter,
+                                             comment, skip_first, hashed,
+                                             eprop_types, two_pass)
+    else:
+        props = g._Graph__graph.ReadEdgeList("", file_name, fmt, delimiter,
+                                             comment, skip_first, hashed,
+                                             eprop_types, two_pass)
+    if hashed:
+        g.vertex_properties["name"] = PropertyMap(props[0], g, "v")
+    for name, prop in zip(eprop_names, props[1]):
+        g.edge_properties[name] = PropertyMap(prop, g, "e")
     return g
 
 
@@ -2446,9 +2640,14 @@ Vector_string.__repr__ = lambda self: repr(list(self))
 _rng = libcore.get_rng((numpy.random.randint(0, sys.maxsize) + os.getpid()) % sys.maxsize)
 
 def seed_rng(seed):
-    "Seed the random number generator used by graph-tool's algorithms."
+    """Seed the random number generator used by graph-tool's algorithms.
+
+    The random number generators used by the individual threads of parallel
+    algorithms are derived from this one, so that the results are
+    reproducible for the same seed and number of OpenMP threads."""
     import graph_tool
     graph_tool._rng = libcore.get_rng(int(seed))
+    libcore.clear_parallel_rng()
 
 def _get_rng():
     global _rng
@@ -2478,5 +2677,19 @@ def openmp_set_schedule(schedule, chunk=0):
     any of: `"static"`, `"dynamic"`, `"guided"`, `"auto"`."""
     return libcore.openmp_set_schedule(schedule, chunk)
 
+def openmp_get_degree_balance():
+    """Return `True` if the parallel loops over the vertices are balanced
+    according to the vertex degrees."""
+    return libcore.openmp_get_degree_balance()
+
+def openmp_set_degree_balance(balance):
+    """Set whether the parallel loops over the vertices should be balanced
+    according to the vertex degrees. If `True`, the vertices are split into
+    blocks with approximately the same number of edges, which are distributed
+    dynamically among the threads, instead of following the runtime schedule
+    set with :func:`openmp_set_schedule`. This is useful for graphs with very
+    heterogeneous degrees."""
+    return libcore.openmp_set_degree_balance(balance)
+
 if openmp_enabled() and os.environ.get("OMP_SCHEDULE") is None:
     openmp_set_schedule("static", 0)
@@ -31,6 +31,7 @@ Summary
    :nosignatures:
 
    pagerank
+   personalized_pagerank
    betweenness
    central_point_dominance
    closeness
@@ -49,18 +50,21 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_centrality")
 
-from .. import _prop, ungroup_vector_property
+from .. import _prop, _get_rng, ungroup_vector_property, Vertex
 from .. topology import shortest_distance
 import sys
 import numpy
 import numpy.linalg
+import scipy.sparse
 
-__all__ = ["pagerank", "betweenness", "central_point_dominance", "closeness",
-           "eigentrust", "eigenvector", "katz", "hits", "trust_transitivity"]
+__all__ = ["pagerank", "personalized_pagerank", "betweenness",
+           "central_point_dominance", "closeness", "eigentrust", "eigenvector",
+           "katz", "hits", "trust_transitivity"]
 
 
 def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
-             max_iter=None, ret_iter=False):
+             max_iter=None, ret_iter=False, asynchronous=False,
+             single_precision=False, changed=None):
     r"""
     Calculate the PageRank of each vertex.
 
@@ -85,6 +89,23 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
         If supplied, this will limit the total number of iterations.
     ret_iter : bool, optional (default: False)
         If true, the total number of iterations is also returned.
+    asynchronous : bool, optional (default: False)
+        If true, the values are updated in place (Gauss-Seidel), and only the
+        vertices whose in-neighbours changed significantly in the previous
+        sweep are updated again. For directed graphs this usually requires
+        fewer sweeps, but the results depend slightly on the order of the
+        updates, and hence on the number of threads.
+    single_precision : bool, optional (default: False)
+        If true, the intermediary per-vertex contributions are stored in single
+        precision, which reduces the memory traffic. In this case, ``epsilon``
+        should not be much smaller than :math:`10^{-7}` times the sum of the
+        PageRank values.
+    changed : iterable of pairs of vertices, optional (default: None)
+        Edges, as ``(source, target)`` pairs, which were inserted or removed
+        since ``prop`` was computed. If supplied, ``prop`` must contain the
+        PageRank values before the changes, which are then updated
+        incrementally, and ``ret_iter`` refers to the number of local updates
+        performed. The set of vertices must not have changed.
 
     Returns
     -------
@@ -131,7 +152,16 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
 
     The implemented algorithm progressively iterates the above equations, until
     it no longer changes, according to the parameter epsilon. It has a
-    topology-dependent running time.
+    topology-dependent running time. The terms :math:`PR(u)/d^{+}(u)` are
+    computed only once per vertex and iteration. With ``asynchronous=True``,
+    the updated values are used as soon as they are available, as in the
+    Gauss-Seidel method, and converged vertices are skipped.
+
+    If ``changed`` is given, the residuals of the previous values are computed
+    only for the vertices affected by the modified edges, and are then
+    propagated locally [zhang-approximate-2016]_ until they are all below
+    :math:`\epsilon/N`. The running time depends on the size of the change,
+    not of the graph.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -204,6 +234,9 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
     .. [lawrence-pagerank-1998] P. Lawrence, B. Sergey, M. Rajeev, W. Terry,
        "The pagerank citation ranking: Bringing order to the web", Technical
        report, Stanford University, 1998
+    .. [zhang-approximate-2016] H. Zhang, P. Lofgren, A. Goel, "Approximate
+       personalized PageRank on dynamic graphs", KDD'16, 1315-1324 (2016),
+       :doi:`10.1145/2939672.2939804`
     .. [Langville-survey-2005] A. N. Langville, C. D. Meyer, "A Survey of
        Eigenvector Methods for Web Information Retrieval", SIAM Review, vol. 47,
        no. 1, pp. 135-161, 2005, :DOI:`10.1137/S0036144503424786`
@@ -212,6 +245,21 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
     """
 
+    if changed is not None:
+        if prop is None:
+            raise ValueError("the previous PageRank values must be supplied " +
+                             "via 'prop' if 'changed' is given")
+        changed = numpy.asarray([(int(s), int(t)) for s, t in changed],
+                                dtype="int64").reshape((-1, 2))
+        ic = libgraph_tool_centrality.\
+                get_pagerank_update(g._Graph__graph, _prop("v", g, prop),
+                                    _prop("v", g, pers), _prop("e", g, weight),
+                                    changed, damping, epsilon)
+        if ret_iter:
+            return prop, ic
+        else:
+            return prop
+
     if max_iter == None:
         max_iter = 0
     if prop == None:
@@ -221,14 +269,132 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
     ic = libgraph_tool_centrality.\
             get_pagerank(g._Graph__graph, _prop("v", g, prop),
                          _prop("v", g, pers), _prop("e", g, weight),
-                         damping, epsilon, max_iter)
+                         damping, epsilon, max_iter, asynchronous,
+                         single_precision)
     if ret_iter:
         return prop, ic
     else:
         return prop
 
 
-def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
+def personalized_pagerank(g, pers, damping=0.85, weight=None, epsilon=1e-6,
+                          max_iter=None, push=False, ret_iter=False):
+    r"""
+    Calculate the personalized PageRank of each vertex, for several
+    personalization vectors at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    pers : :class:`~numpy.ndarray` or :mod:`scipy.sparse` matrix
+        Matrix of shape ``(N, k)`` with ``k`` personalization vectors in the
+        columns, where ``N`` is the number of vertices, and the rows correspond
+        to the vertex indexes. A one-dimensional array is treated as a single
+        vector.
+    damping : float, optional (default: 0.85)
+        Damping factor.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: 1e-6)
+        Convergence condition. If ``push == False``, the iteration will stop if
+        the total delta of all vertices are below this value, for every
+        vector. Otherwise, the residual of each vertex will be below this value
+        times its (weighted) out-degree.
+    max_iter : int, optional (default: None)
+        If supplied, this will limit the total number of iterations. It is
+        ignored if ``push == True``.
+    push : bool, optional (default: False)
+        If ``True``, the values are approximated with local pushes
+        [andersen-local-2006]_, starting from the nonzero entries of each
+        vector, which is much faster if they are few, and the graph is large.
+    ret_iter : bool, optional (default: False)
+        If true, the total number of iterations (or pushes, if ``push ==
+        True``) is also returned.
+
+    Returns
+    -------
+    pagerank : :class:`~numpy.ndarray`
+        Array of shape ``(N, k)`` with the PageRank values for each
+        personalization vector in the columns.
+
+    See Also
+    --------
+    pagerank: PageRank centrality
+
+    Notes
+    -----
+    The values are defined as in :func:`pagerank`, where the personalization
+    vector is given by each column of ``pers``.
+
+    If ``push == False``, all vectors are iterated simultaneously, with a
+    single traversal of the graph per iteration. The values of each vertex are
+    stored contiguously, so this is considerably faster than calling
+    :func:`pagerank` for each vector.
+
+    If ``push == True``, each vector is computed independently, with a running
+    time which depends only on the neighbourhood of its nonzero entries, and on
+    ``epsilon``, but not on the size of the graph. The result is a lower bound
+    to the exact values.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["polblogs"]
+    >>> pers = np.zeros((g.num_vertices(), 2))
+    >>> pers[0, 0] = pers[1, 1] = 1
+    >>> pr = gt.personalized_pagerank(g, pers, push=True)
+    >>> print(pr.shape)
+    (1490, 2)
+
+    References
+    ----------
+    .. [andersen-local-2006] R. Andersen, F. Chung, K. Lang, "Local graph
+       partitioning using PageRank vectors", FOCS'06, 475-486 (2006),
+       :doi:`10.1109/FOCS.2006.44`
+    """
+
+    N = g._Graph__graph.GetNumberOfVertices(False)
+    if scipy.sparse.issparse(pers):
+        shape = pers.shape
+    else:
+        pers = numpy.asarray(pers, dtype="double")
+        shape = pers.shape
+        if len(shape) == 1:
+            pers = pers.reshape((shape[0], 1))
+    if pers.shape[0] != N:
+        raise ValueError("personalization matrix must have %d rows" % N)
+
+    ret = numpy.zeros(pers.shape, dtype="double")
+    if push:
+        pers = scipy.sparse.csc_matrix(pers)
+        pers.sort_indices()
+        ic = libgraph_tool_centrality.\
+             get_pagerank_push(g._Graph__graph, _prop("e", g, weight),
+                               numpy.asarray(pers.indptr, dtype="int64"),
+                               numpy.asarray(pers.indices, dtype="int64"),
+                               numpy.asarray(pers.data, dtype="double"),
+                               ret, damping, epsilon)
+    else:
+        if scipy.sparse.issparse(pers):
+            pers = pers.toarray()
+        pers = numpy.ascontiguousarray(pers, dtype="double")
+        ret[:] = pers
+        if max_iter is None:
+            max_iter = 0
+        ic = libgraph_tool_centrality.\
+             get_pagerank_batch(g._Graph__graph, _prop("e", g, weight), pers,
+                                ret, damping, epsilon, max_iter)
+    ret = ret.reshape(shape)
+    if ret_iter:
+        return ret, ic
+    else:
+        return ret
+
+
+def betweenness(g, vprop=None, eprop=None, weight=None, norm=True,
+                samples=None, epsilon=None, confidence=0.95):
     r"""
     Calculate the betweenness centrality for each vertex and edge.
 
@@ -244,11 +410,26 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
         Edge property map corresponding to the weight value of each edge.
     norm : bool, optional (default: True)
         Whether or not the betweenness values should be normalized.
+    samples : int, optional (default: None)
+        If supplied, the values will be estimated from the shortest paths
+        starting from at most this number of randomly chosen source vertices
+        (pivots).
+    epsilon : float, optional (default: None)
+        If supplied, the values will be estimated from a number of pivots which
+        is increased until the error bound on the vertex betweenness (see
+        below) is smaller than this value, or until `samples` pivots are used,
+        if this parameter is also given.
+    confidence : float, optional (default: 0.95)
+        Probability with which the error bound on the estimated values holds.
 
     Returns
     -------
     vertex_betweenness : A vertex property map with the vertex betweenness values.
     edge_betweenness : An edge property map with the edge betweenness values.
+    error : float
+        Upper bound on the absolute error of the estimated vertex betweenness
+        values, which holds for all vertices with probability `confidence`.
+        Only returned if `samples` or `epsilon` are given.
 
     See Also
     --------
@@ -278,7 +459,18 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
     complexity of :math:`O(VE)` for unweighted graphs and :math:`O(VE + V(V+E)
     \log V)` for weighted graphs. The space complexity is :math:`O(VE)`.
 
-    If enabled during compilation, this algorithm runs in parallel.
+    If `samples` or `epsilon` are given, the values are instead estimated from
+    the shortest paths starting from a uniformly sampled set of :math:`k`
+    pivots, and rescaled by :math:`V/k`, as described in
+    [brandes-centrality-2007]_. This reduces the complexity to :math:`O(kE)`
+    for unweighted graphs. The returned error bound is based on the empirical
+    variance of the values obtained from each pivot [audibert-exploration-2009]_.
+    If `epsilon` is given, the number of pivots is doubled until the bound
+    becomes smaller than `epsilon`.
+
+    If enabled during compilation, this algorithm runs in parallel. Each
+    thread keeps its own copy of the vertex and edge values, which requires
+    additional :math:`O(V + E)` memory per thread.
 
     Examples
     --------
@@ -314,11 +506,88 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
 
        Betweenness values of the a political blogs network of [adamic-polblogs]_.
 
+    For small graphs the values are easily verified by hand. In a path, the
+    middle vertex lies on the shortest paths between four pairs of vertices,
+    and the middle edges on those between six pairs (including their
+    endpoints):
+
+    .. doctest:: betweenness_exact
+
+       >>> g = gt.Graph(directed=False)
+       >>> g.add_edge_list([(0, 1), (1, 2), (2, 3), (3, 4)])
+       >>> vb, eb = gt.betweenness(g, norm=False)
+       >>> print(np.round(vb.a, 3).tolist())
+       [0.0, 3.0, 4.0, 3.0, 0.0]
+       >>> print(np.round(eb.a, 3).tolist())
+       [4.0, 6.0, 6.0, 4.0]
+       >>> vb, eb = gt.betweenness(g)
+       >>> print(np.round(vb.a, 3).tolist())
+       [0.0, 0.5, 0.667, 0.5, 0.0]
+       >>> print(np.round(eb.a, 3).tolist())
+       [0.4, 0.6, 0.6, 0.4]
+       >>> g.set_directed(True)
+       >>> vb, eb = gt.betweenness(g)
+       >>> print(np.round(vb.a, 3).tolist())
+       [0.0, 0.25, 0.333, 0.25, 0.0]
+       >>> print(np.round(eb.a, 3).tolist())
+       [0.2, 0.3, 0.3, 0.2]
+
+    With weights, the pairs connected by several shortest paths are split
+    equally among them. Below, vertices 0 and 2 are connected both directly
+    and via vertex 1, and hence vertices 0 and 3 by two paths as well, both of
+    which pass through vertex 2:
+
+    .. doctest:: betweenness_exact
+
+       >>> g = gt.Graph(directed=False)
+       >>> g.add_edge_list([(0, 1), (1, 2), (0, 2), (2, 3)])
+       >>> w = g.new_edge_property("double")
+       >>> w.a = [1, 1, 2, 1]
+       >>> vb, eb = gt.betweenness(g, weight=w, norm=False)
+       >>> print(np.round(vb.a, 3).tolist())
+       [0.0, 1.0, 2.0, 0.0]
+       >>> print(np.round(eb.a, 3).tolist())
+       [2.0, 3.0, 1.0, 3.0]
+       >>> g.set_directed(True)
+       >>> vb, eb = gt.betweenness(g, weight=w)
+       >>> print(np.round(vb.a, 3).tolist())
+       [0.0, 0.167, 0.333, 0.0]
+       >>> print(np.round(eb.a, 3).tolist())
+       [0.167, 0.25, 0.083, 0.25]
+
+    The values estimated from a sample of pivots approach the exact ones, and
+    are reproducible for a given seed (see :func:`~graph_tool.seed_rng`):
+
+    .. doctest:: betweenness_sampled
+
+       >>> g = gt.lattice([10, 10])
+       >>> vb, eb = gt.betweenness(g)
+       >>> gt.seed_rng(42)
+       >>> svb, seb, err = gt.betweenness(g, samples=50)
+       >>> print(np.abs(svb.a - vb.a).max() < 0.05)
+       True
+       >>> print(np.abs(svb.a - vb.a).max() <= err)
+       True
+       >>> gt.seed_rng(42)
+       >>> svb2, seb2, err2 = gt.betweenness(g, samples=50)
+       >>> print(np.allclose(svb.a, svb2.a), np.allclose(seb.a, seb2.a))
+       True True
+       >>> svb, seb, err = gt.betweenness(g, samples=g.num_vertices())
+       >>> print(err, np.allclose(svb.a, vb.a), np.allclose(seb.a, eb.a))
+       0.0 True True
+
     References
     ----------
     .. [betweenness-wikipedia] http://en.wikipedia.org/wiki/Centrality#Betweenness_centrality
     .. [brandes-faster-2001] U. Brandes, "A faster algorithm for betweenness
        centrality", Journal of Mathematical Sociology, 2001, :doi:`10.1080/0022250X.2001.9990249`
+    .. [brandes-centrality-2007] U. Brandes and C. Pich, "Centrality
+       estimation in large networks", International Journal of Bifurcation and
+       Chaos, 2007, :doi:`10.1142/S0218127407018403`
+    .. [audibert-exploration-2009] J.-Y. Audibert, R. Munos and C. Szepesvári,
+       "Exploration-exploitation tradeoff using variance estimates in
+       multi-armed bandits", Theoretical Computer Science, 2009,
+       :doi:`10.1016/j.tcs.2009.01.016`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -331,12 +600,21 @@ def betweenness(g, vprop=None, eprop=None, weight=None, norm=True):
         nw = g.new_edge_property(eprop.value_type())
         g.copy_property(weight, nw)
         weight = nw
+    if samples is not None or epsilon is not None:
+        err = libgraph_tool_centrality.\
+            get_sampled_betweenness(g._Graph__graph, _prop("e", g, weight),
+                                    _prop("e", g, eprop), _prop("v", g, vprop),
+                                    norm, samples if samples is not None else 0,
+                                    epsilon if epsilon is not None else 0,
+                                    confidence, _get_rng())
+        return vprop, eprop, err
     libgraph_tool_centrality.\
             get_betweenness(g._Graph__graph, _prop("e", g, weight),
                             _prop("e", g, eprop), _prop("v", g, vprop), norm)
     return vprop, eprop
 
-def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False):
+def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False,
+              samples=None):
     r"""
     Calculate the closeness centrality for each vertex.
 
@@ -355,11 +633,18 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     harmonic : bool, optional (default: ``False``)
         If true, the sum of the inverse of the distances will be computed,
         instead of the inverse of the sum.
+    samples : int, optional (default: ``None``)
+        If supplied, the values will be estimated from the distances to at most
+        this number of randomly chosen vertices (pivots). This is only
+        supported for unweighted graphs, and is ignored if ``source`` is given.
 
     Returns
     -------
     vertex_closeness : :class:`~graph_tool.PropertyMap`
         A vertex property map with the vertex closeness values.
+    error : :class:`~graph_tool.PropertyMap`
+        A vertex property map with the standard error of the estimated
+        closeness values. Only returned if ``samples`` is given.
 
     See Also
     --------
@@ -399,7 +684,17 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     The algorithm complexity of :math:`O(N(N + E))` for unweighted graphs and
     :math:`O(N(N+E) \log N)` for weighted graphs. If the option ``source`` is
     specified, this drops to :math:`O(N + E)` and :math:`O((N+E)\log N)`
-    respectively.
+    respectively. For unweighted graphs, the searches are run from 64 vertices
+    at once with a multi-source BFS [then-more-2014]_, so that the edges of a
+    vertex reached by several of them at the same distance are scanned only
+    once.
+
+    If ``samples`` is given, the sums over all vertices are instead estimated
+    from the distances to a uniformly sampled set of :math:`k` pivots
+    [eppstein-fast-2004]_, which reduces the complexity to :math:`O(k(N +
+    E))`. The returned error of each vertex is the standard error of its
+    estimate, computed from the sample variance of the distances to the
+    pivots, which vanishes if all vertices are used as pivots.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -441,6 +736,13 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     .. [opsahl-node-2010] Opsahl, T., Agneessens, F., Skvoretz, J., "Node
        centrality in weighted networks: Generalizing degree and shortest
        paths". Social Networks 32, 245-251, 2010 :DOI:`10.1016/j.socnet.2010.03.006`
+    .. [then-more-2014] M. Then, M. Kaufmann, F. Chirigati, T.-A. Hoang-Vu,
+       K. Pham, A. Kemper, T. Neumann and H. T. Vo, "The more the merrier:
+       efficient multi-source graph traversal", Proceedings of the VLDB
+       Endowment 8, 449-460 (2014), :doi:`10.14778/2735496.2735507`
+    .. [eppstein-fast-2004] D. Eppstein and J. Wang, "Fast approximation of
+       centrality", Journal of Graph Algorithms and Applications 8, 39-45
+       (2004), :doi:`10.7155/jgaa.00081`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -449,6 +751,16 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
     if source is None:
         if vprop == None:
             vprop = g.new_vertex_property("double")
+        if samples is not None:
+            if weight is not None:
+                raise ValueError("sampled closeness is only supported for " +
+                                 "unweighted graphs")
+            err = g.new_vertex_property(vprop.value_type())
+            libgraph_tool_centrality.\
+                get_sampled_closeness(g._Graph__graph, _prop("v", g, vprop),
+                                      _prop("v", g, err), harmonic, norm,
+                                      samples, _get_rng())
+            return vprop, err
         libgraph_tool_centrality.\
             closeness(g._Graph__graph, _prop("e", g, weight),
                       _prop("v", g, vprop), harmonic, norm)
@@ -527,7 +839,8 @@ def central_point_dominance(g, betweenness):
                                        _prop("v", g, betweenness))
 
 
-def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
+def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None,
+                warm_start=False):
     r"""
     Calculate the eigenvector centrality of each vertex in the graph, as well as
     the largest eigenvalue.
@@ -542,10 +855,15 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
         Vertex property map where the values of eigenvector must be stored. If
         provided, it will be used uninitialized.
     epsilon : float, optional (default: ``1e-6``)
-        Convergence condition. The iteration will stop if the total delta of all
-        vertices are below this value.
+        Convergence condition. The iteration will stop if the relative residual
+        norm of the eigenvector is below this value.
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of matrix-vector
+        products.
+    warm_start : bool, optional (default: ``False``)
+        If ``True``, the values of ``vprop`` are used as the starting point,
+        e.g. the eigenvector computed before a small modification of the graph,
+        which then converges after only a few matrix-vector products.
 
     Returns
     -------
@@ -576,11 +894,15 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
     where :math:`\mathbf{A}` is the (weighted) adjacency matrix and
     :math:`\lambda` is the largest eigenvalue.
 
-    The algorithm uses the power method which has a topology-dependent complexity of
-    :math:`O\left(N\times\frac{-\log\epsilon}{\log|\lambda_1/\lambda_2|}\right)`,
-    where :math:`N` is the number of vertices, :math:`\epsilon` is the ``epsilon``
-    parameter, and :math:`\lambda_1` and :math:`\lambda_2` are the largest and
-    second largest eigenvalues of the (weighted) adjacency matrix, respectively.
+    The eigenvector is computed with the Lanczos method for undirected graphs,
+    and with the Arnoldi method for directed graphs [saad-numerical-2011]_,
+    using matrix-vector products computed directly on the graph. Each product
+    takes time :math:`O(V + E)`, and the number of products needed is typically
+    much smaller than the
+    :math:`O\left(\frac{-\log\epsilon}{\log|\lambda_1/\lambda_2|}\right)`
+    iterations of the power method, where :math:`\lambda_1` and
+    :math:`\lambda_2` are the largest and second largest eigenvalues of the
+    (weighted) adjacency matrix, respectively.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -622,11 +944,32 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
        Eigenvector values of the a political blogs network of
        [adamic-polblogs]_, with random weights attributed to the edges.
 
+    The largest eigenvalue can be repeated, e.g. for a graph with two identical
+    components, in which case any combination of their eigenvectors is
+    returned. This holds also when starting from a previous result:
+
+    .. doctest:: eigenvector_degenerate
+
+       >>> g = gt.graph_union(gt.complete_graph(20), gt.complete_graph(20))
+       >>> A = gt.adjacency(g)
+       >>> ee, x = gt.eigenvector(g)
+       >>> print(round(ee, 6))
+       19.0
+       >>> print(np.linalg.norm(A.dot(x.a) - ee * x.a) < 1e-4 * ee)
+       True
+       >>> ee, x = gt.eigenvector(g, vprop=x, warm_start=True)
+       >>> print(round(ee, 6))
+       19.0
+       >>> print(np.linalg.norm(A.dot(x.a) - ee * x.a) < 1e-4 * ee)
+       True
+
     References
     ----------
 
     .. [eigenvector-centrality] http://en.wikipedia.org/wiki/Centrality#Eigenvector_centrality
     .. [power-method] http://en.wikipedia.org/wiki/Power_iteration
+    .. [saad-numerical-2011] Y. Saad, "Numerical Methods for Large Eigenvalue
+       Problems", SIAM (2011), :DOI:`10.1137/1.9781611970739`
     .. [langville-survey-2005] A. N. Langville, C. D. Meyer, "A Survey of
        Eigenvector Methods for Web Information Retrieval", SIAM Review, vol. 47,
        no. 1, pp. 135-161, 2005, :DOI:`10.1137/S0036144503424786`
@@ -643,7 +986,8 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
         max_iter = 0
     ee = libgraph_tool_centrality.\
          get_eigenvector(g._Graph__graph, _prop("e", g, weight),
-                         _prop("v", g, vprop), epsilon, max_iter)
+                         _prop("v", g, vprop), epsilon, max_iter,
+                         warm_start, _get_rng())
     return ee, vprop
 
 
@@ -668,10 +1012,11 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
         Vertex property map where the values of eigenvector must be stored. If
         provided, it will be used uninitialized.
     epsilon : float, optional (default: ``1e-6``)
-        Convergence condition. The iteration will stop if the total delta of all
-        vertices are below this value.
+        Convergence condition. The iteration will stop if the relative residual
+        norm of the eigenvector is below this value.
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of matrix-vector
+        products.
     norm : bool, optional (default: ``True``)
         Whether or not the centrality values should be normalized.
 
@@ -781,10 +1126,11 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
     yprop : :class:`~graph_tool.PropertyMap`, optional (default: ``None``)
         Vertex property map where the hub centrality must be stored.
     epsilon : float, optional (default: ``1e-6``)
-        Convergence condition. The iteration will stop if the total delta of all
-        vertices are below this value.
+        Convergence condition. The iteration will stop if the relative residual
+        norm of the eigenvector is below this value.
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of matrix-vector
+        products.
 
     Returns
     -------
@@ -822,11 +1168,15 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
     cocitation matrix, :math:`\mathbf{A}\mathbf{A}^T`. (Without loss of
     generality, we set :math:`\beta=1` in the algorithm.)
 
-    The algorithm uses the power method which has a topology-dependent complexity of
-    :math:`O\left(N\times\frac{-\log\epsilon}{\log|\lambda_1/\lambda_2|}\right)`,
-    where :math:`N` is the number of vertices, :math:`\epsilon` is the ``epsilon``
-    parameter, and :math:`\lambda_1` and :math:`\lambda_2` are the largest and
-    second largest eigenvalues of the (weighted) cocitation matrix, respectively.
+    The authority centralities are computed with the Lanczos method
+    [saad-numerical-2011]_ applied to the cocitation matrix, using
+    matrix-vector products computed directly on the graph. Each product takes
+    time :math:`O(V + E)`, and the number of products needed is typically much
+    smaller than the
+    :math:`O\left(\frac{-\log\epsilon}{\log|\lambda_1/\lambda_2|}\right)`
+    iterations of the power method, where :math:`\lambda_1` and
+    :math:`\lambda_2` are the largest and second largest eigenvalues of the
+    (weighted) cocitation matrix, respectively.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -877,6 +1227,16 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
 
        HITS hub values of the a political blogs network of [adamic-polblogs]_.
 
+    The largest eigenvalue of the cocitation matrix can be repeated, e.g. for
+    a graph with two identical components:
+
+    .. doctest:: hits_degenerate
+
+       >>> g = gt.graph_union(gt.complete_graph(20), gt.complete_graph(20))
+       >>> ee, x, y = gt.hits(g)
+       >>> print(round(1. / ee, 6))
+       361.0
+
     References
     ----------
 
@@ -885,6 +1245,8 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
        hyperlinked environment", Journal of the ACM 46 (5): 604-632, 1999,
        :DOI:`10.1145/324133.324140`.
     .. [power-method] http://en.wikipedia.org/wiki/Power_iteration
+    .. [saad-numerical-2011] Y. Saad, "Numerical Methods for Large Eigenvalue
+       Problems", SIAM (2011), :DOI:`10.1137/1.9781611970739`
     .. [adamic-polblogs] L. A. Adamic and N. Glance, "The political blogosphere
        and the 2004 US Election", in Proceedings of the WWW-2005 Workshop on the
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
@@ -898,7 +1260,7 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
         max_iter = 0
     l = libgraph_tool_centrality.\
          get_hits(g._Graph__graph, _prop("e", g, weight), _prop("v", g, xprop),
-                  _prop("v", g, yprop), epsilon, max_iter)
+                  _prop("v", g, yprop), epsilon, max_iter, _get_rng())
     return 1. / l, xprop, yprop
 
 
@@ -1034,9 +1396,11 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     source : :class:`~graph_tool.Vertex` (optional, default: None)
         Source vertex. All trust values are computed relative to this vertex.
         If left unspecified, the trust values for all sources are computed.
-    target : :class:`~graph_tool.Vertex` (optional, default: None)
-        The only target for which the trust value will be calculated. If left
-        unspecified, the trust values for all targets are computed.
+    target : :class:`~graph_tool.Vertex` or list of vertices (optional, default: None)
+        The only target for which the trust value will be calculated. If a list
+        of vertices is given, the trust values are computed for these targets
+        only. If left unspecified, the trust values for all targets are
+        computed.
     vprop : :class:`~graph_tool.PropertyMap` (optional, default: None)
         A vertex property map where the values of transitive trust must be
         stored.
@@ -1050,7 +1414,10 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
         property map containing the trust vector from/to the source/target
         vertex to/from the rest of the network. If both `source` and `target`
         are specified, the result is a single float, with the corresponding
-        trust value for the target.
+        trust value for the target. If `target` is a list of vertices, the
+        vectors of the returned property map contain the trust values for
+        these targets, in the same order, or, if `source` is also specified,
+        an array with the trust values of the targets is returned.
 
     See Also
     --------
@@ -1086,7 +1453,13 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     the complete trust matrix is :math:`O(EN\log N)`, where :math:`E` is the
     number of edges in the network.
 
-    If enabled during compilation, this algorithm runs in parallel.
+    The searches stop as soon as all the in-neighbours of the target have been
+    reached, and only the part of the graph which was explored is reset
+    between searches, hence the cost of a search is proportional to the
+    explored part of the graph, instead of the whole graph.
+
+    If enabled during compilation, this algorithm runs in parallel, with the
+    targets distributed among the threads.
 
     Examples
     --------
@@ -1141,10 +1514,15 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     if vprop == None:
         vprop = g.new_vertex_property("vector<double>")
 
-    if target == None:
-        target = -1
+    multiple = False
+    if target is None:
+        targets = []
+    elif isinstance(target, (Vertex, int, numpy.integer)):
+        targets = [int(target)]
     else:
-        target = g.vertex_index[target]
+        targets = [int(v) for v in target]
+        multiple = True
+    targets = numpy.asarray(targets, dtype="int64")
 
     if source == None:
         source = -1
@@ -1152,11 +1530,13 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
         source = g.vertex_index[source]
 
     libgraph_tool_centrality.\
-            get_trust_transitivity(g._Graph__graph, source, target,
+            get_trust_transitivity(g._Graph__graph, source, targets,
                                    _prop("e", g, trust_map),
                                    _prop("v", g, vprop))
-    if target != -1 or source != -1:
+    if (len(targets) > 0 and not multiple) or source != -1:
         vprop = ungroup_vector_property(vprop, [0])[0]
-    if target != -1 and source != -1:
-        return vprop.a[target]
+    if len(targets) > 0 and source != -1:
+        if multiple:
+            return vprop.a[targets]
+        return vprop.a[targets[0]]
     return vprop
@@ -781,7 +781,7 @@ def get_akc(B, I, N=float("inf"), directed=False):
 def mcmc_sweep(state, beta=1., c=1., dl=False, dense=False, multigraph=False,
                node_coherent=False, nmerges=0, nmerge_sweeps=1, merge_map=None,
                coherent_merge=False, sequential=True, parallel=False,
-               vertices=None, verbose=False, **kwargs):
+               concurrent=False, vertices=None, verbose=False, **kwargs):
     r"""Performs a Markov chain Monte Carlo sweep on the network, to sample the block partition according to a probability :math:`\propto e^{-\beta \mathcal{S}_{t/c}}`, where :math:`\mathcal{S}_{t/c}` is the blockmodel entropy.
 
     Parameters
@@ -822,6 +822,16 @@ def mcmc_sweep(state, beta=1., c=1., dl=False, dense=False, multigraph=False,
             the correct probabilities. This is better used in conjunction with
             ``beta=float('inf')``, where this is not an issue.
 
+    concurrent : ``bool`` (optional, default: ``False``)
+        If ``True``, and if ``parallel == True``, the moves are also applied in
+        parallel, instead of being only proposed in parallel and applied
+        serially. A move only locks the blocks it affects, i.e. the source and
+        target blocks and those of the neighbours of the vertex, and the moves
+        which conflict with another one in progress are retried serially at
+        the end of the sweep. Each move is therefore evaluated against the
+        current state of the blocks involved. This has no effect if
+        ``nmerges > 0``, ``dense == True``, or if the ``state`` is an instance
+        of :class:`~graph_tool.community.OverlapBlockState`.
     vertices : ``list of ints`` (optional, default: ``None``)
         A list of vertices which will be attempted to be moved. If ``None``, all
         vertices will be attempted.
@@ -1018,7 +1028,9 @@ def mcmc_sweep(state, beta=1., c=1., dl=False, dense=False, multigraph=False,
                                                  _prop("e", state.g, state.esrcpos),
                                                  _prop("e", state.g, state.etgtpos),
                                                  float(beta), sequential,
-                                                 parallel, random_move,
+                                                 parallel,
+                                                 parallel and concurrent,
+                                                 random_move,
                                                  c, state.is_weighted,
                                                  nmerges, nmerge_sweeps,
                                                  _prop("v", state.g, merge_map),
@@ -1075,6 +1087,59 @@ def mcmc_sweep(state, beta=1., c=1., dl=False, dense=False, multigraph=False,
     return dS / state.E, nmoves
 
 
+def merge_sweep(state, B, merge_map, nmerge_sweeps=1, unweighted_merge=False,
+                random_move=False, dense=False, multigraph=False,
+                sequential=True, parallel=False, verbose=False, **kwargs):
+    r"""Greedily merge the vertices of a :class:`~graph_tool.community.BlockState`
+    until only ``B`` nonempty blocks remain, by performing repeated merge sweeps
+    (as done by :func:`mcmc_sweep` with ``nmerges > 0``) in a single call. The
+    merges are recorded in ``merge_map``, and the total entropy difference (per
+    edge) and number of merges are returned."""
+
+    if state.overlap:
+        raise ValueError("merge sweeps are not supported for overlapping states")
+
+    if state.sweep_vertices is None:
+        vertices = libcommunity.get_vector(state.g.num_vertices())
+        vertices.a = state.g.vertex_index.copy("int").fa
+        state.sweep_vertices = vertices
+
+    state._BlockState__build_egroups(empty=True)
+
+    if state.partition_stats.is_enabled():
+        state._BlockState__init_partition_stats(empty=True)
+
+    try:
+        dS, nmoves = libcommunity.merge_sweep(state.g._Graph__graph,
+                                              state.bg._Graph__graph,
+                                              state._BlockState__get_emat(),
+                                              _prop("e", state.bg, state.mrs),
+                                              _prop("v", state.bg, state.mrp),
+                                              _prop("v", state.bg, state.mrm),
+                                              _prop("v", state.bg, state.wr),
+                                              _prop("v", state.g, state.b),
+                                              _prop("v", state.bg, state.get_bclabel()),
+                                              state.sweep_vertices,
+                                              state.deg_corr, dense, multigraph,
+                                              _prop("e", state.g, state.eweight),
+                                              _prop("v", state.g, state.vweight),
+                                              state.egroups,
+                                              _prop("e", state.g, state.esrcpos),
+                                              _prop("e", state.g, state.etgtpos),
+                                              sequential, parallel, random_move,
+                                              state.is_weighted,
+                                              unweighted_merge, B,
+                                              nmerge_sweeps,
+                                              _prop("v", state.g, merge_map),
+                                              state.partition_stats,
+                                              verbose, _get_rng())
+    finally:
+        state.nsampler = None
+        state.egroups = None
+
+    return dS / state.E, nmoves
+
+
 def pmap(prop, value_map):
     """Maps all the values of `prop` to the values given by `value_map`, which
     is indexed by the values of `prop`."""
@@ -1125,7 +1190,7 @@ def greedy_shrink(state, B, **kwargs):
     curr_B = (state.wr.a > 0).sum()
     assert curr_B >= B, "shrinking to a larger size ?! (%d, %d)" % (curr_B, B)
 
-    random = kwargs.get("random_move", False)
+    random = kwargs.pop("random_move", False)
     old_state = state
     if not state.overlap:
         state, n_map = state.get_block_state(vweight=True, deg_corr=state.deg_corr)
@@ -1135,6 +1200,12 @@ def greedy_shrink(state, B, **kwargs):
     unweighted = False
     kwargs["c"] = 0 if not random else float("inf")
     kwargs["dl"] = False
+
+    if not state.overlap:
+        dS, nmoves = merge_sweep(state, B, merge_map=merge_map,
+                                 random_move=random, **kwargs)
+        curr_B = (state.wr.a > 0).sum()
+
     while curr_B > B:
         dS, nmoves = mcmc_sweep(state, beta=float("inf"),
                                 nmerges=curr_B - B,
@@ -1199,10 +1270,11 @@ class MinimizeState(object):
 def unilevel_minimize(state, nsweeps=10, adaptive_sweeps=True, epsilon=0,
                       anneal=(1., 1.), greedy=True, c=0., dl=False, dense=False,
                       multigraph=True, sequential=True, parallel=False,
-                      verbose=False, **kwargs):
+                      concurrent=False, verbose=False, **kwargs):
     kwargs = kwargs.copy()
     kwargs.update(dict(c=c, dl=dl, dense=dense, multigraph=multigraph,
-                       sequential=sequential, parallel=parallel))
+                       sequential=sequential, parallel=parallel,
+                       concurrent=concurrent))
 
     t_dS, t_nmoves = 0, 0
 
@@ -1330,8 +1402,9 @@ def unilevel_minimize(state, nsweeps=10, adaptive_sweeps=True, epsilon=0,
 def multilevel_minimize(state, B, nsweeps=10, adaptive_sweeps=True, epsilon=0,
                         anneal=(1., 1.), r=2., nmerge_sweeps=10, greedy=True,
                         c=0., dl=False, dense=False, multigraph=True,
-                        sequential=True, parallel=False, checkpoint=None,
-                        minimize_state=None, verbose=False, **kwargs):
+                        sequential=True, parallel=False, concurrent=False,
+                        checkpoint=None, minimize_state=None, verbose=False,
+                        **kwargs):
     r"""Performs an agglomerative heuristic, which progressively merges blocks together (while allowing individual node moves) to achieve a good partition in ``B`` blocks.
 
     Parameters
@@ -1386,6 +1459,9 @@ def multilevel_minimize(state, B, nsweeps=10, adaptive_sweeps=True, epsilon=0,
     parallel : ``bool`` (optional, default: ``False``)
         If ``True``, the updates are performed in parallel (multiple
         threads).
+    concurrent : ``bool`` (optional, default: ``False``)
+        If ``True``, and if ``parallel == True``, the moves are applied
+        concurrently. See :func:`mcmc_sweep` for details.
     vertices: ``list of ints`` (optional, default: ``None``)
         A list of vertices which will be attempted to be moved. If ``None``, all
         vertices will be attempted.
@@ -1477,7 +1553,8 @@ def multilevel_minimize(state, B, nsweeps=10, adaptive_sweeps=True, epsilon=0,
     nkwargs = dict(nsweeps=nsweeps, epsilon=epsilon, c=c,
                    dl=dl, dense=dense, multigraph=multigraph,
                    nmerge_sweeps=nmerge_sweeps,
-                   sequential=sequential, parallel=parallel)
+                   sequential=sequential, parallel=parallel,
+                   concurrent=concurrent)
     kwargs = copy.copy(kwargs)
     kwargs.update(nkwargs)
 
@@ -1717,7 +1794,7 @@ def minimize_blockmodel_dl(g, deg_corr=True, overlap=False,
                            vweight=None, clabel=None, c=0, nsweeps=100,
                            adaptive_sweeps=True, epsilon=1e-3, anneal=(1., 1.),
                            greedy_cooling=True, sequential=True, parallel=False,
-                           r=2, nmerge_sweeps=10, max_B=None, min_B=None,
+                           concurrent=False, r=2, nmerge_sweeps=10, max_B=None, min_B=None,
                            mid_B=None, checkpoint=None, minimize_state=None,
                            exhaustive=False, init_states=None, max_BE=None,
                            verbose=False, **kwargs):
@@ -1786,6 +1863,9 @@ def minimize_blockmodel_dl(g, deg_corr=True, overlap=False,
     parallel : ``bool`` (optional, default: ``False``)
         If ``True``, the updates are performed in parallel (multiple
         threads).
+    concurrent : ``bool`` (optional, default: ``False``)
+        If ``True``, and if ``parallel == True``, the moves are applied
+        concurrently. See :func:`mcmc_sweep` for details.
     r : ``float`` (optional, default: ``2.``)
         Agglomeration ratio for the merging steps. Each merge step will attempt
         to find the best partition into :math:`B_{i-1} / r` blocks, where
@@ -1980,7 +2060,7 @@ def minimize_blockmodel_dl(g, deg_corr=True, overlap=False,
                                        epsilon=epsilon, anneal=anneal,
                                        greedy_cooling=greedy_cooling,
                                        sequential=sequential, parallel=parallel,
-                                       r=r, nmerge_sweeps=nmerge_sweeps,
+                                       concurrent=concurrent, r=r, nmerge_sweeps=nmerge_sweeps,
                                        max_B=max_B, min_B=min_B, mid_B=mid_B,
                                        clabel=clabel if isinstance(clabel, PropertyMap) else None,
                                        checkpoint=checkpoint,
@@ -2036,7 +2116,8 @@ def minimize_blockmodel_dl(g, deg_corr=True, overlap=False,
     checkpoint_state = minimize_state.checkpoint_state
 
     kwargs = dict(nsweeps=nsweeps, adaptive_sweeps=adaptive_sweeps, c=c,
-                  sequential=sequential, parallel=parallel, shrink=shrink, r=r,
+                  sequential=sequential, parallel=parallel,
+                  concurrent=concurrent, shrink=shrink, r=r,
                   anneal=anneal, greedy=greedy, epsilon=epsilon,
                   nmerge_sweeps=nmerge_sweeps, deg_corr=deg_corr, dense=dense,
                   multigraph=multigraph, dl=dl,
@@ -33,6 +33,7 @@ Summary
    incidence
    transition
    modularity_matrix
+   eigenpairs
 
 Contents
 ++++++++
@@ -40,7 +41,7 @@ Contents
 
 from __future__ import division, absolute_import, print_function
 
-from .. import _degree, _prop, Graph, _limit_args
+from .. import _degree, _prop, Graph, _limit_args, _get_rng
 from .. stats import label_self_loops
 import numpy
 import scipy.sparse
@@ -49,10 +50,38 @@ import scipy.sparse.linalg
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_spectral")
 
-__all__ = ["adjacency", "laplacian", "incidence", "transition", "modularity_matrix"]
+__all__ = ["adjacency", "laplacian", "incidence", "transition", "modularity_matrix",
+           "eigenpairs"]
 
 
-def adjacency(g, weight=None, index=None):
+def _graph_operator(g, mtype, weight, index, deg=None):
+    """Return a :class:`~scipy.sparse.linalg.LinearOperator` which computes the
+    products with the matrix of type `mtype` natively."""
+
+    V = g.num_vertices()
+    if V > 0 and index is not g.vertex_index:
+        V = max(V, int(index.fa.max()) + 1)
+    d = numpy.zeros(V, dtype="double")
+    if deg is not None:
+        libgraph_tool_spectral.degrees(g._Graph__graph, _prop("v", g, index),
+                                       _prop("e", g, weight), deg, d)
+
+    def matmat(x, transpose=False):
+        x = numpy.asarray(x, dtype="double")
+        shape = x.shape
+        x = numpy.ascontiguousarray(x.reshape((shape[0], -1)))
+        ret = numpy.zeros(x.shape, dtype="double")
+        libgraph_tool_spectral.matmat(g._Graph__graph, _prop("v", g, index),
+                                      _prop("e", g, weight), mtype, transpose,
+                                      d, x, ret)
+        return ret.reshape(shape)
+
+    return scipy.sparse.linalg.LinearOperator((V, V), matvec=matmat,
+                                              rmatvec=lambda x: matmat(x, True),
+                                              matmat=matmat, dtype="float")
+
+
+def adjacency(g, weight=None, index=None, operator=False):
     r"""Return the adjacency matrix of the graph.
 
     Parameters
@@ -64,10 +93,15 @@ def adjacency(g, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: False)
+        If ``True``, a :class:`~scipy.sparse.linalg.LinearOperator` is returned
+        instead of a sparse matrix, which computes products with vectors, or
+        blocks of vectors, directly on the graph, without building the
+        matrix.
 
     Returns
     -------
-    a : :class:`~scipy.sparse.csr_matrix`
+    a : :class:`~scipy.sparse.csr_matrix` or :class:`~scipy.sparse.linalg.LinearOperator`
         The (sparse) adjacency matrix.
 
     Notes
@@ -133,11 +167,14 @@ def adjacency(g, weight=None, index=None):
         else:
             index = g.vertex_index
 
+    if operator:
+        return _graph_operator(g, "adjacency", weight, index)
+
     E = g.num_edges() if g.is_directed() else 2 * g.num_edges()
 
     data = numpy.zeros(E, dtype="double")
-    i = numpy.zeros(E, dtype="int32")
-    j = numpy.zeros(E, dtype="int32")
+    i = numpy.zeros(E, dtype="int64")
+    j = numpy.zeros(E, dtype="int64")
 
     libgraph_tool_spectral.adjacency(g._Graph__graph, _prop("v", g, index),
                                      _prop("e", g, weight), data, i, j)
@@ -153,7 +190,8 @@ def adjacency(g, weight=None, index=None):
 
 
 @_limit_args({"deg": ["total", "in", "out"]})
-def laplacian(g, deg="total", normalized=False, weight=None, index=None):
+def laplacian(g, deg="total", normalized=False, weight=None, index=None,
+              operator=False):
     r"""Return the Laplacian matrix of the graph.
 
     Parameters
@@ -169,10 +207,15 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: False)
+        If ``True``, a :class:`~scipy.sparse.linalg.LinearOperator` is returned
+        instead of a sparse matrix, which computes products with vectors, or
+        blocks of vectors, directly on the graph, without building the
+        matrix.
 
     Returns
     -------
-    l : :class:`~scipy.sparse.csr_matrix`
+    l : :class:`~scipy.sparse.csr_matrix` or :class:`~scipy.sparse.linalg.LinearOperator`
         The (sparse) Laplacian matrix.
 
     Notes
@@ -275,6 +318,10 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
         else:
             index = g.vertex_index
 
+    if operator:
+        return _graph_operator(g, "norm_laplacian" if normalized else "laplacian",
+                               weight, index, deg)
+
     V = g.num_vertices()
     nself = label_self_loops(g, mark_only=True).a.sum()
     E = g.num_edges() - nself
@@ -283,8 +330,8 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
 
     N = E + g.num_vertices()
     data = numpy.zeros(N, dtype="double")
-    i = numpy.zeros(N, dtype="int32")
-    j = numpy.zeros(N, dtype="int32")
+    i = numpy.zeros(N, dtype="int64")
+    j = numpy.zeros(N, dtype="int64")
 
     if normalized:
         libgraph_tool_spectral.norm_laplacian(g._Graph__graph, _prop("v", g, index),
@@ -386,8 +433,8 @@ def incidence(g, vindex=None, eindex=None):
         raise ValueError("Cannot construct incidence matrix for a graph with no edges.")
 
     data = numpy.zeros(2 * E, dtype="double")
-    i = numpy.zeros(2 * E, dtype="int32")
-    j = numpy.zeros(2 * E, dtype="int32")
+    i = numpy.zeros(2 * E, dtype="int64")
+    j = numpy.zeros(2 * E, dtype="int64")
 
     libgraph_tool_spectral.incidence(g._Graph__graph, _prop("v", g, vindex),
                                      _prop("e", g, eindex), data, i, j)
@@ -395,7 +442,7 @@ def incidence(g, vindex=None, eindex=None):
     m = m.tocsr()
     return m
 
-def transition(g, weight=None, index=None):
+def transition(g, weight=None, index=None, operator=False):
     r"""Return the transition matrix of the graph.
 
     Parameters
@@ -407,10 +454,15 @@ def transition(g, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: False)
+        If ``True``, a :class:`~scipy.sparse.linalg.LinearOperator` is returned
+        instead of a sparse matrix, which computes products with vectors, or
+        blocks of vectors, directly on the graph, without building the
+        matrix.
 
     Returns
     -------
-    T : :class:`~scipy.sparse.csr_matrix`
+    T : :class:`~scipy.sparse.csr_matrix` or :class:`~scipy.sparse.linalg.LinearOperator`
         The (sparse) transition matrix.
 
     Notes
@@ -471,10 +523,13 @@ def transition(g, weight=None, index=None):
         else:
             index = g.vertex_index
 
+    if operator:
+        return _graph_operator(g, "transition", weight, index, "out")
+
     E = g.num_edges() if g.is_directed() else 2 * g.num_edges()
     data = numpy.zeros(E, dtype="double")
-    i = numpy.zeros(E, dtype="int32")
-    j = numpy.zeros(E, dtype="int32")
+    i = numpy.zeros(E, dtype="int64")
+    j = numpy.zeros(E, dtype="int64")
 
     libgraph_tool_spectral.transition(g._Graph__graph, _prop("v", g, index),
                                       _prop("e", g, weight), data, i, j)
@@ -563,7 +618,7 @@ def modularity_matrix(g, weight=None, index=None):
        :doi:`10.1103/PhysRevE.69.026113`
     """
 
-    A = adjacency(g, weight=weight, index=index)
+    A = adjacency(g, weight=weight, index=index, operator=True)
     if g.is_directed():
         k_in = g.degree_property_map("in", weight=weight).fa
     else:
@@ -573,22 +628,126 @@ def modularity_matrix(g, weight=None, index=None):
     N = A.shape[0]
     E2 = float(k_out.sum())
 
+    def matmat(x):
+        return A.matmat(x) - numpy.outer(k_out, numpy.dot(k_in, x)) / E2
+
     def matvec(x):
         M = x.shape[0]
         if len(x.shape) > 1:
             x = x.reshape(M)
-        nx = A * x - k_out * numpy.dot(k_in, x) / E2
+        nx = A.matvec(x) - k_out * numpy.dot(k_in, x) / E2
         return nx
 
     def rmatvec(x):
         M = x.shape[0]
         if len(x.shape) > 1:
             x = x.reshape(M)
-        nx = A.T * x - k_in * numpy.dot(k_out, x) / E2
+        nx = A.rmatvec(x) - k_in * numpy.dot(k_out, x) / E2
         return nx
 
     B = scipy.sparse.linalg.LinearOperator((g.num_vertices(), g.num_vertices()),
                                            matvec=matvec, rmatvec=rmatvec,
-                                           dtype="float")
+                                           matmat=matmat, dtype="float")
 
     return B
+
+
+def eigenpairs(g, k=1, matrix="adjacency", which="LA", weight=None,
+               index=None, epsilon=1e-8, max_iter=None):
+    r"""Return extremal eigenvalues and eigenvectors of the adjacency or
+    Laplacian matrices of an undirected graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Undirected graph to be used.
+    k : int (optional, default: ``1``)
+        Number of eigenpairs to be computed.
+    matrix : str (optional, default: ``"adjacency"``)
+        Matrix to be used. Must be one of ``"adjacency"``, ``"laplacian"`` or
+        ``"norm_laplacian"``.
+    which : str (optional, default: ``"LA"``)
+        Which eigenvalues to compute: the largest algebraic (``"LA"``), the
+        smallest algebraic (``"SA"``) or the largest in magnitude (``"LM"``).
+    weight : :class:`~graph_tool.PropertyMap` (optional, default: True)
+        Edge property map with the edge weights.
+    index : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Vertex property map specifying the row/column indexes. If not provided, the
+        internal vertex index is used.
+    epsilon : float (optional, default: ``1e-8``)
+        Relative tolerance of the residual norms of the eigenpairs.
+    max_iter : int (optional, default: ``None``)
+        If supplied, this will limit the total number of matrix-vector
+        products.
+
+    Returns
+    -------
+    ew : :class:`~numpy.ndarray`
+        The ``k`` eigenvalues, sorted according to ``which``.
+    ev : :class:`~numpy.ndarray`
+        Array of shape ``(N, k)`` with the corresponding eigenvectors in the
+        columns.
+
+    Notes
+    -----
+    The eigenpairs are computed with the thick-restart Lanczos method
+    [wu-thick-restart-2000]_, with full reorthogonalization, using matrix-vector
+    products computed directly on the graph (the matrix is never built). Each
+    product takes time :math:`O(V + E)`, and the number of products needed
+    depends on how well separated the desired eigenvalues are from the rest
+    of the spectrum, but is typically much smaller than with the power method.
+
+    The smallest eigenvectors of the Laplacian provide spectral embeddings of
+    the vertices, which can be used for clustering and layout.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["football"]
+    >>> ew, ev = gt.eigenpairs(g, k=3, matrix="laplacian", which="SA")
+    >>> print(ew[0] < 1e-8)
+    True
+
+    Repeated eigenvalues are found with their multiplicities, e.g. for a graph
+    with two identical components:
+
+    >>> g = gt.graph_union(gt.complete_graph(20), gt.complete_graph(20))
+    >>> ew, ev = gt.eigenpairs(g, k=3)
+    >>> print(np.round(ew, 6).tolist())
+    [19.0, 19.0, -1.0]
+
+    References
+    ----------
+    .. [wu-thick-restart-2000] K. Wu, H. Simon, "Thick-restart Lanczos method
+       for large symmetric eigenvalue problems", SIAM J. Matrix Anal. Appl. 22,
+       602 (2000), :doi:`10.1137/S0895479898334605`
+    """
+
+    if g.is_directed():
+        raise ValueError("eigenpairs() requires an undirected graph; for " +
+                         "directed graphs use scipy.sparse.linalg.eigs() with " +
+                         "the operator returned by adjacency(..., " +
+                         "operator=True).")
+    if index is None:
+        index = g.vertex_index
+    if max_iter is None:
+        max_iter = 0
+
+    V = g.num_vertices()
+    if V > 0 and index is not g.vertex_index:
+        V = max(V, int(index.fa.max()) + 1)
+    if k > g.num_vertices():
+        raise ValueError("the number of eigenpairs cannot exceed the number of vertices")
+
+    d = numpy.zeros(V, dtype="double")
+    if matrix in ["laplacian", "norm_laplacian"]:
+        libgraph_tool_spectral.degrees(g._Graph__graph, _prop("v", g, index),
+                                       _prop("e", g, weight), "total", d)
+    ew = numpy.zeros(k, dtype="double")
+    ev = numpy.zeros((V, k), dtype="double")
+    libgraph_tool_spectral.eigenpairs(g._Graph__graph, _prop("v", g, index),
+                                      _prop("e", g, weight), matrix, which,
+                                      epsilon, max_iter, d, ew, ev,
+                                      _get_rng())
+    return ew, ev
@@ -30,6 +30,7 @@ Summary
 
    shortest_distance
    shortest_path
+   ContractionHierarchy
    pseudo_diameter
    similarity
    isomorphism
@@ -78,7 +79,9 @@ __all__ = ["isomorphism", "subgraph_isomorphism", "mark_subgraph",
            "sequential_vertex_coloring", "label_components",
            "label_largest_component", "label_biconnected_components",
            "label_out_component", "kcore_decomposition", "shortest_distance",
-           "shortest_path", "pseudo_diameter", "is_bipartite", "is_DAG",
+           "shortest_distance_pairs", "landmark_distances",
+           "ContractionHierarchy", "shortest_path",
+           "pseudo_diameter", "is_bipartite", "is_DAG",
            "is_planar", "make_maximal_planar", "similarity", "edge_reciprocity"]
 
 
@@ -1097,7 +1100,7 @@ def kcore_decomposition(g, deg="out", vprop=None):
 
 def shortest_distance(g, source=None, target=None, weights=None, max_dist=None,
                       directed=None, dense=False, dist_map=None,
-                      pred_map=False):
+                      pred_map=False, landmarks=None):
     """
     Calculate the distance from a source to a target vertex, or to of all
     vertices from a given source, or the all pairs shortest paths, if the source
@@ -1124,20 +1127,26 @@ def shortest_distance(g, source=None, target=None, weights=None, max_dist=None,
         directionality.
     dense : bool (optional, default: False)
         If true, and source is None, the Floyd-Warshall algorithm is used,
-        otherwise the Johnson algorithm is used. If source is not None, this option
-        has no effect.
+        otherwise the Johnson algorithm is used. If source is not None, or if
+        no weights are given, this option has no effect.
     dist_map : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property to store the distances. If none is supplied, one
         is created.
     pred_map : bool (optional, default: False)
         If true, a vertex property map with the predecessors is returned.
-        Ignored if source=None.
+        Ignored if source=None. If a target is given, only the predecessors of
+        the vertices in the shortest path are set.
+    landmarks : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Landmark distances, as returned by :func:`landmark_distances`, which
+        are used to guide the search if both source and target are given.
 
     Returns
     -------
     dist_map : :class:`~graph_tool.PropertyMap`
         Vertex property map with the distances from source. If source is 'None',
         it will have a vector value type, with the distances to every vertex.
+        If both source and target are given, only the distance between them is
+        returned.
 
     Notes
     -----
@@ -1146,11 +1155,23 @@ def shortest_distance(g, source=None, target=None, weights=None, max_dist=None,
     search (BFS) or Dijkstra's algorithm [dijkstra]_, if weights are given. If
     source is not given, the distances are calculated with Johnson's algorithm
     [johnson-apsp]_. If dense=True, the Floyd-Warshall algorithm
-    [floyd-warshall-apsp]_ is used instead.
+    [floyd-warshall-apsp]_ is used instead. If neither source nor weights are
+    given, the distances are calculated with a multi-source BFS
+    [then-more-2014]_, which runs the searches from 64 sources at once, so that
+    the edges of a vertex reached by several of them at the same distance are
+    scanned only once.
+
+    If both source and target are given (and neither max_dist nor dist_map),
+    the search is bidirectional [pohl-bidirectional-1971]_, i.e. it runs from
+    both ends until they meet, so that only a small part of the graph is
+    usually explored. If landmarks are given, the search is directed towards
+    the target with the lower bounds derived from them (see
+    :func:`landmark_distances`).
 
     If source is specified, the algorithm runs in :math:`O(V + E)` time, or
     :math:`O(V \log V)` if weights are given. If source is not specified, it
-    runs in :math:`O(VE\log V)` time, or :math:`O(V^3)` if dense == True.
+    runs in :math:`O(VE\log V)` time, or :math:`O(V^3)` if dense == True, or
+    :math:`O(V(V + E))` if no weights are given.
 
     Examples
     --------
@@ -1214,8 +1235,35 @@ def shortest_distance(g, source=None, target=None, weights=None, max_dist=None,
     .. [dijkstra-boost] http://www.boost.org/libs/graph/doc/dijkstra_shortest_paths.html
     .. [johnson-apsp] http://www.boost.org/libs/graph/doc/johnson_all_pairs_shortest.html
     .. [floyd-warshall-apsp] http://www.boost.org/libs/graph/doc/floyd_warshall_shortest.html
+    .. [then-more-2014] M. Then, M. Kaufmann, F. Chirigati, T.-A. Hoang-Vu,
+       K. Pham, A. Kemper, T. Neumann and H. T. Vo, "The more the merrier:
+       efficient multi-source graph traversal", Proceedings of the VLDB
+       Endowment 8, 449-460 (2014), :doi:`10.14778/2735496.2735507`
+    .. [pohl-bidirectional-1971] I. Pohl, "Bi-directional search", Machine
+       Intelligence 6, 127-140 (1971).
     """
 
+    if directed is not None:
+        u = GraphView(g, directed=directed)
+    else:
+        u = g
+
+    if (source is not None and target is not None and max_dist is None and
+        dist_map is None):
+        if pred_map:
+            pmap = g.copy_property(u.vertex_index, value_type="int64_t")
+        else:
+            pmap = None
+        dist = libgraph_tool_topology.get_p2p_distance(u._Graph__graph,
+                                                       int(source),
+                                                       int(target),
+                                                       _prop("e", g, weights),
+                                                       _prop("v", g, landmarks),
+                                                       _prop("v", g, pmap))
+        if pred_map:
+            return dist, pmap
+        return dist
+
     if weights is None:
         dist_type = 'int32_t'
     else:
@@ -1236,11 +1284,6 @@ def shortest_distance(g, source=None, target=None, weights=None, max_dist=None,
     if max_dist is None:
         max_dist = 0
 
-    if directed is not None:
-        u = GraphView(g, directed=directed)
-    else:
-        u = g
-
     if target is None:
         target = -1
 
@@ -1268,7 +1311,8 @@ def shortest_distance(g, source=None, target=None, weights=None, max_dist=None,
         return dist_map
 
 
-def shortest_path(g, source, target, weights=None, pred_map=None):
+def shortest_path(g, source, target, weights=None, pred_map=None,
+                  landmarks=None):
     """
     Return the shortest path from `source` to `target`.
 
@@ -1286,6 +1330,9 @@ def shortest_path(g, source, target, weights=None, pred_map=None):
         Vertex property map with the predecessors in the search tree. If this is
         provided, the shortest paths are not computed, and are obtained directly
         from this map.
+    landmarks : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Landmark distances, as returned by :func:`landmark_distances`, which
+        are used to guide the search.
 
     Returns
     -------
@@ -1297,11 +1344,12 @@ def shortest_path(g, source, target, weights=None, pred_map=None):
     Notes
     -----
 
-    The paths are computed with a breadth-first search (BFS) or Dijkstra's
-    algorithm [dijkstra]_, if weights are given.
+    The paths are computed with a bidirectional breadth-first search (BFS) or
+    Dijkstra's algorithm [dijkstra]_, if weights are given, optionally guided
+    by landmarks (see :func:`shortest_distance`).
 
     The algorithm runs in :math:`O(V + E)` time, or :math:`O(V \log V)` if
-    weights are given.
+    weights are given, but usually explores only a small part of the graph.
 
     Examples
     --------
@@ -1334,7 +1382,8 @@ def shortest_path(g, source, target, weights=None, pred_map=None):
     if pred_map is None:
         pred_map = shortest_distance(g, source, target,
                                      weights=weights,
-                                     pred_map=True)[1]
+                                     pred_map=True,
+                                     landmarks=landmarks)[1]
 
     if pred_map[target] == int(target):  # no path to target
         return [], []
@@ -1369,6 +1418,281 @@ def shortest_path(g, source, target, weights=None, pred_map=None):
     return vlist, elist
 
 
+def shortest_distance_pairs(g, sources, targets, weights=None, landmarks=None,
+                            directed=None):
+    """
+    Return the distances between many pairs of vertices.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    sources : iterable of :class:`~graph_tool.Vertex` or ints
+        Source vertices of the pairs.
+    targets : iterable of :class:`~graph_tool.Vertex` or ints
+        Target vertices of the pairs, with the same length as ``sources``.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        The edge weights.
+    landmarks : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Landmark distances, as returned by :func:`landmark_distances`, which
+        are used to guide the searches.
+    directed : bool (optional, default:None)
+        Treat graph as directed or not, independently of its actual
+        directionality.
+
+    Returns
+    -------
+    dists : :class:`numpy.ndarray`
+        Distance from ``sources[i]`` to ``targets[i]``, or ``inf`` if there is
+        no path between them.
+
+    Notes
+    -----
+
+    Every distance is computed with the same bidirectional search as
+    :func:`shortest_distance` with both a source and a target, and the pairs
+    are distributed among the available threads.
+
+    Examples
+    --------
+    >>> g = gt.lattice([10, 10])
+    >>> print(gt.shortest_distance_pairs(g, [0, 0, 5], [99, 11, 5]))
+    [ 18.   2.   0.]
+    """
+
+    if directed is not None:
+        u = GraphView(g, directed=directed)
+    else:
+        u = g
+    sources = numpy.fromiter((int(v) for v in sources), dtype="int64")
+    targets = numpy.fromiter((int(v) for v in targets), dtype="int64")
+    if len(sources) != len(targets):
+        raise ValueError("sources and targets must have the same length")
+    N = g._Graph__graph.GetNumberOfVertices(False)
+    for vs in [sources, targets]:
+        if len(vs) > 0 and (vs.min() < 0 or vs.max() >= N):
+            raise ValueError("invalid vertex index")
+    dists = numpy.empty(len(sources), dtype="float")
+    libgraph_tool_topology.get_p2p_distances(u._Graph__graph, sources, targets,
+                                             _prop("e", g, weights),
+                                             _prop("v", g, landmarks), dists)
+    return dists
+
+
+def landmark_distances(g, n=16, weights=None, landmarks=None, directed=None,
+                       lm_map=None):
+    """
+    Compute the distances from and to a set of landmark vertices, which are
+    used to speed up point-to-point shortest path queries.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    n : int (optional, default: 16)
+        Number of landmarks to be chosen, if they are not given.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        The edge weights.
+    landmarks : iterable of :class:`~graph_tool.Vertex` or ints (optional, default: None)
+        The landmark vertices. If not given, they are chosen as described
+        below.
+    directed : bool (optional, default:None)
+        Treat graph as directed or not, independently of its actual
+        directionality.
+    lm_map : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Vertex property map of type ``vector<double>`` to store the distances.
+        If not given, one is created.
+
+    Returns
+    -------
+    lm_map : :class:`~graph_tool.PropertyMap`
+        Vertex property map where ``lm_map[v][2*i]`` is the distance from the
+        i-th landmark to ``v``, and ``lm_map[v][2*i+1]`` the distance from
+        ``v`` to the i-th landmark (``inf`` if there is no path).
+    landmarks : :class:`numpy.ndarray`
+        Indexes of the landmark vertices.
+
+    Notes
+    -----
+
+    The distances to the landmarks give lower bounds on the distance between
+    any two vertices, via the triangle inequality, which are used by
+    :func:`shortest_distance`, :func:`shortest_path` and
+    :func:`shortest_distance_pairs` to direct the searches towards the target
+    [goldberg-computing-2005]_. This is most effective in graphs with a large
+    diameter, such as road networks, and if the landmarks lie at their
+    periphery. The landmarks are chosen by starting from a random vertex, and
+    repeatedly choosing the vertex with the largest sum of the distances to
+    and from the closest landmark chosen so far.
+
+    The same weights and directionality must be used in the queries. The
+    computation runs in :math:`O(n(V + E))` time, or :math:`O(nV\log V)` if
+    weights are given, and the landmarks which are given are processed in
+    parallel.
+
+    Examples
+    --------
+    >>> g = gt.lattice([100, 100])
+    >>> lm, landmarks = gt.landmark_distances(g, n=4)
+    >>> print(gt.shortest_distance(g, g.vertex(0), g.vertex(9999),
+    ...                            landmarks=lm))
+    198
+
+    References
+    ----------
+    .. [goldberg-computing-2005] A. V. Goldberg and C. Harrelson, "Computing
+       the shortest path: A* search meets graph theory", Proceedings of the
+       16th Annual ACM-SIAM Symposium on Discrete Algorithms, 156-165 (2005).
+    """
+
+    if directed is not None:
+        u = GraphView(g, directed=directed)
+    else:
+        u = g
+    if lm_map is None:
+        lm_map = g.new_vertex_property("vector<double>")
+    elif lm_map.value_type() != "vector<double>":
+        raise ValueError("lm_map must have type vector<double>")
+    if landmarks is None:
+        landmarks = numpy.array([], dtype="int64")
+    else:
+        landmarks = numpy.fromiter((int(v) for v in landmarks), dtype="int64")
+    landmarks = libgraph_tool_topology.get_landmark_distances(u._Graph__graph,
+                                                              _prop("e", g, weights),
+                                                              _prop("v", g, lm_map),
+                                                              landmarks, n,
+                                                              _get_rng())
+    return lm_map, landmarks
+
+class ContractionHierarchy(libgraph_tool_topology.ContractionHierarchy):
+    r"""
+    Index for fast repeated shortest distance and path queries on a static
+    graph, based on a contraction hierarchy [geisberger-contraction-2008]_.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph` (optional, default: None)
+        Graph to be indexed. If not given, an empty index is created, to be
+        filled with :meth:`set_state`.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        The edge weights, which must be non-negative.
+    directed : bool (optional, default:None)
+        Treat graph as directed or not, independently of its actual
+        directionality.
+    witness_limit : int (optional, default: 500)
+        Maximum number of vertices visited by each local search during the
+        construction. Smaller values give a faster construction, at the cost
+        of more shortcuts.
+
+    Notes
+    -----
+
+    The vertices are removed from the graph one by one, and whenever a
+    removed vertex lies on the only shortest path between two of its
+    neighbours, a "shortcut" edge between them is inserted, with the length
+    of the path. The index keeps the edges and shortcuts only at their
+    endpoint which was removed first, so that a query is a bidirectional
+    search which only ever moves to vertices removed later, and visits
+    typically only hundreds of vertices, even in large graphs with a large
+    diameter, such as road networks. It is much less effective in graphs
+    with a small diameter and no hierarchical structure, such as random
+    graphs.
+
+    The vertices are removed in rounds, where all the vertices whose removal
+    inserts fewer shortcuts than that of their neighbours are removed in
+    parallel. The index is independent of the graph after it is built, and
+    does not reflect any later modification of it. It can be stored in a
+    graph property map of type ``object``, since it can be pickled, or in a
+    separate file with :meth:`save`.
+
+    Examples
+    --------
+    >>> g = gt.lattice([100, 100])
+    >>> ch = gt.ContractionHierarchy(g)
+    >>> print(ch.distance(0, 9999))
+    198.0
+    >>> print(ch.distances([0, 0, 5], [99, 101, 5]))
+    [ 99.   2.   0.]
+    >>> print(ch.path(0, 3))
+    [0 1 2 3]
+    >>> g.gp["ch"] = g.new_graph_property("object", ch)
+
+    References
+    ----------
+    .. [geisberger-contraction-2008] R. Geisberger, P. Sanders, D. Schultes
+       and D. Delling, "Contraction hierarchies: faster and simpler
+       hierarchical routing in road networks", Proceedings of the 7th
+       International Workshop on Experimental Algorithms, LNCS 5038, 319-333
+       (2008), :doi:`10.1007/978-3-540-68552-4_24`
+    """
+
+    __getstate_manages_dict__ = True
+
+    def __init__(self, g=None, weights=None, directed=None,
+                 witness_limit=500):
+        libgraph_tool_topology.ContractionHierarchy.__init__(self)
+        if g is None:
+            return
+        if directed is not None:
+            u = GraphView(g, directed=directed)
+        else:
+            u = g
+        libgraph_tool_topology.build_contraction_hierarchy(u._Graph__graph,
+                                                           self,
+                                                           _prop("e", g, weights),
+                                                           witness_limit)
+
+    def distance(self, source, target):
+        """Return the distance from ``source`` to ``target``, or ``inf`` if
+        there is no path between them."""
+        return libgraph_tool_topology.ContractionHierarchy.distance(self,
+                                                                    int(source),
+                                                                    int(target))
+
+    def distances(self, sources, targets):
+        """Return an array with the distances from ``sources[i]`` to
+        ``targets[i]``, which are computed in parallel."""
+        sources = numpy.fromiter((int(v) for v in sources), dtype="int64")
+        targets = numpy.fromiter((int(v) for v in targets), dtype="int64")
+        if len(sources) != len(targets):
+            raise ValueError("sources and targets must have the same length")
+        dists = numpy.empty(len(sources), dtype="float")
+        libgraph_tool_topology.ContractionHierarchy.distances(self, sources,
+                                                              targets, dists)
+        return dists
+
+    def path(self, source, target):
+        """Return an array with the indexes of the vertices in a shortest path
+        from ``source`` to ``target``, which is empty if there is no path."""
+        return libgraph_tool_topology.ContractionHierarchy.path(self,
+                                                                int(source),
+                                                                int(target))
+
+    def memory_usage(self):
+        """Return the number of bytes used by the index."""
+        return libgraph_tool_topology.ContractionHierarchy.memory_usage(self)
+
+    def save(self, file):
+        """Save the index to ``file``, which can be a file name or a file-like
+        object, in numpy's ``.npz`` format."""
+        numpy.savez(file, *self.get_state())
+
+    @staticmethod
+    def load(file):
+        """Load an index saved with :meth:`save`."""
+        state = numpy.load(file)
+        ch = ContractionHierarchy()
+        ch.set_state(tuple(state["arr_%d" % i] for i in range(len(state.files))))
+        return ch
+
+    def __getstate__(self):
+        return self.get_state()
+
+    def __setstate__(self, state):
+        ContractionHierarchy.__init__(self)
+        self.set_state(state)
+
+
 def pseudo_diameter(g, source=None, weights=None):
     """
     Compute the pseudo-diameter of the graph.